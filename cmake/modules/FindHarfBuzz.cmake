@@ -0,0 +1,42 @@
+# - Find HarfBuzz library
+# Find the native HarfBuzz includes and library
+# Once done this will define
+#
+#  HARFBUZZ_INCLUDE_DIR    - Where to find hb.h, etc.
+#  HARFBUZZ_LIBRARIES      - Libraries to link against to use HarfBuzz.
+#  HARFBUZZ_FOUND          - If false, do not try to use HarfBuzz.
+#
+# also defined, but not for general use are
+#  HARFBUZZ_LIBRARY        - Where to find the HarfBuzz library.
+
+if (HARFBUZZ_INCLUDE_DIR)
+  # Already in cache, be silent
+  set(HARFBUZZ_FIND_QUIETLY TRUE)
+endif ()
+
+find_path(HARFBUZZ_INCLUDE_DIR hb.h PATH_SUFFIXES harfbuzz)
+
+set(HARFBUZZ_LIBRARY_NAMES_RELEASE ${HARFBUZZ_LIBRARY_NAMES_RELEASE} ${HARFBUZZ_LIBRARY_NAMES} harfbuzz libharfbuzz)
+find_library(HARFBUZZ_LIBRARY_RELEASE NAMES ${HARFBUZZ_LIBRARY_NAMES_RELEASE})
+
+# Find a debug library if one exists and use that for debug builds.
+# This really only does anything for win32, but does no harm on other
+# platforms.
+set(HARFBUZZ_LIBRARY_NAMES_DEBUG ${HARFBUZZ_LIBRARY_NAMES_DEBUG} harfbuzzd libharfbuzzd)
+find_library(HARFBUZZ_LIBRARY_DEBUG NAMES ${HARFBUZZ_LIBRARY_NAMES_DEBUG})
+
+include(LibraryDebugAndRelease)
+set_library_from_debug_and_release(HARFBUZZ)
+
+# handle the QUIETLY and REQUIRED arguments and set HARFBUZZ_FOUND to TRUE if 
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(HarfBuzz DEFAULT_MSG HARFBUZZ_LIBRARY HARFBUZZ_INCLUDE_DIR)
+
+if(HARFBUZZ_FOUND)
+  set(HARFBUZZ_LIBRARIES ${HARFBUZZ_LIBRARY})
+else()
+  set(HARFBUZZ_LIBRARIES)
+endif()
+
+mark_as_advanced(HARFBUZZ_LIBRARY HARFBUZZ_INCLUDE_DIR)
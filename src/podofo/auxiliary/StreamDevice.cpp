@@ -397,7 +397,7 @@ FileStreamDevice::FileStreamDevice(const string_view& filepath, FileMode mode)
 }
 
 FileStreamDevice::FileStreamDevice(const string_view& filepath, FileMode mode, DeviceAccess access)
-    : StreamDevice(access), m_file(createFile(filepath, mode, access))
+    : StreamDevice(access), m_file(createFile(filepath, mode, access)), m_Filepath(filepath)
 {
 }
 
@@ -128,6 +128,9 @@ bool PdfEncodingMapFactory::TryParseCMapEncoding(const PdfObject& cmapObj, uniqu
     if (dict->TryFindKeyAs("CMapName", name))
         cmapName = *name;
 
+    // Loaded CMaps are not modified anymore, compile them
+    // for fast glyph decoding and encoding
+    map.Freeze();
     encoding.reset(new PdfCMapEncoding(std::move(map), false, cmapName, info, wMode, mapLimits));
 
     return true;
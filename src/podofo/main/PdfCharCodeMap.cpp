@@ -5,12 +5,44 @@
 #include "PdfCharCodeMap.h"
 #include <random>
 #include <algorithm>
+#include <mutex>
+
+#include <utf8cpp/utf8.h>
 
 #include <podofo/private/PdfEncodingPrivate.h>
+#include <podofo/private/PdfCharCodeMapTable.h>
 
 using namespace std;
 using namespace PoDoFo;
 
+// Code points served by the reverse lookup pages of frozen maps
+constexpr unsigned FrozenCodePointLimit = 0x110000;
+// Flags forward lookup entries that index a code point span
+constexpr uint32_t FrozenSpanFlag = 0x80000000;
+
+namespace PoDoFo
+{
+    /// Flat lookup tables of a frozen PdfCharCodeMap
+    struct PdfCharCodeMapFrozen
+    {
+        using CodePage = array<uint32_t, 256>;
+        using CharCodePage = array<PdfCharCode, 256>;
+
+        // Forward lookup entries: 0 if the code is unmapped,
+        // a single code point + 1, or FrozenSpanFlag | the
+        // index of the code point span in Spans
+        CodePage OneByteCodes;
+        array<unique_ptr<CodePage>, 256> TwoBytePages;
+        vector<CodePointSpan> Spans;
+
+        // Reverse lookup of single code points, by code point high bits
+        vector<unique_ptr<CharCodePage>> CodePointPages;
+
+        // Ligatures are looked up only in the reverse BST
+        bool HasLigatures = false;
+    };
+}
+
 namespace
 {
     /// <summary>
@@ -34,9 +66,18 @@ static void fetchCodePoints(vector<codepoint>& codePoints, const PdfCharCode& co
 static void fetchCodePoints(CodePointSpan& codePoints, const PdfCharCode& code, const CodeUnitRange& range);
 static void updateCodeSpaceRangeLoHi(unsigned refCodeLo, unsigned refCodeHi, unsigned char codeSpaceSize,
     unsigned& codeLo, unsigned& codeHi);
+static const PdfCharCodeTableMapping* findTableMapping(const PdfCharCodeMapTable& table, const PdfCharCode& code);
+static const PdfCharCodeTableRange* findTableRange(const PdfCharCodeMapTable& table, unsigned code);
+static CodePointSpan getTableCodePoints(const PdfCharCodeMapTable& table, const PdfCharCodeTableMapping& mapping);
+static void setFrozenCodePoints(PdfCharCodeMapFrozen& frozen, const PdfCharCode& code, const CodePointSpan& codePoints);
+static void setFrozenCodePoints(PdfCharCodeMapFrozen& frozen, uint32_t& entry, const CodePointSpan& codePoints);
+static void setFrozenCharCode(PdfCharCodeMapFrozen& frozen, codepoint codePoint, const PdfCharCode& code);
+
+// Guards the lazy materialization of shared read-only tables
+static mutex s_TableMutex;
 
 PdfCharCodeMap::PdfCharCodeMap()
-    : m_MapDirty(false), m_codePointMapHead(nullptr) { }
+    : m_MapDirty(false), m_codePointMapHead(nullptr), m_table(nullptr), m_tableMaterialized(false) { }
 
 PdfCharCodeMap::PdfCharCodeMap(PdfCharCodeMap&& map) noexcept
 {
@@ -55,17 +96,39 @@ PdfCharCodeMap& PdfCharCodeMap::operator=(PdfCharCodeMap&& map) noexcept
 }
 
 PdfCharCodeMap::PdfCharCodeMap(CodeUnitMap&& mappings, CodeUnitRanges&& ranges, const PdfEncodingLimits& limits)
-    : m_Limits(limits), m_Mappings(std::move(mappings)), m_Ranges(std::move(ranges)), m_MapDirty(true), m_codePointMapHead(nullptr)
+    : m_Limits(limits), m_Mappings(std::move(mappings)), m_Ranges(std::move(ranges)), m_MapDirty(true), m_codePointMapHead(nullptr),
+    m_table(nullptr), m_tableMaterialized(false)
+{
+}
+
+PdfCharCodeMap::PdfCharCodeMap(const PdfCharCodeMapTable& table, const PdfEncodingLimits& limits)
+    : m_Limits(limits), m_MapDirty(true), m_codePointMapHead(nullptr), m_table(&table), m_tableMaterialized(false)
 {
 }
 
 bool PdfCharCodeMap::IsEmpty() const
 {
+    if (m_table != nullptr)
+        return m_table->MappingCount == 0 && m_table->RangeCount == 0;
+
     return m_Mappings.empty() && m_Ranges.empty();
 }
 
+const CodeUnitMap& PdfCharCodeMap::GetMappings() const
+{
+    const_cast<PdfCharCodeMap&>(*this).materializeTable();
+    return m_Mappings;
+}
+
+const CodeUnitRanges& PdfCharCodeMap::GetRanges() const
+{
+    const_cast<PdfCharCodeMap&>(*this).materializeTable();
+    return m_Ranges;
+}
+
 bool PdfCharCodeMap::IsTrivialIdentity() const
 {
+    const_cast<PdfCharCodeMap&>(*this).materializeTable();
     // CHECK-ME: Should we do it this way? Maybe we should support
     // only full code ranges identities. Like <00><FF>, or <0000><FFFF>
 
@@ -128,6 +191,7 @@ bool PdfCharCodeMap::IsTrivialIdentity() const
 
 vector<CodeSpaceRange> PdfCharCodeMap::GetCodeSpaceRanges() const
 {
+    const_cast<PdfCharCodeMap&>(*this).materializeTable();
     set<MappingRange> ranges;
     for (auto& pair : m_Mappings)
         ranges.emplace(pair.first, 1);
@@ -185,6 +249,68 @@ void PdfCharCodeMap::move(PdfCharCodeMap& map) noexcept
     utls::move(map.m_Limits, m_Limits);
     utls::move(map.m_MapDirty, m_MapDirty);
     utls::move(map.m_codePointMapHead, m_codePointMapHead);
+    utls::move(map.m_table, m_table);
+    utls::move(map.m_tableMaterialized, m_tableMaterialized);
+    m_frozen = std::move(map.m_frozen);
+}
+
+void PdfCharCodeMap::Freeze()
+{
+    auto& mappings = GetMappings();
+    auto& ranges = GetRanges();
+    unique_ptr<PdfCharCodeMapFrozen> frozen(new PdfCharCodeMapFrozen());
+    frozen->OneByteCodes.fill(0);
+
+    // NOTE: Ranges are matched regardless of the code space size,
+    // so they are set on both the 1-byte and 2-byte tables
+    PdfCharCode code;
+    CodePointSpan codePoints;
+    for (auto& range : ranges)
+    {
+        unsigned codeHi = std::min(range.SrcCodeLo.Code + range.Size, 0x10000U);
+        for (unsigned i = range.SrcCodeLo.Code; i < codeHi; i++)
+        {
+            code = PdfCharCode(i, range.SrcCodeLo.CodeSpaceSize);
+            fetchCodePoints(codePoints, code, range);
+            if (i < 0x100)
+                setFrozenCodePoints(*frozen, PdfCharCode(i, 1), codePoints);
+
+            setFrozenCodePoints(*frozen, PdfCharCode(i, 2), codePoints);
+        }
+    }
+
+    // Direct mappings take precedence over ranges
+    for (auto& pair : mappings)
+        setFrozenCodePoints(*frozen, pair.first, pair.second);
+
+    for (auto& pair : mappings)
+    {
+        if (pair.second.GetSize() == 1)
+            setFrozenCharCode(*frozen, *pair.second, pair.first);
+        else
+            frozen->HasLigatures = true;
+    }
+
+    for (auto& range : ranges)
+    {
+        if (range.DstCodeLo.GetSize() != 1)
+        {
+            frozen->HasLigatures = true;
+            continue;
+        }
+
+        for (unsigned i = 0; i < range.Size; i++)
+        {
+            code = PdfCharCode(range.SrcCodeLo.Code + i, range.SrcCodeLo.CodeSpaceSize);
+            // Skip the mapping if it's already mapped by the straight map
+            if (mappings.find(code) != mappings.end())
+                continue;
+
+            setFrozenCharCode(*frozen, (codepoint)((unsigned)*range.DstCodeLo + i), code);
+        }
+    }
+
+    m_frozen = std::move(frozen);
 }
 
 void PdfCharCodeMap::PushMapping(const PdfCharCode& codeUnit, const codepointview& codePoints)
@@ -211,6 +337,9 @@ void PdfCharCodeMap::PushRange(const PdfCharCode& srcCodeLo, unsigned rangeSize,
     if (rangeSize == 0 || dstCodeLo.size() == 0)
         return;
 
+    detachTable();
+    m_frozen.reset();
+
     if (rangeSize == 1)
     {
         // Avoid pushing a proper range if it's size 1. Push it at a single mapping
@@ -282,6 +411,55 @@ void PdfCharCodeMap::PushRange(const PdfCharCode& srcCodeLo, unsigned rangeSize,
 
 bool PdfCharCodeMap::TryGetCodePoints(const PdfCharCode& codeUnit, CodePointSpan& codePoints) const
 {
+    if (m_frozen != nullptr && ((codeUnit.CodeSpaceSize == 1 && codeUnit.Code < 0x100)
+        || (codeUnit.CodeSpaceSize == 2 && codeUnit.Code < 0x10000)))
+    {
+        uint32_t entry;
+        if (codeUnit.CodeSpaceSize == 1)
+        {
+            entry = m_frozen->OneByteCodes[codeUnit.Code];
+        }
+        else
+        {
+            auto& page = m_frozen->TwoBytePages[codeUnit.Code >> 8];
+            entry = page == nullptr ? 0 : (*page)[codeUnit.Code & 0xFF];
+        }
+
+        if (entry == 0)
+        {
+            codePoints = { };
+            return false;
+        }
+
+        if ((entry & FrozenSpanFlag) == 0)
+            codePoints = CodePointSpan((codepoint)(entry - 1));
+        else
+            codePoints = m_frozen->Spans[entry & ~FrozenSpanFlag];
+
+        return true;
+    }
+
+    if (m_table != nullptr)
+    {
+        // Query the tables in place, with the same lookup order
+        auto mapping = findTableMapping(*m_table, codeUnit);
+        if (mapping != nullptr)
+        {
+            codePoints = getTableCodePoints(*m_table, *mapping);
+            return true;
+        }
+
+        auto range = findTableRange(*m_table, codeUnit.Code);
+        if (range == nullptr)
+        {
+            codePoints = { };
+            return false;
+        }
+
+        codePoints = CodePointSpan((codepoint)(range->DstCodeLo + (codeUnit.Code - range->SrcCodeLo)));
+        return true;
+    }
+
     // Try to find direct mappings first
     auto found = m_Mappings.find(codeUnit);
     if (found != m_Mappings.end())
@@ -306,27 +484,60 @@ bool PdfCharCodeMap::TryGetCodePoints(const PdfCharCode& codeUnit, CodePointSpan
 
 bool PdfCharCodeMap::TryGetNextCharCode(string_view::iterator& it, const string_view::iterator& end, PdfCharCode& code) const
 {
+    if (m_frozen != nullptr && !m_frozen->HasLigatures)
+    {
+        PODOFO_ASSERT(it != end);
+        auto curr = it;
+        auto codePoint = (codepoint)utf8::next(curr, end);
+        if (codePoint < FrozenCodePointLimit)
+        {
+            it = curr;
+            return tryGetCharCodeFrozen(codePoint, code);
+        }
+    }
+
     const_cast<PdfCharCodeMap&>(*this).reviseCodePointMap();
     return PoDoFo::TryGetCodeReverseMap(m_codePointMapHead, it, end, code);
 }
 
 bool PdfCharCodeMap::TryGetCharCode(const codepointview& codePoints, PdfCharCode& code) const
 {
+    if (m_frozen != nullptr && codePoints.size() == 1 && codePoints[0] < FrozenCodePointLimit)
+        return tryGetCharCodeFrozen(codePoints[0], code);
+
     const_cast<PdfCharCodeMap&>(*this).reviseCodePointMap();
     return PoDoFo::TryGetCodeReverseMap(m_codePointMapHead, codePoints, code);
 }
 
 bool PdfCharCodeMap::TryGetCharCode(codepoint codePoint, PdfCharCode& code) const
 {
+    if (m_frozen != nullptr && codePoint < FrozenCodePointLimit)
+        return tryGetCharCodeFrozen(codePoint, code);
+
     const_cast<PdfCharCodeMap&>(*this).reviseCodePointMap();
     return PoDoFo::TryGetCodeReverseMap(m_codePointMapHead, codePoint, code);
 }
 
+bool PdfCharCodeMap::tryGetCharCodeFrozen(codepoint codePoint, PdfCharCode& code) const
+{
+    unsigned pageIndex = (unsigned)codePoint >> 8;
+    if (pageIndex >= m_frozen->CodePointPages.size() || m_frozen->CodePointPages[pageIndex] == nullptr)
+    {
+        code = { };
+        return false;
+    }
+
+    code = (*m_frozen->CodePointPages[pageIndex])[(unsigned)codePoint & 0xFF];
+    return code.CodeSpaceSize != 0;
+}
+
 void PdfCharCodeMap::pushMapping(const PdfCharCode& codeUnit, const codepointview& codePoints)
 {
     if (codeUnit.CodeSpaceSize == 0)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Code unit must be valid");
 
+    detachTable();
+    m_frozen.reset();
     m_Mappings[codeUnit] = CodePointSpan(codePoints);
 
     // Update limits
@@ -346,6 +557,45 @@ void PdfCharCodeMap::updateLimits(const PdfCharCode& codeUnit)
         m_Limits.LastChar = codeUnit;
 }
 
+// Copy the read-only tables to the mappings and ranges
+void PdfCharCodeMap::materializeTable()
+{
+    if (m_table == nullptr)
+        return;
+
+    // NOTE: Tables back shared predefined CMaps, that
+    // may be accessed concurrently
+    unique_lock<mutex> lock(s_TableMutex);
+    if (m_tableMaterialized)
+        return;
+
+    for (unsigned i = 0; i < m_table->MappingCount; i++)
+    {
+        auto& mapping = m_table->Mappings[i];
+        m_Mappings[PdfCharCode(mapping.Code, mapping.CodeSpaceSize)] = getTableCodePoints(*m_table, mapping);
+    }
+
+    for (unsigned i = 0; i < m_table->RangeCount; i++)
+    {
+        auto& range = m_table->Ranges[i];
+        m_Ranges.emplace_hint(m_Ranges.end(), PdfCharCode(range.SrcCodeLo, range.CodeSpaceSize),
+            range.Size, CodePointSpan((codepoint)range.DstCodeLo));
+    }
+
+    m_tableMaterialized = true;
+}
+
+// Stop querying the read-only tables, before modifying the map
+void PdfCharCodeMap::detachTable()
+{
+    if (m_table == nullptr)
+        return;
+
+    materializeTable();
+    m_table = nullptr;
+    m_tableMaterialized = false;
+}
+
 // Try to rebuild the inverse code point -> char code
 void PdfCharCodeMap::reviseCodePointMap()
 {
@@ -359,9 +609,36 @@ void PdfCharCodeMap::reviseCodePointMap()
     }
 
     vector<pair<PdfCharCode, CodePointSpan>> mappings;
-    mappings.reserve(m_Mappings.size());
-    std::copy(m_Mappings.begin(), m_Mappings.end(), std::back_inserter(mappings));
-    appendRangesTo(mappings, m_Mappings, m_Ranges);
+    if (m_table == nullptr)
+    {
+        mappings.reserve(m_Mappings.size());
+        std::copy(m_Mappings.begin(), m_Mappings.end(), std::back_inserter(mappings));
+        appendRangesTo(mappings, m_Mappings, m_Ranges);
+    }
+    else
+    {
+        // Build the inverse map directly from the tables
+        mappings.reserve(m_table->MappingCount);
+        for (unsigned i = 0; i < m_table->MappingCount; i++)
+        {
+            auto& mapping = m_table->Mappings[i];
+            mappings.push_back({ PdfCharCode(mapping.Code, mapping.CodeSpaceSize), getTableCodePoints(*m_table, mapping) });
+        }
+
+        for (unsigned i = 0; i < m_table->RangeCount; i++)
+        {
+            auto& range = m_table->Ranges[i];
+            for (unsigned j = 0; j < range.Size; j++)
+            {
+                // Skip the mapping if it's already mapped by the straight map
+                PdfCharCode code(range.SrcCodeLo + j, range.CodeSpaceSize);
+                if (findTableMapping(*m_table, code) != nullptr)
+                    continue;
+
+                mappings.push_back({ code, CodePointSpan((codepoint)(range.DstCodeLo + j)) });
+            }
+        }
+    }
 
     // Randomize items in the map in a separate list
     // so BST creation will be more balanced
@@ -474,6 +751,99 @@ void fetchCodePoints(CodePointSpan& codePoints, const PdfCharCode& code, const C
     }
 }
 
+// Lookup the mapping slot of the code in the minimal perfect hash
+const PdfCharCodeTableMapping* findTableMapping(const PdfCharCodeMapTable& table, const PdfCharCode& code)
+{
+    if (table.MappingCount == 0)
+        return nullptr;
+
+    unsigned bucket = GetCharCodeTableBucket(code.Code, code.CodeSpaceSize, table.DisplacementCount);
+    auto& mapping = table.Mappings[GetCharCodeTableSlot(code.Code, code.CodeSpaceSize,
+        table.Displacements[bucket], table.MappingCount)];
+    if (mapping.Code != code.Code || mapping.CodeSpaceSize != code.CodeSpaceSize)
+        return nullptr;
+
+    return &mapping;
+}
+
+// Find the range with lower code <= of the searched
+// code and verify if the range includes it
+const PdfCharCodeTableRange* findTableRange(const PdfCharCodeMapTable& table, unsigned code)
+{
+    auto end = table.Ranges + table.RangeCount;
+    auto found = std::upper_bound(table.Ranges, end, code, [](unsigned code, const PdfCharCodeTableRange& range) {
+        return code < range.SrcCodeLo;
+    });
+    if (found == table.Ranges)
+        return nullptr;
+
+    found--;
+    if (code >= found->SrcCodeLo + found->Size)
+        return nullptr;
+
+    return found;
+}
+
+CodePointSpan getTableCodePoints(const PdfCharCodeMapTable& table, const PdfCharCodeTableMapping& mapping)
+{
+    if (mapping.CodePointCount == 1)
+        return CodePointSpan((codepoint)mapping.CodePoint);
+    else
+        return CodePointSpan(codepointview(table.CodePoints + mapping.CodePoint, mapping.CodePointCount));
+}
+
+void setFrozenCodePoints(PdfCharCodeMapFrozen& frozen, const PdfCharCode& code, const CodePointSpan& codePoints)
+{
+    if (code.CodeSpaceSize == 1 && code.Code < 0x100)
+    {
+        setFrozenCodePoints(frozen, frozen.OneByteCodes[code.Code], codePoints);
+    }
+    else if (code.CodeSpaceSize == 2 && code.Code < 0x10000)
+    {
+        auto& page = frozen.TwoBytePages[code.Code >> 8];
+        if (page == nullptr)
+        {
+            page.reset(new PdfCharCodeMapFrozen::CodePage());
+            page->fill(0);
+        }
+
+        setFrozenCodePoints(frozen, (*page)[code.Code & 0xFF], codePoints);
+    }
+}
+
+void setFrozenCodePoints(PdfCharCodeMapFrozen& frozen, uint32_t& entry, const CodePointSpan& codePoints)
+{
+    if (codePoints.GetSize() == 1 && (uint32_t)*codePoints < FrozenSpanFlag - 1)
+    {
+        entry = (uint32_t)*codePoints + 1;
+    }
+    else
+    {
+        entry = (uint32_t)frozen.Spans.size() | FrozenSpanFlag;
+        frozen.Spans.push_back(codePoints);
+    }
+}
+
+// Set the reverse lookup of the code point. When more codes
+// map to the same code point, the lowest code is preferred
+void setFrozenCharCode(PdfCharCodeMapFrozen& frozen, codepoint codePoint, const PdfCharCode& code)
+{
+    if (codePoint >= FrozenCodePointLimit)
+        return;
+
+    unsigned pageIndex = (unsigned)codePoint >> 8;
+    if (pageIndex >= frozen.CodePointPages.size())
+        frozen.CodePointPages.resize(pageIndex + 1);
+
+    auto& page = frozen.CodePointPages[pageIndex];
+    if (page == nullptr)
+        page.reset(new PdfCharCodeMapFrozen::CharCodePage());
+
+    auto& curr = (*page)[(unsigned)codePoint & 0xFF];
+    if (curr.CodeSpaceSize == 0 || code.Code < curr.Code)
+        curr = code;
+}
+
 CodeUnitRange::CodeUnitRange()
     : Size(0) { }
 
@@ -10,6 +10,8 @@
 namespace PoDoFo
 {
     struct CodePointMapNode;
+    struct PdfCharCodeMapTable;
+    struct PdfCharCodeMapFrozen;
 
     struct PODOFO_API CodeUnitRange final
     {
@@ -82,6 +84,10 @@ namespace PoDoFo
     private:
         PdfCharCodeMap(CodeUnitMap&& mapping, CodeUnitRanges&& ranges, const PdfEncodingLimits& limits);
 
+        /// Construct a read-only map that queries the given tables in place
+        /// @remarks The tables must outlive the map
+        PdfCharCodeMap(const PdfCharCodeMapTable& table, const PdfEncodingLimits& limits);
+
     public:
         /// Method to push a mapping.
         /// Given string can be a ligature, es "ffi"
@@ -117,10 +123,20 @@ namespace PoDoFo
         /// Try get char code from unicode code point
         bool TryGetCharCode(codepoint codePoint, PdfCharCode& code) const;
 
+        /// Compile the map into flat lookup tables, that serve lookups
+        /// of 1-byte and 2-byte code units and of single code points
+        /// with a couple of memory loads
+        /// @remarks Pushing mappings or ranges discards the tables.
+        /// Maps of loaded CMaps are frozen automatically
+        void Freeze();
+
         PdfCharCodeMap& operator=(PdfCharCodeMap&& map) noexcept;
 
         const PdfEncodingLimits& GetLimits() const { return m_Limits; }
 
+        /// True if the map was compiled with Freeze()
+        bool IsFrozen() const { return m_frozen != nullptr; }
+
         bool IsEmpty() const;
 
         /// Determines if the map is a trivial identity
@@ -130,10 +146,10 @@ namespace PoDoFo
 
     public:
         /// Provides direct mappings
-        const CodeUnitMap& GetMappings() const { return m_Mappings; }
+        const CodeUnitMap& GetMappings() const;
 
         /// Provides range mappings
-        const CodeUnitRanges& GetRanges() const { return m_Ranges; }
+        const CodeUnitRanges& GetRanges() const;
 
     private:
         void move(PdfCharCodeMap& map) noexcept;
@@ -145,7 +161,10 @@ namespace PoDoFo
 
     private:
         void updateLimits(const PdfCharCode& codeUnit);
+        void materializeTable();
+        void detachTable();
         void reviseCodePointMap();
+        bool tryGetCharCodeFrozen(codepoint codePoint, PdfCharCode& code) const;
         bool tryFixNextRanges(const CodeUnitRanges::iterator& it, unsigned prevRangeCodeUpper);
 
     private:
@@ -154,6 +173,9 @@ namespace PoDoFo
         CodeUnitRanges m_Ranges;
         bool m_MapDirty;
         CodePointMapNode* m_codePointMapHead;           // Head of a BST to lookup code points
+        const PdfCharCodeMapTable* m_table;             // Read-only tables, for predefined CMaps
+        bool m_tableMaterialized;                       // True if the tables were copied to the mappings/ranges
+        std::unique_ptr<PdfCharCodeMapFrozen> m_frozen; // Flat lookup tables, see Freeze()
     };
 }
 
@@ -34,7 +34,7 @@ PdfContentStreamReader::PdfContentStreamReader(shared_ptr<InputStreamDevice>&& d
     if (device == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Device must be non null");
 
-    m_inputs.push_back({ nullptr, std::move(device), canvas });
+    m_inputs.push_back({ nullptr, std::move(device), canvas, nullptr, 0, nullptr });
 }
 
 bool PdfContentStreamReader::TryReadNext(PdfContent& content)
@@ -50,7 +50,7 @@ bool PdfContentStreamReader::TryReadNext(PdfContent& content)
         {
             if (m_args.InlineImageHandler == nullptr)
             {
-                if (!tryReadInlineImgData(content.Data.InlineImageData, content.Data.InlineImageDictionary,
+                if (!tryReadCachedInlineImgData(content.Data.InlineImageData, content.Data.InlineImageDictionary,
                     (m_args.Flags & PdfContentReaderFlags::SkipFetchInlineImages) != PdfContentReaderFlags::None))
                 {
                     goto PopDevice;
@@ -92,6 +92,12 @@ bool PdfContentStreamReader::TryReadNext(PdfContent& content)
 
     PopDevice:
         PODOFO_INVARIANT(m_inputs.size() != 0);
+        {
+            // The Form XObject has been fully tokenized, add it to the cache
+            auto& input = m_inputs.back();
+            if (input.Record != nullptr)
+                m_args.FormXObjectCache->add(input.Form->GetObject().GetIndirectReference(), std::move(input.Record));
+        }
         m_inputs.pop_back();
         if (m_inputs.size() == 0)
             goto Eof;
@@ -116,7 +122,7 @@ bool PdfContentStreamReader::tryReadNextContent(PdfContent& content)
 {
     while (true)
     {
-        bool gotToken = m_tokenizer.TryReadNext(*m_inputs.back().Device, m_temp.PsType, content.Data.Keyword, m_temp.Variant);
+        bool gotToken = tryReadNextToken(m_temp.PsType, content.Data.Keyword, m_temp.Variant);
         if (!gotToken)
         {
             content.Type = PdfContentType::Unknown;
@@ -169,6 +175,67 @@ bool PdfContentStreamReader::tryReadNextContent(PdfContent& content)
     }
 }
 
+// Returns false in case of EOF
+bool PdfContentStreamReader::tryReadNextToken(PdfPostScriptTokenType& type, string_view& keyword, PdfVariant& variant)
+{
+    auto& input = m_inputs.back();
+    if (input.Replay != nullptr)
+    {
+        if (input.ReplayIndex == input.Replay->size())
+            return false;
+
+        auto& token = (*input.Replay)[input.ReplayIndex++];
+        type = token.Type;
+        if (type == PdfPostScriptTokenType::Keyword)
+            keyword = token.Data;
+        else if (type == PdfPostScriptTokenType::Variant)
+            variant = token.Variant;
+
+        return true;
+    }
+
+    if (!m_tokenizer.TryReadNext(*input.Device, type, keyword, variant))
+        return false;
+
+    if (input.Record != nullptr)
+    {
+        if (type == PdfPostScriptTokenType::Variant)
+            input.Record->push_back({ type, { }, variant });
+        else
+            input.Record->push_back({ type, (string)keyword, { } });
+    }
+
+    return true;
+}
+
+bool PdfContentStreamReader::tryReadNextVariant(PdfVariant& variant)
+{
+    auto& input = m_inputs.back();
+    if (input.Replay != nullptr)
+    {
+        if (input.ReplayIndex == input.Replay->size()
+            || (*input.Replay)[input.ReplayIndex].Type != PdfPostScriptTokenType::Variant)
+        {
+            return false;
+        }
+
+        variant = (*input.Replay)[input.ReplayIndex++].Variant;
+        return true;
+    }
+
+    if (!m_tokenizer.TryReadNextVariant(*input.Device, variant))
+    {
+        // The tokenizer state can't be replayed, give up recording
+        input.Record = nullptr;
+        return false;
+    }
+
+    if (input.Record != nullptr)
+        input.Record->push_back({ PdfPostScriptTokenType::Variant, { }, variant });
+
+    return true;
+}
+
 void PdfContentStreamReader::beforeReadReset(PdfContent& content)
 {
     content.Data.Stack.Clear();
@@ -291,7 +358,7 @@ bool PdfContentStreamReader::tryReadInlineImgDict(PdfContent& content)
 {
     while (true)
     {
-        if (!m_tokenizer.TryReadNext(*m_inputs.back().Device, m_temp.PsType, m_temp.Keyword, m_temp.Variant))
+        if (!tryReadNextToken(m_temp.PsType, m_temp.Keyword, m_temp.Variant))
             return false;
 
         switch (m_temp.PsType)
@@ -320,7 +387,7 @@ bool PdfContentStreamReader::tryReadInlineImgDict(PdfContent& content)
             }
         }
 
-        if (m_tokenizer.TryReadNextVariant(*m_inputs.back().Device, m_temp.Variant))
+        if (tryReadNextVariant(m_temp.Variant))
             content.Data.InlineImageDictionary.AddKey(m_temp.Name, std::move(m_temp.Variant));
         else
             return false;
@@ -383,10 +450,22 @@ bool PdfContentStreamReader::tryHandleXObject(PdfContent& content)
             return true;
         }
 
-        m_inputs.push_back({
-            content.Data.XObject,
-            std::make_shared<PdfCanvasInputDevice>(static_cast<const PdfXObjectForm&>(*content.Data.XObject)),
-            dynamic_cast<const PdfCanvas*>(content.Data.XObject.get()) });
+        Input input{ content.Data.XObject, nullptr,
+            dynamic_cast<const PdfCanvas*>(content.Data.XObject.get()), nullptr, 0, nullptr };
+        auto& cache = m_args.FormXObjectCache;
+        if (cache != nullptr && m_args.InlineImageHandler == nullptr && xobjraw->IsIndirect())
+        {
+            // Replay the cached tokens, if the form was already read,
+            // or record them while reading the form the first time
+            input.Replay = cache->find(xobjraw->GetIndirectReference());
+            if (input.Replay == nullptr)
+                input.Record.reset(new PdfContentStreamCache::TokenList());
+        }
+
+        if (input.Replay == nullptr)
+            input.Device = std::make_shared<PdfCanvasInputDevice>(static_cast<const PdfXObjectForm&>(*content.Data.XObject));
+
+        m_inputs.push_back(std::move(input));
     }
     else
     {
@@ -407,6 +486,45 @@ InvalidXObj:
     return false;
 }
 
+// Returns false in case of EOF
+bool PdfContentStreamReader::tryReadCachedInlineImgData(charbuff& data,
+    const PdfDictionary& imageDict, bool skipFetchImage)
+{
+    auto& input = m_inputs.back();
+    if (input.Replay != nullptr)
+    {
+        if (input.ReplayIndex == input.Replay->size()
+            || (*input.Replay)[input.ReplayIndex].Type != PdfPostScriptTokenType::Unknown)
+        {
+            return false;
+        }
+
+        auto& token = (*input.Replay)[input.ReplayIndex++];
+        if (skipFetchImage)
+            data.clear();
+        else
+            data.assign(token.Data.begin(), token.Data.end());
+
+        return true;
+    }
+
+    if (input.Record == nullptr)
+        return tryReadInlineImgData(data, imageDict, skipFetchImage);
+
+    // The image data must be fetched anyway to be recorded
+    if (!tryReadInlineImgData(data, imageDict, false))
+    {
+        input.Record = nullptr;
+        return false;
+    }
+
+    input.Record->push_back({ PdfPostScriptTokenType::Unknown, string(data.data(), data.size()), { } });
+    if (skipFetchImage)
+        data.clear();
+
+    return true;
+}
+
 // Returns false in case of EOF
 bool PdfContentStreamReader::tryReadInlineImgData(charbuff& data,
     const PdfDictionary& imageDict, bool skipFetchImage)
@@ -617,3 +735,29 @@ void PdfContent::checkAccess(PdfContentType type) const
     if (Warnings != PdfContentWarnings::None && ThrowOnWarnings)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidContentStream, "Warnings present while accessing this content");
 }
+
+PdfContentStreamCache::PdfContentStreamCache() { }
+
+void PdfContentStreamCache::Clear()
+{
+    m_forms.clear();
+}
+
+unsigned PdfContentStreamCache::GetSize() const
+{
+    return (unsigned)m_forms.size();
+}
+
+shared_ptr<const PdfContentStreamCache::TokenList> PdfContentStreamCache::find(const PdfReference& form) const
+{
+    auto found = m_forms.find(form);
+    if (found == m_forms.end())
+        return nullptr;
+
+    return found->second;
+}
+
+void PdfContentStreamCache::add(const PdfReference& form, unique_ptr<TokenList>&& tokens)
+{
+    m_forms[form] = std::move(tokens);
+}
@@ -112,10 +112,61 @@ enum class PdfContentReaderFlags
 /// @returns false if EOF
 using PdfInlineImageHandler = std::function<bool(const PdfDictionary& imageDict, InputStreamDevice& device)>;
 
+/// Cache of tokenized Form XObjects contents
+///
+/// When set in PdfContentReaderArgs, the contents of every Form XObject
+/// followed by the reader are tokenized once, and replayed from the
+/// cache the next times the same Form XObject is drawn, also across
+/// pages and readers sharing the cache
+/// \remarks The cache is keyed by the Form XObject indirect reference,
+/// so it shall be used to read the contents of a single document and
+/// it must be cleared if the forms contents are modified. It's not thread safe
+class PODOFO_API PdfContentStreamCache final
+{
+    friend class PdfContentStreamReader;
+
+public:
+    PdfContentStreamCache();
+
+public:
+    /// Remove all the cached Form XObjects contents
+    void Clear();
+
+    /// Get the number of cached Form XObjects
+    unsigned GetSize() const;
+
+private:
+    struct Token
+    {
+        // NOTE: PdfPostScriptTokenType::Unknown is
+        // used for inline image data, stored in Data
+        PdfPostScriptTokenType Type;
+        std::string Data;
+        PdfVariant Variant;
+    };
+
+    using TokenList = std::vector<Token>;
+
+private:
+    std::shared_ptr<const TokenList> find(const PdfReference& form) const;
+    void add(const PdfReference& form, std::unique_ptr<TokenList>&& tokens);
+
+private:
+    PdfContentStreamCache(const PdfContentStreamCache&) = delete;
+    PdfContentStreamCache& operator=(const PdfContentStreamCache&) = delete;
+
+private:
+    std::unordered_map<PdfReference, std::shared_ptr<const TokenList>> m_forms;
+};
+
 struct PODOFO_API PdfContentReaderArgs final
 {
     PdfContentReaderFlags Flags = PdfContentReaderFlags::None;
     PdfInlineImageHandler InlineImageHandler;
+    /// Optional cache of tokenized Form XObjects contents, which can
+    /// be shared by multiple readers. It's not used when
+    /// InlineImageHandler is set
+    std::shared_ptr<PdfContentStreamCache> FormXObjectCache;
 };
 
 /// Reader class to read content streams
@@ -140,10 +191,16 @@ private:
 
     bool tryReadNextContent(PdfContent& content);
 
+    bool tryReadNextToken(PdfPostScriptTokenType& type, std::string_view& keyword, PdfVariant& variant);
+
+    bool tryReadNextVariant(PdfVariant& variant);
+
     bool tryHandleOperator(PdfContent& content, bool& eof);
 
     bool tryReadInlineImgDict(PdfContent& content);
 
+    bool tryReadCachedInlineImgData(charbuff& data, const PdfDictionary& imageDict, bool skipSaveImage);
+
     bool tryReadInlineImgData(charbuff& data, const PdfDictionary& imageDict, bool skipSaveImage);
 
     bool tryHandleXObject(PdfContent& content);
@@ -164,6 +221,11 @@ private:
         std::shared_ptr<const PdfXObject> Form;
         std::shared_ptr<InputStreamDevice> Device;
         const PdfCanvas* Canvas;
+        // Cached tokens being replayed, in place of reading the device
+        std::shared_ptr<const PdfContentStreamCache::TokenList> Replay;
+        size_t ReplayIndex = 0;
+        // Tokens being recorded to be added to the cache
+        std::unique_ptr<PdfContentStreamCache::TokenList> Record;
     };
 
 private:
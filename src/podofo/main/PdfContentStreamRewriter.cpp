@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfContentStreamRewriter.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+// Size of the formatted content buffered before
+// being written to the output stream
+constexpr unsigned FlushThreshold = 65536;
+
+PdfContentStreamRewriter::PdfContentStreamRewriter(PdfContentReaderFlags flags)
+{
+    // Form XObjects must not be followed, and "Do" operators
+    // must be issued as regular operators to be written back
+    m_args.Flags = (flags & PdfContentReaderFlags::ThrowOnWarnings)
+        | PdfContentReaderFlags::SkipFollowFormXObjects
+        | PdfContentReaderFlags::SkipHandleNonFormXObjects;
+}
+
+void PdfContentStreamRewriter::AddTransform(PdfContentTransform transform)
+{
+    if (transform == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Transform must be non null");
+
+    m_transforms.push_back(std::move(transform));
+}
+
+void PdfContentStreamRewriter::Rewrite(PdfCanvas& canvas)
+{
+    // NOTE: The canvas contents can't be replaced while they are
+    // being read, so write them to a temporary object stream first
+    PdfObject temp;
+    auto& tempStream = temp.GetOrCreateStream();
+    {
+        PdfContentStreamReader reader(canvas, m_args);
+        auto output = tempStream.GetOutputStream();
+        rewrite(reader, output);
+    }
+
+    auto& stream = canvas.ResetContentsStream();
+    PdfFilterList filters = tempStream.GetFilters();
+    auto input = tempStream.GetInputStream(true);
+    stream.SetData(input, filters, true);
+}
+
+void PdfContentStreamRewriter::Rewrite(shared_ptr<InputStreamDevice> input, OutputStream& output)
+{
+    PdfContentStreamReader reader(std::move(input), m_args);
+    rewrite(reader, output);
+}
+
+void PdfContentStreamRewriter::rewrite(PdfContentStreamReader& reader, OutputStream& output)
+{
+    PdfContent content;
+    PdfStringStream stream;
+    PdfStringStream image;
+    bool skipImage = false;
+    while (reader.TryReadNext(content))
+    {
+        switch (content.GetType())
+        {
+            case PdfContentType::ImageDictionary:
+            {
+                // Defer writing the inline image until its data is read
+                image.Clear();
+                skipImage = !tryTransform(content);
+                if (!skipImage)
+                    writeContent(image, content);
+
+                break;
+            }
+            case PdfContentType::ImageData:
+            {
+                if (skipImage || !tryTransform(content))
+                {
+                    skipImage = false;
+                    break;
+                }
+
+                stream << image.GetString();
+                writeContent(stream, content);
+                break;
+            }
+            default:
+            {
+                if (tryTransform(content))
+                    writeContent(stream, content);
+
+                break;
+            }
+        }
+
+        if (stream.GetSize() >= FlushThreshold)
+        {
+            output.Write(stream.GetString());
+            stream.Clear();
+        }
+    }
+
+    output.Write(stream.GetString());
+}
+
+bool PdfContentStreamRewriter::tryTransform(PdfContent& content)
+{
+    for (auto& transform : m_transforms)
+    {
+        if (!transform(content))
+            return false;
+    }
+
+    return true;
+}
+
+void PdfContentStreamRewriter::writeContent(PdfStringStream& stream, const PdfContent& content)
+{
+    switch (content.GetType())
+    {
+        case PdfContentType::Operator:
+        case PdfContentType::UnexpectedKeyword:
+        {
+            writeOperands(stream, content->Stack);
+            if (content->Operator == PdfOperator::Unknown)
+                stream << content->Keyword;
+            else
+                stream << PoDoFo::ToString(content->Operator);
+
+            stream << '\n';
+            break;
+        }
+        case PdfContentType::ImageDictionary:
+        {
+            writeOperands(stream, content->Stack);
+            stream << "BI\n";
+            for (auto& pair : content->InlineImageDictionary)
+            {
+                pair.first.Write(stream, PdfWriteFlags::NoInlineLiteral, nullptr, m_buffer);
+                stream << ' ';
+                pair.second.GetVariant().Write(stream, PdfWriteFlags::NoInlineLiteral, nullptr, m_buffer);
+                stream << '\n';
+            }
+
+            stream << "ID ";
+            break;
+        }
+        case PdfContentType::ImageData:
+        {
+            auto& data = content->InlineImageData;
+            stream << string_view(data.data(), data.size());
+            if (data.size() == 0 || !PoDoFo::IsCharWhitespace(data[data.size() - 1]))
+                stream << '\n';
+
+            stream << "EI\n";
+            break;
+        }
+        default:
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Unsupported content type");
+        }
+    }
+}
+
+void PdfContentStreamRewriter::writeOperands(PdfStringStream& stream, const PdfVariantStack& operands)
+{
+    // NOTE: Iterate the stack in reverse, which is the push order
+    for (auto it = operands.rbegin(); it != operands.rend(); it++)
+    {
+        it->Write(stream, PdfWriteFlags::NoInlineLiteral, nullptr, m_buffer);
+        stream << ' ';
+    }
+}
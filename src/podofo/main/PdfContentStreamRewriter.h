@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_CONTENT_STREAM_REWRITER_H
+#define PDF_CONTENT_STREAM_REWRITER_H
+
+#include "PdfContentStreamReader.h"
+#include "PdfStringStream.h"
+
+namespace PoDoFo {
+
+/// Transform applied to every content read by PdfContentStreamRewriter
+/// @param content the content just read, which can be modified in place.
+/// Operands and the operator, or the keyword if the operator is
+/// PdfOperator::Unknown, are written back. Inline image dictionary
+/// and data can be modified as well
+/// @returns false to drop the content from the output. Dropping an
+/// ImageDictionary or ImageData content drops the whole inline image
+using PdfContentTransform = std::function<bool(PdfContent& content)>;
+
+/// Rewrite content streams applying a chain of transforms
+///
+/// Contents are read with PdfContentStreamReader and written back
+/// one by one to an output stream, so decoded content streams are
+/// never fully loaded in memory. Form XObjects are not followed and
+/// "Do" operators are issued as regular operators
+class PODOFO_API PdfContentStreamRewriter final
+{
+public:
+    /// @param flags reader flags. Only PdfContentReaderFlags::ThrowOnWarnings is honored
+    PdfContentStreamRewriter(PdfContentReaderFlags flags = PdfContentReaderFlags::None);
+
+public:
+    /// Append a transform to the chain. Transforms are applied in
+    /// the same order they are added, until one drops the content
+    void AddTransform(PdfContentTransform transform);
+
+    /// Rewrite the contents of the canvas, replacing them with a
+    /// single flate compressed content stream
+    /// @remarks Contents are written to a temporary memory buffer
+    /// while reading, which holds only the compressed data
+    void Rewrite(PdfCanvas& canvas);
+
+    /// Rewrite the contents read from the input device to the output stream
+    void Rewrite(std::shared_ptr<InputStreamDevice> input, OutputStream& output);
+
+private:
+    void rewrite(PdfContentStreamReader& reader, OutputStream& output);
+    bool tryTransform(PdfContent& content);
+    void writeContent(PdfStringStream& stream, const PdfContent& content);
+    void writeOperands(PdfStringStream& stream, const PdfVariantStack& operands);
+
+private:
+    std::vector<PdfContentTransform> m_transforms;
+    PdfContentReaderArgs m_args;
+    charbuff m_buffer;
+};
+
+}
+
+#endif // PDF_CONTENT_STREAM_REWRITER_H
@@ -450,6 +450,14 @@ enum class PdfSaveOptions
     /// This currently applies only during singing, and allows to
     /// sign documents with broken xref sections. Use with caution.
     IgnoreXRefErrors = 128, 
+    /// Merge identical resource objects before saving
+    /// @see PdfDocument::DeduplicateObjects()
+    DeduplicateObjects = 256,
+    /// Copy verbatim from the source device the objects that were
+    /// loaded and not modified, instead of serializing them again
+    /// @remarks Unfiltered streams of such objects will not be compressed.
+    /// It has no effect on incremental updates, which don't write them
+    CopyUnmodifiedObjects = 512,
 
     /// @deprecated Use NoMetadataUpdate instead
     NoModifyDateUpdate = NoMetadataUpdate
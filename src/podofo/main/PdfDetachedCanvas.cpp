@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfDetachedCanvas.h"
+#include "PdfPage.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+PdfDetachedCanvas::PdfDetachedCanvas(unique_ptr<PdfPage>&& page)
+    : m_page(std::move(page))
+{
+}
+
+PdfDetachedCanvas::~PdfDetachedCanvas() { }
+
+PdfObjectStream& PdfDetachedCanvas::GetOrCreateContentsStream(PdfStreamAppendFlags flags)
+{
+    (void)flags; // Flags have no use here
+    checkAppended();
+    // NOTE: The contents object has no parent document,
+    // so its stream is backed by a private memory buffer
+    return m_contents.GetOrCreateStream();
+}
+
+PdfObjectStream& PdfDetachedCanvas::ResetContentsStream()
+{
+    checkAppended();
+    auto& ret = m_contents.GetOrCreateStream();
+    ret.Clear();
+    return ret;
+}
+
+void PdfDetachedCanvas::CopyContentsTo(OutputStream& stream) const
+{
+    auto objStream = m_contents.GetStream();
+    if (objStream == nullptr)
+        return;
+
+    objStream->CopyTo(stream);
+}
+
+PdfResources& PdfDetachedCanvas::GetOrCreateResources()
+{
+    checkAppended();
+    return m_page->GetOrCreateResources();
+}
+
+Corners PdfDetachedCanvas::GetRectRaw() const
+{
+    checkAppended();
+    return m_page->GetRectRaw();
+}
+
+bool PdfDetachedCanvas::TryGetRotationRadians(double& teta) const
+{
+    teta = 0;
+    return false;
+}
+
+PdfPage& PdfDetachedCanvas::GetPage()
+{
+    checkAppended();
+    return *m_page;
+}
+
+const PdfPage& PdfDetachedCanvas::GetPage() const
+{
+    checkAppended();
+    return *m_page;
+}
+
+PdfObject* PdfDetachedCanvas::getContentsObject()
+{
+    return &m_contents;
+}
+
+PdfResources* PdfDetachedCanvas::getResources()
+{
+    if (m_page == nullptr)
+        return nullptr;
+
+    return &m_page->GetResources();
+}
+
+PdfDictionaryElement& PdfDetachedCanvas::getElement()
+{
+    checkAppended();
+    return *m_page;
+}
+
+unique_ptr<PdfPage> PdfDetachedCanvas::TakePage()
+{
+    checkAppended();
+    auto objStream = m_contents.GetStream();
+    if (objStream != nullptr && objStream->GetLength() != 0)
+    {
+        // Copy the already encoded contents as they are
+        auto& stream = m_page->GetOrCreateContentsStream(PdfStreamAppendFlags::NoSaveRestorePrior);
+        PdfFilterList filters = objStream->GetFilters();
+        {
+            auto input = objStream->GetInputStream(true);
+            stream.SetData(input, filters, true);
+        }
+        objStream->Clear();
+    }
+
+    return std::move(m_page);
+}
+
+void PdfDetachedCanvas::checkAppended() const
+{
+    if (m_page == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The canvas has been already appended to the document");
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_DETACHED_CANVAS_H
+#define PDF_DETACHED_CANVAS_H
+
+#include "PdfCanvas.h"
+
+namespace PoDoFo {
+
+class PdfPage;
+
+/// A canvas for a page not yet inserted in the document page tree
+///
+/// The page dictionary is allocated in the document on creation,
+/// while painted contents are kept in a private memory stream. Painting
+/// a detached canvas doesn't touch any shared document state, hence
+/// separate PdfPainter instances can draw separate canvases concurrently,
+/// one per thread. Canvases shall be created and appended to the page
+/// tree with PdfPageCollection::AppendDetachedCanvas() sequentially, which
+/// assigns object numbers deterministically
+/// \remarks Objects referenced while painting, such as images, forms,
+/// graphics states, patterns, shadings and color spaces, shall be fully
+/// created/loaded beforehand and not modified while painting: the
+/// painter only reads their references and adds them to the resources
+/// of the canvas page, which are private to the canvas. Path, color,
+/// graphics state and XObject operations are therefore safe to call
+/// from concurrent canvases. Text operations (DrawText*, AddText) encode
+/// strings on shared fonts, updating their subsets and dynamic encodings:
+/// PdfPainter serializes them with a per font lock. Other font calls that
+/// update the font, such as PdfFont::AddSubsetCIDs(), are not locked
+/// and shall not be called concurrently with painting
+class PODOFO_API PdfDetachedCanvas final : public PdfCanvas
+{
+    friend class PdfPageCollection;
+
+private:
+    PdfDetachedCanvas(std::unique_ptr<PdfPage>&& page);
+
+public:
+    ~PdfDetachedCanvas();
+
+    PdfObjectStream& GetOrCreateContentsStream(PdfStreamAppendFlags flags) override;
+
+    PdfObjectStream& ResetContentsStream() override;
+
+    void CopyContentsTo(OutputStream& stream) const override;
+
+    PdfResources& GetOrCreateResources() override;
+
+    Corners GetRectRaw() const override;
+
+    bool TryGetRotationRadians(double& teta) const override;
+
+    /// Get the page that will be inserted in the page tree
+    /// @remarks The page must not be modified while painting
+    /// concurrently. Only the page /MediaBox is honored by the painter
+    PdfPage& GetPage();
+    const PdfPage& GetPage() const;
+
+    /// True if the canvas has been already appended to the document
+    bool IsAppended() const { return m_page == nullptr; }
+
+protected:
+    PdfObject* getContentsObject() override;
+    PdfResources* getResources() override;
+    PdfDictionaryElement& getElement() override;
+
+private:
+    /// Move the page and the painted contents to the document
+    std::unique_ptr<PdfPage> TakePage();
+
+    void checkAppended() const;
+
+private:
+    PdfDetachedCanvas(const PdfDetachedCanvas&) = delete;
+    PdfDetachedCanvas& operator=(const PdfDetachedCanvas&) = delete;
+
+private:
+    std::unique_ptr<PdfPage> m_page;
+    PdfObject m_contents;
+};
+
+}
+
+#endif // PDF_DETACHED_CANVAS_H
@@ -298,6 +298,16 @@ void PdfDifferenceEncoding::GetBaseEncoding(const PdfEncodingMap*& baseEncoding,
 void PdfDifferenceEncoding::getExportObject(PdfIndirectObjectList& objects, PdfName& name, PdfObject*& obj) const
 {
     (void)name;
+    getExportObject(objects, nullptr, obj);
+}
+
+void PdfDifferenceEncoding::getSubsetExportObject(PdfIndirectObjectList& objects, const set<PdfCharCode>& codes, PdfObject*& obj) const
+{
+    getExportObject(objects, &codes, obj);
+}
+
+void PdfDifferenceEncoding::getExportObject(PdfIndirectObjectList& objects, const set<PdfCharCode>* codes, PdfObject*& obj) const
+{
     obj = &objects.CreateDictionaryObject();
     auto& dict = obj->GetDictionary();
 
@@ -314,11 +324,25 @@ void PdfDifferenceEncoding::getExportObject(PdfIndirectObjectList& objects, PdfN
         dict.AddKey("BaseEncoding"_n, baseExportName);
     }
 
-    if (m_differences.GetCount() != 0)
+    const PdfDifferenceMap* differences = &m_differences;
+    PdfDifferenceMap subsetDifferences;
+    if (codes != nullptr)
+    {
+        // Keep only the differences of the used char codes
+        for (auto& diff : m_differences.m_differences)
+        {
+            if (codes->find(PdfCharCode(diff.Code, 1)) != codes->end())
+                subsetDifferences.m_differences.push_back(diff);
+        }
+
+        differences = &subsetDifferences;
+    }
+
+    if (differences->GetCount() != 0)
     {
-        PdfArray differences;
-        m_differences.ToArray(differences);
-        dict.AddKey("Differences"_n, differences);
+        PdfArray arr;
+        differences->ToArray(arr);
+        dict.AddKey("Differences"_n, arr);
     }
 }
 
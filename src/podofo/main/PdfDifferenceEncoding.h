@@ -104,6 +104,7 @@ private:
 class PODOFO_API PdfDifferenceEncoding final : public PdfEncodingMapSimple
 {
     friend class PdfDifferenceMap;
+    friend class PdfEncoding;
 
 public:
     /// Create a new PdfDifferenceEncoding which is based on
@@ -160,6 +161,11 @@ private:
 
     void buildReverseMap();
 
+    /// Get an export object with only the differences of the given char codes
+    void getSubsetExportObject(PdfIndirectObjectList& objects, const std::set<PdfCharCode>& codes, PdfObject*& obj) const;
+
+    void getExportObject(PdfIndirectObjectList& objects, const std::set<PdfCharCode>* codes, PdfObject*& obj) const;
+
 private:
     PdfEncodingMapConstPtr m_baseEncoding;
     PdfDifferenceMap m_differences;
@@ -4,6 +4,7 @@
 
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include <podofo/private/XMPUtils.h>
+#include <podofo/private/PdfObjectDeduplicator.h>
 #include "PdfDocument.h"
 
 #include "PdfExtGState.h"
@@ -393,12 +394,12 @@ Rect PdfDocument::FillXObjectFromPage(PdfXObjectForm& xobj, const PdfPage& page,
             double ty = annotRect.GetBottom() - apRect.GetBottom() * scaleY;
 
             PdfStringStream stream;
-            stream << std::endl << "q" << std::endl
+            stream << "\nq\n"
                 << scaleX << " 0 0 "
                 << scaleY << " "
                 << tx << " "
-                << ty << " cm" << std::endl
-                << "/" << static_cast<PdfResourceOperations&>(xobj.GetOrCreateResources()).AddResource(PdfResourceType::XObject, apObjCopy).GetString() << " Do" << std::endl << "Q" << std::endl;
+                << ty << " cm\n"
+                << "/" << static_cast<PdfResourceOperations&>(xobj.GetOrCreateResources()).AddResource(PdfResourceType::XObject, apObjCopy).GetString() << " Do\nQ\n";
 
             output.Write(stream.GetString());
         }
@@ -412,6 +413,15 @@ void PdfDocument::CollectGarbage(PdfGarbageCollectionFlags flags)
     m_Objects.CollectGarbage(flags);
 }
 
+unsigned PdfDocument::DeduplicateObjects()
+{
+    PdfObjectDeduplicator deduplicator(*this);
+    for (auto& pair : GetFonts().m_fonts)
+        deduplicator.AddPinnedObject(pair.first);
+
+    return deduplicator.Execute();
+}
+
 PdfOutlines& PdfDocument::GetOrCreateOutlines()
 {
     lazyLoadOutlines();
@@ -111,6 +111,7 @@ class PODOFO_API PdfDocument
     friend class PdfPageCollection;
     friend class PdfMemDocument;
     friend class PdfStreamedDocument;
+    friend class PdfIncrementalEditor;
 
 public:
     /// Close down/destruct the PdfDocument
@@ -141,6 +142,15 @@ public:
 
     void CollectGarbage(PdfGarbageCollectionFlags flags = PdfGarbageCollectionFlags::None);
 
+    /// Merge identical objects reachable from page resources and
+    /// annotation appearances, such as images, fonts and form XObjects,
+    /// rewriting all the references to them
+    /// @returns the number of merged objects
+    /// @remarks Merged objects are left unreferenced and they are removed
+    /// by the next garbage collection, which by default happens on saving.
+    /// Objects of fonts owned by the document are never merged away
+    unsigned DeduplicateObjects();
+
     /// Construct a new PdfImage object
     std::unique_ptr<PdfImage> CreateImage();
 
@@ -12,6 +12,7 @@
 #include "PdfDocument.h"
 #include "PdfDictionary.h"
 #include "PdfEncodingMapFactory.h"
+#include "PdfDifferenceEncoding.h"
 
 using namespace std;
 using namespace PoDoFo;
@@ -181,6 +182,12 @@ bool PdfEncoding::TryConvertToEncoded(const string_view& str, charbuff& encoded)
     }
 }
 
+bool PdfEncoding::tryGetCharCode(unsigned gid, const unicodeview& codePoints, PdfCharCode& codeUnit) const
+{
+    PODOFO_ASSERT(m_Font != nullptr);
+    return tryGetCharCode(*m_Font, gid, codePoints, codeUnit);
+}
+
 bool PdfEncoding::tryGetCharCode(PdfFont& font, unsigned gid, const unicodeview& codePoints, PdfCharCode& codeUnit) const
 {
     if (font.IsSubsettingEnabled() && !font.IsProxy())
@@ -379,11 +386,22 @@ void PdfEncoding::exportToFont(PdfFont& font, const PdfCIDSystemInfo* cidInfo) c
     }
     else // Simple font
     {
-        if (!tryExportEncodingTo(fontDict, false))
-            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The encoding should supply an export object");
+        unique_ptr<set<PdfCharCode>> charCodeSubset;
+        if (font.IsSubsettingEnabled() && (charCodeSubset = font.GetCharCodeSubset()) != nullptr)
+        {
+            // Export only the char codes used by the subset
+            exportEncodingSubsetTo(fontDict, *charCodeSubset);
+            fontDict.AddKey("FirstChar"_n, PdfVariant(static_cast<int64_t>(charCodeSubset->begin()->Code)));
+            fontDict.AddKey("LastChar"_n, PdfVariant(static_cast<int64_t>(charCodeSubset->rbegin()->Code)));
+        }
+        else
+        {
+            if (!tryExportEncodingTo(fontDict, false))
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The encoding should supply an export object");
 
-        fontDict.AddKey("FirstChar"_n, PdfVariant(static_cast<int64_t>(GetFirstChar().Code)));
-        fontDict.AddKey("LastChar"_n, PdfVariant(static_cast<int64_t>(GetLastChar().Code)));
+            fontDict.AddKey("FirstChar"_n, PdfVariant(static_cast<int64_t>(GetFirstChar().Code)));
+            fontDict.AddKey("LastChar"_n, PdfVariant(static_cast<int64_t>(GetLastChar().Code)));
+        }
     }
 
     auto& cmapObj = fontDict.GetOwner()->GetDocument()->GetObjects().CreateDictionaryObject();
@@ -396,6 +414,25 @@ PdfStringScanContext PdfEncoding::StartStringScan(const PdfString& encodedStr)
     return PdfStringScanContext(encodedStr.GetRawData(), *this);
 }
 
+void PdfEncoding::exportEncodingSubsetTo(PdfDictionary& dictionary, const set<PdfCharCode>& codes) const
+{
+    // NOTE: Differences other than the ones of the used
+    // char codes are not written. Other encodings have a
+    // name representation, which is exported unchanged
+    auto diffEncoding = dynamic_cast<const PdfDifferenceEncoding*>(m_Encoding.get());
+    if (diffEncoding == nullptr)
+    {
+        if (!tryExportEncodingTo(dictionary, false))
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The encoding should supply an export object");
+
+        return;
+    }
+
+    PdfObject* obj;
+    diffEncoding->getSubsetExportObject(dictionary.GetOwner()->GetDocument()->GetObjects(), codes, obj);
+    dictionary.AddKeyIndirect("Encoding"_n, *obj);
+}
+
 bool PdfEncoding::tryExportEncodingTo(PdfDictionary& dictionary, bool wantCIDMapping) const
 {
     if (wantCIDMapping && !HasCIDMapping())
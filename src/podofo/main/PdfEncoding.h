@@ -191,11 +191,15 @@ namespace PoDoFo
     private:
         void exportToFont(PdfFont& font, const PdfCIDSystemInfo* cidInfo) const;
         bool tryExportEncodingTo(PdfDictionary& dictionary, bool wantCidMapping) const;
+        void exportEncodingSubsetTo(PdfDictionary& dictionary, const std::set<PdfCharCode>& codes) const;
         bool tryConvertEncodedToUtf8(const std::string_view& encoded, std::string& str) const;
         bool tryConvertEncodedToCIDs(const std::string_view& encoded, std::vector<PdfCID>& cids) const;
         void writeCIDMapping(PdfObject& cmapObj, const PdfFont& font, const PdfCIDSystemInfo& info) const;
         void writeToUnicodeCMap(PdfObject& cmapObj, const PdfFont& font) const;
         bool tryGetCharCode(PdfFont& font, unsigned gid, const unicodeview& codePoints, PdfCharCode& unit) const;
+        // Get the code unit of a glyph of the font this encoding belongs
+        // to, possibly adding it to the subset or to the dynamic encoding
+        bool tryGetCharCode(unsigned gid, const unicodeview& codePoints, PdfCharCode& unit) const;
 
     private:
         unsigned m_Id;
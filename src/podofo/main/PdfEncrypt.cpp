@@ -304,6 +304,134 @@ private:
     size_t m_drainLeft;
 };
 
+/// An OutputStream that encrypts all data written using the AES-CBC
+/// encryption algorithm, without buffering it. The initialization vector
+/// is written before the cipher text and the final padded block is written
+/// by Finish(), or when the stream is disposed if it wasn't called
+class PdfAESOutputStream : public OutputStream
+{
+    // Encrypt large writes in chunks to bound the size of the temporary buffer
+    static constexpr size_t ChunkSize = 65536;
+
+public:
+    PdfAESOutputStream(OutputStream& outputStream, const unsigned char* key, unsigned keylen,
+        const unsigned char iv[AES_IV_LENGTH]) :
+        m_OutputStream(&outputStream),
+        m_init(true),
+        m_uncaughtExceptions(std::uncaught_exceptions())
+    {
+        const EVP_CIPHER* cipher;
+        switch (keylen)
+        {
+            case (size_t)PdfKeyLength::L128 / 8:
+            {
+                cipher = ssl::Aes128();
+                break;
+            }
+            case (size_t)PdfKeyLength::L256 / 8:
+            {
+                cipher = ssl::Aes256_CBC();
+                break;
+            }
+            default:
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Invalid AES key length");
+        }
+
+        m_ctx = EVP_CIPHER_CTX_new();
+        if (m_ctx == nullptr)
+            PODOFO_RAISE_ERROR(PdfErrorCode::OutOfMemory);
+
+        if (EVP_EncryptInit_ex(m_ctx, cipher, nullptr, key, iv) != 1)
+        {
+            EVP_CIPHER_CTX_free(m_ctx);
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error initializing AES encryption engine");
+        }
+
+        std::memcpy(m_iv, iv, AES_IV_LENGTH);
+    }
+
+    ~PdfAESOutputStream()
+    {
+        // NOTE: Don't write anything if the stream is
+        // disposed because of an exception
+        if (m_ctx != nullptr && std::uncaught_exceptions() == m_uncaughtExceptions)
+        {
+            try
+            {
+                Finish();
+            }
+            catch (PdfError& e)
+            {
+                PoDoFo::LogMessage(PdfLogSeverity::Error, "Error finishing AES encryption: {}", e.what());
+            }
+        }
+
+        EVP_CIPHER_CTX_free(m_ctx);
+    }
+
+    /// Write the last block, padded as specified by PKCS#7
+    void Finish()
+    {
+        if (m_ctx == nullptr)
+            return;
+
+        unsigned char lastBlock[AES_BLOCK_SIZE];
+        int outlen;
+        int rc = EVP_EncryptFinal_ex(m_ctx, lastBlock, &outlen);
+        EVP_CIPHER_CTX_free(m_ctx);
+        m_ctx = nullptr;
+        if (rc != 1)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error AES-encrypting data padding");
+
+        writeInitialVector();
+        m_OutputStream->Write((const char*)lastBlock, (size_t)outlen);
+    }
+
+protected:
+    void writeBuffer(const char* buffer, size_t size) override
+    {
+        if (m_ctx == nullptr)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The AES encryption was already finished");
+
+        writeInitialVector();
+        while (size != 0)
+        {
+            size_t chunkSize = std::min(size, ChunkSize);
+
+            // Quote openssl.org: "the amount of data written may be anything from zero bytes
+            // to (inl + cipher_block_size - 1)"
+            m_tempBuffer.resize(chunkSize + AES_BLOCK_SIZE);
+            int outlen;
+            if (EVP_EncryptUpdate(m_ctx, m_tempBuffer.data(), &outlen, (const unsigned char*)buffer, (int)chunkSize) != 1)
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Error AES-encrypting data");
+
+            m_OutputStream->Write((const char*)m_tempBuffer.data(), (size_t)outlen);
+            buffer += chunkSize;
+            size -= chunkSize;
+        }
+    }
+
+private:
+    void writeInitialVector()
+    {
+        // NOTE: Write the initialization vector lazily, as the
+        // stream can be created before the object header is written
+        if (!m_init)
+            return;
+
+        m_OutputStream->Write((const char*)m_iv, AES_IV_LENGTH);
+        m_init = false;
+    }
+
+private:
+    EVP_CIPHER_CTX* m_ctx;
+    OutputStream* m_OutputStream;
+    bool m_init;
+    int m_uncaughtExceptions;
+    unsigned char m_iv[AES_IV_LENGTH];
+    vector<unsigned char> m_tempBuffer;
+};
+
 struct RC4EncryptContext
 {
     unsigned char Rc4key[16];         // last RC4 key
@@ -331,6 +459,7 @@ void PdfEncrypt::EnsureEncryptionInitialized(const PdfString& documentId, PdfEnc
 
     GenerateEncryptionKey(documentId.GetRawData(), context.GetAuthResult(), context.GetCryptCtx(),
         m_uValue, m_oValue, context.m_encryptionKey);
+    context.m_hasObjKey = false;
     context.m_documentId = documentId.GetRawData();
 
     PODOFO_INVARIANT(!m_initialized);
@@ -345,6 +474,7 @@ void PdfEncrypt::EnsureEncryptionInitialized(const PdfString& documentId, PdfEnc
 void PdfEncrypt::Authenticate(const string_view& password, const PdfString& documentId, PdfEncryptContext& context) const
 {
     context.m_AuthResult = Authenticate(password, documentId.GetRawData(), context.GetCryptCtx(), context.m_encryptionKey);
+    context.m_hasObjKey = false;
     context.m_documentId = documentId.GetRawData();
 }
 
@@ -537,6 +667,14 @@ unique_ptr<PdfEncrypt> PdfEncrypt::CreateFromEncrypt(const PdfEncrypt& rhs)
     }
 }
 
+void PdfEncrypt::FinishEncryptionOutputStream(OutputStream& stream)
+{
+    // NOTE: Only AES encryption streams have data left to write
+    auto aesStream = dynamic_cast<PdfAESOutputStream*>(&stream);
+    if (aesStream != nullptr)
+        aesStream->Finish();
+}
+
 void PdfEncrypt::clearSensitiveInfo()
 {
     // Clear sensitive information to not leave traces in memory
@@ -615,7 +753,10 @@ PdfEncryptContext::PdfEncryptContext() :
     m_AuthResult(PdfAuthResult::Unkwnon),
     m_cryptCtx(nullptr),
     m_customCtx(nullptr),
-    m_customCtxSize(0)
+    m_customCtxSize(0),
+    m_hasObjKey(false),
+    m_objKey{ },
+    m_objKeyLength(0)
 {
 }
 
@@ -623,6 +764,7 @@ PdfEncryptContext::~PdfEncryptContext()
 {
     // Clear sensitive information to not leave traces in memory
     std::memset(m_encryptionKey, 0, std::size(m_encryptionKey));
+    std::memset(m_objKey, 0, std::size(m_objKey));
     if (m_customCtx != nullptr)
         std::memset(m_customCtx, 0, m_customCtxSize);
 
@@ -634,7 +776,10 @@ PdfEncryptContext::PdfEncryptContext(const PdfEncryptContext& rhs) :
     m_AuthResult(rhs.m_AuthResult),
     m_cryptCtx(nullptr),
     m_customCtx(nullptr),
-    m_customCtxSize(0)
+    m_customCtxSize(0),
+    m_hasObjKey(false),
+    m_objKey{ },
+    m_objKeyLength(0)
 {
     std::memcpy(m_encryptionKey, rhs.m_encryptionKey, std::size(m_encryptionKey));
     if (rhs.m_customCtx != nullptr)
@@ -649,6 +794,7 @@ PdfEncryptContext& PdfEncryptContext::operator=(const PdfEncryptContext& rhs)
 {
     m_AuthResult = rhs.m_AuthResult;
     std::memcpy(m_encryptionKey, rhs.m_encryptionKey, std::size(m_encryptionKey));
+    m_hasObjKey = false;
     EVP_CIPHER_CTX_free(m_cryptCtx);
     m_cryptCtx = nullptr;
     ::operator delete(m_customCtx);
@@ -887,8 +1033,16 @@ void PdfEncryptMD5Base::ComputeEncryptionKey(const string_view& documentId,
 }
 
 void PdfEncryptMD5Base::CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLen,
-    const unsigned char encryptionKey[32], const PdfReference& objref) const
+    PdfEncryptContext& context, const PdfReference& objref) const
 {
+    if (context.m_hasObjKey && context.m_objKeyRef == objref)
+    {
+        std::memcpy(objkey, context.m_objKey, MD5_DIGEST_LENGTH);
+        pnKeyLen = context.m_objKeyLength;
+        return;
+    }
+
+    auto encryptionKey = context.GetEncryptionKey();
     const unsigned n = static_cast<unsigned>(objref.ObjectNumber());
     const unsigned g = static_cast<unsigned>(objref.GenerationNumber());
 
@@ -918,6 +1072,11 @@ void PdfEncryptMD5Base::CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLe
 
     ssl::ComputeMD5(bufferview((const char*)nkey, nkeylen), objkey);
     pnKeyLen = (keyLength <= 11) ? keyLength + 5 : 16;
+
+    std::memcpy(context.m_objKey, objkey, MD5_DIGEST_LENGTH);
+    context.m_objKeyRef = objref;
+    context.m_objKeyLength = pnKeyLen;
+    context.m_hasObjKey = true;
 }
 
 void RC4Encrypt(EVP_CIPHER_CTX* ctx, const unsigned char* key, unsigned keylen,
@@ -1087,7 +1246,7 @@ void PdfEncryptRC4::Encrypt(const char* inStr, size_t inLen, PdfEncryptContext&
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    CreateObjKey(objkey, keylen, context, objref);
     RC4Encrypt(context.GetCryptCtx(), objkey, keylen, (const unsigned char*)inStr, inLen,
         (unsigned char*)outStr, outLen);
 }
@@ -1104,7 +1263,7 @@ unique_ptr<InputStream> PdfEncryptRC4::CreateEncryptionInputStream(InputStream&
     (void)inputLen;
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    this->CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    this->CreateObjKey(objkey, keylen, context, objref);
     auto& rc4Ctx = context.GetCustomCtx<RC4EncryptContext>();
     return unique_ptr<InputStream>(new PdfRC4InputStream(inputStream, inputLen, rc4Ctx.Rc4key, rc4Ctx.Rc4last, objkey, keylen));
 }
@@ -1193,7 +1352,7 @@ unique_ptr<OutputStream> PdfEncryptRC4::CreateEncryptionOutputStream(OutputStrea
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    this->CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    this->CreateObjKey(objkey, keylen, context, objref);
     auto& rc4Ctx = context.GetCustomCtx<RC4EncryptContext>();
     return unique_ptr<OutputStream>(new PdfRC4OutputStream(outputStream, rc4Ctx.Rc4key, rc4Ctx.Rc4last, objkey, keylen));
 }
@@ -1328,7 +1487,7 @@ void PdfEncryptAESV2::Encrypt(const char* inStr, size_t inLen, PdfEncryptContext
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    CreateObjKey(objkey, keylen, context, objref);
     size_t offset = CalculateStreamOffset();
     generateInitialVector(context.GetDocumentId(), (unsigned char *)outStr);
     AESEncrypt(context.GetCryptCtx(), objkey, keylen, (unsigned char*)outStr, (const unsigned char*)inStr,
@@ -1340,7 +1499,7 @@ void PdfEncryptAESV2::Decrypt(const char* inStr, size_t inLen, PdfEncryptContext
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    CreateObjKey(objkey, keylen, context, objref);
 
     size_t offset = CalculateStreamOffset();
     if (inLen <= offset)
@@ -1391,22 +1550,19 @@ unique_ptr<InputStream> PdfEncryptAESV2::CreateEncryptionInputStream(InputStream
 {
     unsigned char objkey[MD5_DIGEST_LENGTH];
     unsigned keylen;
-    this->CreateObjKey(objkey, keylen, context.GetEncryptionKey(), objref);
+    this->CreateObjKey(objkey, keylen, context, objref);
     return unique_ptr<InputStream>(new PdfAESInputStream(inputStream, inputLen, objkey, keylen));
 }
 
 unique_ptr<OutputStream> PdfEncryptAESV2::CreateEncryptionOutputStream(OutputStream& outputStream,
     PdfEncryptContext& context, const PdfReference& objref) const
 {
-    (void)outputStream;
-    (void)context;
-    (void)objref;
-    // unsigned char objkey[MD5_DIGEST_LENGTH];
-    // int keylen;
-
-    // this->CreateObjKey( objkey, &keylen );
-
-    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "CreateEncryptionOutputStream does not yet support AESV2");
+    unsigned char objkey[MD5_DIGEST_LENGTH];
+    unsigned keylen;
+    this->CreateObjKey(objkey, keylen, context, objref);
+    unsigned char iv[AES_IV_LENGTH];
+    generateInitialVector(context.GetDocumentId(), iv);
+    return unique_ptr<OutputStream>(new PdfAESOutputStream(outputStream, objkey, keylen, iv));
 }
 
 void PdfEncryptAESV3::computeHash(const unsigned char* pswd, unsigned pswdLen, unsigned revision,
@@ -1463,8 +1619,9 @@ void PdfEncryptAESV3::computeHash(const unsigned char* pswd, unsigned pswdLen, u
                 std::memcpy(data + dataLen, uValue, 48);
                 dataLen += 48;
             }
-            for (unsigned j = 1; j < 64; j++)
-                std::memcpy(data + j * dataLen, data, dataLen);
+            // Repeat the sequence 64 times, doubling the copied data at every step
+            for (unsigned j = 1; j < 64; j *= 2)
+                std::memcpy(data + j * dataLen, data, j * dataLen);
 
             dataLen *= 64;
 
@@ -1473,7 +1630,9 @@ void PdfEncryptAESV3::computeHash(const unsigned char* pswd, unsigned pswdLen, u
             // I'm not 100% sure the conversion is correct, since we don't
             // finalize the context. It may be unnecessary because of some
             // preconditions, but these should be clearly stated
-            rc = EVP_EncryptInit_ex(aes.get(), ssl::Aes128(), nullptr, block, block + 16);
+            // NOTE: The cipher is set only once, the following rounds just
+            // replace the key and the IV without resetting the context
+            rc = EVP_EncryptInit_ex(aes.get(), i == 0 ? ssl::Aes128() : nullptr, nullptr, block, block + 16);
             rc = EVP_EncryptUpdate(aes.get(), data, &dataOutMoved, data, dataLen);
             PODOFO_ASSERT((unsigned)dataOutMoved == dataLen);
 
@@ -1927,10 +2086,10 @@ unique_ptr<InputStream> PdfEncryptAESV3::CreateEncryptionInputStream(InputStream
 unique_ptr<OutputStream> PdfEncryptAESV3::CreateEncryptionOutputStream(OutputStream& outputStream,
     PdfEncryptContext& context, const PdfReference& objref) const
 {
-    (void)outputStream;
-    (void)context;
     (void)objref;
-    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "CreateEncryptionOutputStream does not yet support AESV3");
+    unsigned char iv[AES_IV_LENGTH];
+    generateInitialVector(iv);
+    return unique_ptr<OutputStream>(new PdfAESOutputStream(outputStream, context.GetEncryptionKey(), GetKeyLengthBytes(), iv));
 }
 
 void PdfEncryptAESV3::generateInitialVector(unsigned char iv[])
@@ -8,6 +8,8 @@
 #include "PdfString.h"
 #include "PdfReference.h"
 
+#include <functional>
+
 // Define an opaque type for the internal PoDoFo encryption context
 #ifndef PODOFO_CRYPT_CTX
 #define PODOFO_CRYPT_CTX void
@@ -96,8 +98,14 @@ enum class PdfAuthResult : uint8_t
     Owner,      ///< Success authenticating the owner for this PDF
 };
 
+class PdfEncrypt;
 class PdfEncryptContext;
 
+/// A function authenticating an encrypted document, eg. trying several
+/// passwords. It returns true and fills the context if it succeeded
+using PdfAuthenticator = std::function<bool(const PdfEncrypt& encrypt,
+    const PdfString& documentId, PdfEncryptContext& context)>;
+
 /// A class that is used to encrypt a PDF file and
 /// set document permissions on the PDF file.
 ///
@@ -112,6 +120,7 @@ class PODOFO_API PdfEncrypt
     friend class PdfEncryptMD5Base;
     friend class PdfEncryptAESV3;
     PODOFO_PRIVATE_FRIEND(class PdfEncryptSession);
+    PODOFO_PRIVATE_FRIEND(class PdfStreamedObjectStream);
 
 public:
     virtual ~PdfEncrypt();
@@ -205,7 +214,10 @@ public:
     /// Create an OutputStream that encrypts all data written to
     /// it using the current settings of the PdfEncrypt object.
     ///
-    /// Warning: Currently only RC4 based encryption is supported using output streams!
+    /// AES based encryption streams write the initialization vector
+    /// first and the padded last block when the stream is disposed,
+    /// unless it's disposed because of an exception.
+    /// The length of the written data is given by CalculateStreamLength()
     ///
     /// @param outputStream the output stream to wrap with encryption
     /// @param context the encryption context
@@ -391,6 +403,10 @@ private:
 private:
     static std::unique_ptr<PdfEncrypt> CreateFromEncrypt(const PdfEncrypt& rhs);
 
+    /// Write the remaining data of a stream created with
+    /// CreateEncryptionOutputStream(), such as the AES padded last block
+    static void FinishEncryptionOutputStream(OutputStream& stream);
+
     void clearSensitiveInfo();
 
 private:
@@ -413,6 +429,8 @@ private:
 class PODOFO_API PdfEncryptContext final
 {
     friend class PdfEncrypt;
+    friend class PdfEncryptMD5Base;
+    friend class PdfStatefulEncrypt;
     friend class PdfEncryptRC4;
     friend class PdfEncryptAESV2;
     friend class PdfEncryptAESV3;
@@ -457,6 +475,12 @@ private:
     PODOFO_CRYPT_CTX* m_cryptCtx;
     void* m_customCtx;
     size_t m_customCtxSize;
+    // Cache of the last derived object key, as strings
+    // and streams of the same object are decrypted in sequence
+    bool m_hasObjKey;
+    PdfReference m_objKeyRef;
+    unsigned char m_objKey[16];
+    unsigned m_objKeyLength;
 };
 
 
@@ -498,12 +522,13 @@ protected:
         bool encryptMetadata, PODOFO_CRYPT_CTX* ctx,
         unsigned char userKey[32], unsigned char encryptionKey[32]);
 
-    /// Create the encryption key for the current object.
+    /// Create the encryption key for the current object, or
+    /// retrieve it if it was the last one created with the context
     ///
     /// @param objkey pointer to an array of at least MD5_HASHBYTES (=16) bytes length
     /// @param pnKeyLen pointer to an integer where the actual keylength is stored.
     void CreateObjKey(unsigned char objkey[16], unsigned& pnKeyLen,
-        const unsigned char m_encryptionKey[32], const PdfReference& objref) const;
+        PdfEncryptContext& context, const PdfReference& objref) const;
 };
 
 /// A class that is used to encrypt a PDF file (AES-128)
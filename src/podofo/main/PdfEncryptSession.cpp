@@ -12,6 +12,11 @@ PdfEncryptSession::PdfEncryptSession(const PdfEncrypt& encrypt, const PdfEncrypt
 {
 }
 
+PdfEncryptSession::PdfEncryptSession(const PdfEncryptSession& rhs)
+    : m_Encrypt(rhs.m_Encrypt), m_Context(rhs.m_Context)
+{
+}
+
 PdfEncryptSession::PdfEncryptSession(shared_ptr<PdfEncrypt>&& encrypt)
     : m_Encrypt(std::move(encrypt))
 {
@@ -4,6 +4,8 @@
 #ifndef PDF_ENCRYPT_SESSION
 #define PDF_ENCRYPT_SESSION
 
+#include <mutex>
+
 #include "PdfEncrypt.h"
 
 namespace PoDoFo {
@@ -12,6 +14,8 @@ namespace PoDoFo {
 class PODOFO_API PdfEncryptSession final
 {
     friend class PdfMemDocument;
+    friend class PdfIncrementalEditor;
+    friend class PdfString;
     PODOFO_PRIVATE_FRIEND(class PdfParser);
     PODOFO_PRIVATE_FRIEND(class PdfImmediateWriter);
 
@@ -19,10 +23,11 @@ private:
     /// A copy constructor that does deep copy of PdfEncrypt as well
     PdfEncryptSession(const PdfEncrypt& encrypt, const PdfEncryptContext& context);
     PdfEncryptSession(std::shared_ptr<PdfEncrypt>&& encrypt);
-    PdfEncryptSession(const PdfEncryptSession&) = default;
+    PdfEncryptSession(const PdfEncryptSession& rhs);
 
 public:
     PdfEncrypt& GetEncrypt() { return *m_Encrypt; }
+    const PdfEncrypt& GetEncrypt() const { return *m_Encrypt; }
     PdfEncryptContext& GetContext() { return m_Context; }
 
     bool HasOwnerPermissions() { return m_Context.GetAuthResult() == PdfAuthResult::Owner; }
@@ -33,6 +38,8 @@ private:
 private:
     std::shared_ptr<PdfEncrypt> m_Encrypt;
     PdfEncryptContext m_Context;
+    // Serializes the deferred decryption of strings
+    std::mutex m_Mutex;
 };
 
 }
@@ -8,8 +8,12 @@
 #include <utf8cpp/utf8.h>
 
 #include <podofo/private/PdfEncodingPrivate.h>
+#include <podofo/private/FreetypePrivate.h>
 #include <podofo/private/PdfStandard14FontData.h>
+#include <podofo/private/HarfBuzzShaping.h>
+#include <podofo/private/PdfFilterFactory.h>
 #include <podofo/private/outstringstream.h>
+#include <podofo/private/LruCache.h>
 
 #include "PdfArray.h"
 #include "PdfEncoding.h"
@@ -29,9 +33,62 @@ using namespace std;
 using namespace cmn;
 using namespace PoDoFo;
 
+// Maximum number of shaping results cached by a font
+constexpr unsigned MaxShapingCacheSize = 4096;
+
+// Code points with cached glyph widths are limited to the Unicode range
+constexpr char32_t WidthCacheCodePointLimit = 0x110000;
+
+namespace PoDoFo
+{
+    /// Dense cache of the widths of the glyphs mapped by code
+    /// points, stored in pages of 256 code points allocated on demand
+    struct PdfFontWidthCache final
+    {
+        struct Entry
+        {
+            double Width = 0;
+            bool Found = false;
+            bool Cached = false;
+        };
+
+        using Page = array<Entry, 256>;
+
+        vector<unique_ptr<Page>> Pages;
+    };
+
+    /// Shaping results, keyed by shaping params and string,
+    /// evicting the least recently used ones first
+    struct PdfFontShapingCache final
+    {
+        LruCache<shared_ptr<const PdfShapedText>> Entries{ MaxShapingCacheSize };
+    };
+
+    /// A font program prepared to be embedded, see PdfFont::PrepareEmbedFont()
+    struct PdfPreparedFontFile final
+    {
+        charbuff Subset;        ///< The built font program subset, if subsetting
+        charbuff Encoded;       ///< The font program data compressed with FlateDecode
+    };
+}
+
+namespace
+{
+    // Process-wide cache of prepared font programs, shared by all
+    // documents. The least recently used entries are evicted first
+    struct FontFileCache
+    {
+        mutex Mutex;
+        LruCache<shared_ptr<const PdfPreparedFontFile>> Files{ 0 };
+    };
+}
+
 static double getGlyphLength(double glyphLength, const PdfTextState& state, bool ignoreCharSpacing);
 static string_view toString(PdfFontStretch stretch);
 static double getGlyphMedianWidth(const PdfFontMetrics& metrics, unsigned maxGlyphCount);
+static FontFileCache& getFontFileCache();
+static shared_ptr<const PdfPreparedFontFile> getCachedFontFile(const string& key);
+static shared_ptr<const PdfPreparedFontFile> addCachedFontFile(const string& key, shared_ptr<const PdfPreparedFontFile>&& file);
 
 PdfFont::PdfFont(PdfDocument& doc, PdfFontType type, PdfFontMetricsConstPtr&& metrics,
         const PdfEncoding& encoding) :
@@ -168,12 +225,32 @@ void PdfFont::initBase(const PdfEncoding& encoding)
     }
 
     m_fontProgCIDToGIDMap = m_Encoding->GetCIDToGIDMap();
+    initLoadedWidths();
 
     // By default ensure the font has the /BaseFont name or /FontName
     // or, the name inferred from a font file
     m_Name = m_Metrics->GetFontName();
 }
 
+void PdfFont::initLoadedWidths()
+{
+    m_loadedWidthsOffset = 0;
+    if (!m_Encoding->IsObjectLoaded() || !m_Metrics->HasParsedWidths())
+        return;
+
+    if (m_Encoding->IsSimpleEncoding())
+    {
+        // Widths of simple fonts start from /FirstChar
+        auto& limits = m_Encoding->GetLimits();
+        if (limits.FirstChar.Code > limits.LastChar.Code)
+            return;
+
+        m_loadedWidthsOffset = limits.FirstChar.Code;
+    }
+
+    m_loadedWidths = m_Metrics->GetParsedWidths();
+}
+
 void PdfFont::WriteStringToStream(OutputStream& stream, const string_view& str) const
 {
     // Optimize serialization for simple encodings
@@ -217,7 +294,7 @@ void PdfFont::InitImported(bool wantEmbed, bool wantSubset, bool isProxy)
     unsigned char subsetPrefixLength = m_Metrics->GetSubsetPrefixLength();
     if (subsetPrefixLength == 0)
     {
-        if (m_SubsettingEnabled)
+        if (m_SubsettingEnabled && subsetsFontProgram())
         {
             m_SubsetPrefix = GetDocument().GetFonts().GenerateSubsetPrefix();
             m_Name = m_SubsetPrefix.append(m_Metrics->GetPostScriptNameRough());
@@ -247,6 +324,154 @@ void PdfFont::EmbedFont()
         embedFont();
 
     m_IsEmbedded = true;
+    m_preparedFontFile = nullptr;
+}
+
+void PdfFont::PrepareEmbedFont()
+{
+    if (m_IsEmbedded || !m_EmbeddingEnabled || m_preparedFontFile != nullptr)
+        return;
+
+    try
+    {
+        string cacheKey;
+        if (tryGetFontFileCacheKey(cacheKey))
+        {
+            m_preparedFontFile = getCachedFontFile(cacheKey);
+            if (m_preparedFontFile != nullptr)
+                return;
+        }
+
+        auto prepared = std::make_shared<PdfPreparedFontFile>();
+        bufferview data;
+        if (m_SubsettingEnabled)
+        {
+            if (!tryBuildFontFileSubset(prepared->Subset))
+                return;
+
+            data = prepared->Subset;
+        }
+        else
+        {
+            if (m_Type == PdfFontType::Type3)
+                return;
+
+            data = m_Metrics->GetOrLoadFontFileData();
+            if (data.empty())
+                return;
+        }
+
+        // NOTE: Use the same filter of PdfObjectStream::SetData()
+        PdfFilterFactory::Create(PdfFilterType::FlateDecode)->EncodeTo(prepared->Encoded, data);
+        if (cacheKey.empty())
+            m_preparedFontFile = std::move(prepared);
+        else
+            m_preparedFontFile = addCachedFontFile(cacheKey, std::move(prepared));
+    }
+    catch (...)
+    {
+        // Ignore failures: embedding will be performed
+        // entirely by EmbedFont(), which will report them
+    }
+}
+
+bool PdfFont::subsetsFontProgram() const
+{
+    return true;
+}
+
+void PdfFont::removeSubsetPrefix()
+{
+    // NOTE: Prefixes of fonts loaded from subsets are kept,
+    // as their font programs are subsets anyway
+    if (m_SubsetPrefix.empty() || m_Metrics->GetSubsetPrefixLength() != 0)
+        return;
+
+    m_Name.erase(0, m_SubsetPrefix.size());
+    m_SubsetPrefix.clear();
+}
+
+bool PdfFont::tryBuildFontFileSubset(charbuff& buffer) const
+{
+    // By default don't embed a font program subset
+    (void)buffer;
+    return false;
+}
+
+bool PdfFont::tryGetPreparedFontFile(bufferview& data) const
+{
+    if (m_preparedFontFile == nullptr)
+    {
+        data = { };
+        return false;
+    }
+
+    data = getPreparedFontFileData();
+    return true;
+}
+
+bufferview PdfFont::getPreparedFontFileData() const
+{
+    PODOFO_ASSERT(m_preparedFontFile != nullptr);
+    if (m_SubsettingEnabled)
+        return m_preparedFontFile->Subset;
+    else
+        return m_Metrics->GetOrLoadFontFileData();
+}
+
+bool PdfFont::tryGetFontFileCacheKey(string& key) const
+{
+    {
+        auto& cache = getFontFileCache();
+        unique_lock<mutex> lock(cache.Mutex);
+        if (cache.Files.GetMaxSize() == 0)
+            return false;
+    }
+
+    // NOTE: Font programs built from parsed widths, or with
+    // no data, are not fully identified by the font data
+    if (m_Type == PdfFontType::Type3 || m_Metrics->HasParsedWidths()
+        || !m_Metrics->HasFontFileData())
+    {
+        return false;
+    }
+
+    auto& digest = m_Metrics->getFontFileDigest();
+    key = utls::Format("{}/{}/{}/", (unsigned)m_Type, m_Metrics->GetFaceIndex(), m_SubsettingEnabled ? "S" : "F");
+    key.append(digest.data(), digest.size());
+    if (!m_SubsettingEnabled)
+        return true;
+
+    // Subsets are identified by the CID system
+    // info and the mapping of the glyphs
+    auto cidInfo = GetCIDSystemInfo();
+    key.append(utls::Format("/{}/{}/{}/{}/{}", cidInfo.Registry.GetString().size(), cidInfo.Registry.GetString(),
+        cidInfo.Ordering.GetString().size(), cidInfo.Ordering.GetString(), cidInfo.Supplement));
+    for (auto& info : GetCharGIDInfos())
+        key.append(utls::Format("/{},{},{},{}", info.Cid, info.OrigCid, info.Gid.Id, info.Gid.MetricsId));
+
+    return true;
+}
+
+void PdfFont::SetFontFileCacheSize(unsigned size)
+{
+    auto& cache = getFontFileCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    cache.Files.SetMaxSize(size);
+}
+
+unsigned PdfFont::GetFontFileCacheSize()
+{
+    auto& cache = getFontFileCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    return cache.Files.GetMaxSize();
+}
+
+void PdfFont::ClearFontFileCache()
+{
+    auto& cache = getFontFileCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    cache.Files.Clear();
 }
 
 void PdfFont::embedFont()
@@ -299,15 +524,186 @@ double PdfFont::GetStringLength(const string_view& str, const PdfTextState& stat
 
 bool PdfFont::TryGetStringLength(const string_view& str, const PdfTextState& state, double& length) const
 {
-    vector<unsigned> gids;
-    bool success = tryConvertToGIDs(str, PdfGlyphAccess::ReadMetrics, gids);
+    unique_lock<mutex> lock(m_widthCacheMutex);
+    return tryGetStringLength(str, state, length);
+}
+
+vector<double> PdfFont::MeasureStrings(const cspan<string_view>& strs, const PdfTextState& state) const
+{
+    // Ignore failures
+    vector<double> lengths;
+    (void)TryMeasureStrings(strs, state, lengths);
+    return lengths;
+}
+
+bool PdfFont::TryMeasureStrings(const cspan<string_view>& strs, const PdfTextState& state, vector<double>& lengths) const
+{
+    lengths.resize(strs.size());
+    bool success = true;
+    unique_lock<mutex> lock(m_widthCacheMutex);
+    for (size_t i = 0; i < strs.size(); i++)
+    {
+        if (!tryGetStringLength(strs[i], state, lengths[i]))
+            success = false;
+    }
+
+    return success;
+}
+
+bool PdfFont::tryGetStringLength(const string_view& str, const PdfTextState& state, double& length) const
+{
+    // NOTE: Glyph substitution (see PdfFontMetrics::SubstituteGIDs())
+    // is not implemented by any metrics, so the length is the sum of
+    // the widths of the glyphs mapped by single code points
+    bool success = true;
+    double width;
     length = 0;
-    for (unsigned i = 0; i < gids.size(); i++)
-        length += getGlyphLength(m_Metrics->GetGlyphWidth(gids[i]), state, false);
+    auto it = str.begin();
+    auto end = str.end();
+    while (it != end)
+    {
+        char32_t cp = utf8::next(it, end);
+        if (!tryGetCodePointWidth(cp, width))
+            success = false;
+
+        length += getGlyphLength(width, state, false);
+    }
 
     return success;
 }
 
+bool PdfFont::tryGetCodePointWidth(char32_t codePoint, double& width) const
+{
+    // NOTE: Without a unicode mapping in the metrics, the glyphs
+    // are looked up in the encoding, and a dynamic encoding grows
+    // while drawing text, so the lookups can't be cached
+    unsigned gid;
+    if (codePoint >= WidthCacheCodePointLimit
+        || (m_Encoding->IsDynamicEncoding() && !m_Metrics->HasUnicodeMapping()))
+    {
+        bool found = tryConvertToGID(codePoint, PdfGlyphAccess::ReadMetrics, gid);
+        width = m_Metrics->GetGlyphWidth(gid);
+        return found;
+    }
+
+    if (m_widthCache == nullptr)
+        m_widthCache.reset(new PdfFontWidthCache());
+
+    auto& cache = *m_widthCache;
+    unsigned pageIndex = (unsigned)codePoint >> 8;
+    if (pageIndex >= cache.Pages.size())
+        cache.Pages.resize(pageIndex + 1);
+
+    auto& page = cache.Pages[pageIndex];
+    if (page == nullptr)
+        page.reset(new PdfFontWidthCache::Page());
+
+    auto& entry = (*page)[codePoint & 0xFF];
+    if (!entry.Cached)
+    {
+        entry.Found = tryConvertToGID(codePoint, PdfGlyphAccess::ReadMetrics, gid);
+        entry.Width = m_Metrics->GetGlyphWidth(gid);
+        entry.Cached = true;
+    }
+
+    width = entry.Width;
+    return entry.Found;
+}
+
+shared_ptr<const PdfShapedText> PdfFont::ShapeString(const string_view& str, const PdfTextShapingParams& params) const
+{
+#ifdef PODOFO_HAVE_HARFBUZZ
+    // NOTE: Glyphs other than the first of a cluster are mapped
+    // to no code points, which is supported only by subsetting
+    // with a dynamic encoding
+    if (!m_SubsettingEnabled || m_IsProxy || m_IsEmbedded || !m_Encoding->IsDynamicEncoding()
+        || m_Encoding->IsObjectLoaded() || !m_Metrics->HasUnicodeMapping())
+    {
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented,
+            "Text shaping is supported only on subsetted fonts with dynamic encoding");
+    }
+
+    // NOTE: Shaping updates the subset and the dynamic encoding
+    unique_lock<recursive_mutex> lock(m_drawMutex);
+    string key;
+    key.append(params.Features).push_back('\0');
+    key.append(params.Language).push_back('\0');
+    key.append(params.Script).push_back('\0');
+    key.append(str);
+    if (m_shapingCache == nullptr)
+    {
+        m_shapingCache.reset(new PdfFontShapingCache());
+    }
+    else
+    {
+        auto found = m_shapingCache->Entries.Find(key);
+        if (found != nullptr)
+            return *found;
+    }
+
+    auto face = m_Metrics->GetFaceHandle();
+    if (face == nullptr || face->units_per_EM == 0)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "The font has no font program to shape text");
+
+    vector<HarfBuzzGlyph> glyphs;
+    {
+        // NOTE: The face may be shared between threads
+        unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
+        ShapeTextHarfBuzz(face, str, params, glyphs);
+    }
+
+    // Clusters are offsets in the string of the characters
+    // the glyphs belong to. Code points of a cluster are
+    // mapped only by the first glyph found in the cluster
+    vector<unsigned> clusters;
+    for (auto& glyph : glyphs)
+        clusters.push_back(glyph.Cluster);
+
+    std::sort(clusters.begin(), clusters.end());
+    clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+    vector<bool> mappedClusters(clusters.size());
+
+    auto shaped = std::make_shared<PdfShapedText>();
+    shaped->Glyphs.resize(glyphs.size());
+    double scale = 1000.0 / face->units_per_EM;
+    vector<char32_t> codePoints;
+    for (unsigned i = 0; i < glyphs.size(); i++)
+    {
+        auto& glyph = glyphs[i];
+        if (glyph.GID == 0)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "The provided string can't be converted to CID encoding");
+
+        codePoints.clear();
+        unsigned clusterIndex = (unsigned)(std::lower_bound(clusters.begin(), clusters.end(), glyph.Cluster) - clusters.begin());
+        if (!mappedClusters[clusterIndex])
+        {
+            mappedClusters[clusterIndex] = true;
+            auto it = str.begin() + glyph.Cluster;
+            auto end = clusterIndex + 1 == clusters.size() ? str.end() : str.begin() + clusters[clusterIndex + 1];
+            while (it != end)
+                codePoints.push_back(utf8::next(it, end));
+        }
+
+        auto& shapedGlyph = shaped->Glyphs[i];
+        if (!m_Encoding->tryGetCharCode(glyph.GID, unicodeview(codePoints.data(), codePoints.size()), shapedGlyph.Code))
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "The provided string can't be converted to CID encoding");
+
+        shapedGlyph.GID = glyph.GID;
+        shapedGlyph.Cluster = glyph.Cluster;
+        shapedGlyph.Advance = glyph.XAdvance * scale;
+        shapedGlyph.OffsetX = glyph.XOffset * scale;
+        shapedGlyph.OffsetY = glyph.YOffset * scale;
+    }
+
+    m_shapingCache->Entries.Add(key, shaped);
+    return shaped;
+#else // PODOFO_HAVE_HARFBUZZ
+    (void)str;
+    (void)params;
+    PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Text shaping requires PoDoFo to be built with HarfBuzz");
+#endif // PODOFO_HAVE_HARFBUZZ
+}
+
 double PdfFont::GetEncodedStringLength(const PdfString& encodedStr, const PdfTextState& state) const
 {
     // Ignore failures
@@ -398,10 +794,11 @@ bool PdfFont::TryGetCharLength(char32_t codePoint, const PdfTextState& state, do
 bool PdfFont::TryGetCharLength(char32_t codePoint, const PdfTextState& state,
     bool ignoreCharSpacing, double& length) const
 {
-    unsigned gid;
-    if (TryGetGID(codePoint, PdfGlyphAccess::ReadMetrics, gid))
+    double width;
+    unique_lock<mutex> lock(m_widthCacheMutex);
+    if (tryGetCodePointWidth(codePoint, width))
     {
-        length = getGlyphLength(m_Metrics->GetGlyphWidth(gid), state, ignoreCharSpacing);
+        length = getGlyphLength(width, state, ignoreCharSpacing);
         return true;
     }
     else
@@ -437,6 +834,19 @@ vector<PdfSplittedString> PdfFont::SplitEncodedString(const PdfString& str) cons
 
 double PdfFont::GetCIDWidth(unsigned cid) const
 {
+    if (m_loadedWidths != nullptr)
+    {
+        // Fast path for loaded fonts: the width is looked up
+        // directly in the parsed widths, as mapped by
+        // tryMapCIDToGIDLoadedMetrics(). NOTE: CIDs lower
+        // than the offset wrap around and are out of range
+        unsigned index = cid - m_loadedWidthsOffset;
+        if (index < m_loadedWidths->size())
+            return (*m_loadedWidths)[index];
+
+        return m_Metrics->GetDefaultWidth();
+    }
+
     unsigned gid;
     if (!tryMapCIDToGID(cid, PdfGlyphAccess::ReadMetrics, gid))
         return m_Metrics->GetDefaultWidth();
@@ -614,7 +1024,17 @@ void PdfFont::embedFontFileData(PdfDictionary& descriptor, const PdfName& fontFi
     // NOTE: Access to directory is mediated by functor to not crash
     // operations when using PdfStreamedDocument. Do not remove it
     dictWriter(contents.GetDictionary());
-    contents.GetOrCreateStream().SetData(data);
+    bufferview preparedData;
+    if (tryGetPreparedFontFile(preparedData) && data.data() == preparedData.data()
+        && data.size() == preparedData.size())
+    {
+        // The data was already compressed by PrepareEmbedFont()
+        contents.GetOrCreateStream().SetData(m_preparedFontFile->Encoded, { PdfFilterType::FlateDecode }, true);
+    }
+    else
+    {
+        contents.GetOrCreateStream().SetData(data);
+    }
 }
 
 void PdfFont::initSpacingDescriptors()
@@ -680,6 +1100,15 @@ double PdfFont::getStringLength(const vector<PdfCID>& cids, const PdfTextState&
     return length;
 }
 
+double PdfFont::getShapedTextLength(const PdfShapedText& shaped, const PdfTextState& state) const
+{
+    double length = 0;
+    for (auto& glyph : shaped.Glyphs)
+        length += getGlyphLength(glyph.Advance / 1000, state, false);
+
+    return length;
+}
+
 double PdfFont::GetLineSpacing(const PdfTextState& state) const
 {
     return m_Metrics->GetLineSpacing() * state.FontSize;
@@ -769,76 +1198,53 @@ unique_ptr<set<PdfCharCode>> PdfFont::GetCharCodeSubset() const
     return ret;
 }
 
-bool PdfFont::tryConvertToGIDs(const std::string_view& utf8Str, PdfGlyphAccess access, std::vector<unsigned>& gids) const
+bool PdfFont::tryConvertToGID(char32_t codePoint, PdfGlyphAccess access, unsigned& gid) const
 {
-    bool success = true;
     if (m_Encoding->IsObjectLoaded() || !m_Metrics->HasUnicodeMapping())
     {
         // NOTE: This is a best effort strategy. It's not intended to
         // be accurate in loaded fonts
-        auto it = utf8Str.begin();
-        auto end = utf8Str.end();
-
         auto& toUnicode = m_Encoding->GetToUnicodeMapSafe();
-        while (it != end)
+        PdfCharCode codeUnit;
+        unsigned cid;
+        if (toUnicode.TryGetCharCode(codePoint, codeUnit))
         {
-            char32_t cp = utf8::next(it, end);
-            PdfCharCode codeUnit;
-            unsigned cid;
-            unsigned gid;
-            if (toUnicode.TryGetCharCode(cp, codeUnit))
+            if (m_Encoding->TryGetCIDId(codeUnit, cid))
             {
-                if (m_Encoding->TryGetCIDId(codeUnit, cid))
-                {
-                    if (!tryMapCIDToGID(cid, access, gid))
-                    {
-                        // Fallback
-                        gid = cid;
-                        success = false;
-                    }
-                }
-                else
+                if (!tryMapCIDToGID(cid, access, gid))
                 {
                     // Fallback
-                    gid = codeUnit.Code;
-                    success = false;
+                    gid = cid;
+                    return false;
                 }
             }
             else
             {
                 // Fallback
-                gid = cp;
-                success = false;
+                gid = codeUnit.Code;
+                return false;
             }
-
-            gids.push_back(gid);
         }
+        else
+        {
+            // Fallback
+            gid = codePoint;
+            return false;
+        }
+
+        return true;
     }
     else
     {
-        auto it = utf8Str.begin();
-        auto end = utf8Str.end();
-        while (it != end)
+        if (!m_Metrics->TryGetGID(codePoint, gid))
         {
-            char32_t cp = utf8::next(it, end);
-            unsigned gid;
-            if (!m_Metrics->TryGetGID(cp, gid))
-            {
-                // Fallback
-                gid = cp;
-                success = false;
-            }
-
-            gids.push_back(gid);
+            // Fallback
+            gid = codePoint;
+            return false;
         }
 
-        // Try to subsistute GIDs for fonts that support
-        // a glyph substitution mechanism
-        vector<unsigned char> backwardMap;
-        m_Metrics->SubstituteGIDs(gids, backwardMap);
+        return true;
     }
-
-    return success;
 }
 
 bool PdfFont::tryAddSubsetGID(unsigned gid, const unicodeview& codePoints, PdfCID& cid)
@@ -864,9 +1270,17 @@ bool PdfFont::tryAddSubsetGID(unsigned gid, const unicodeview& codePoints, PdfCI
             return false;
         }
 
-        // We start numberings CIDs from 1 since CID 0
-        // is reserved for fallbacks
-        cid = PdfCID((unsigned)m_SubsetCIDMap->size() + 1, codeUnit);
+        if (IsCIDFont())
+        {
+            // We start numberings CIDs from 1 since CID 0
+            // is reserved for fallbacks
+            cid = PdfCID((unsigned)m_SubsetCIDMap->size() + 1, codeUnit);
+        }
+        else
+        {
+            // NOTE: In non CID-keyed fonts char codes are equivalent to CID
+            cid = PdfCID(codeUnit.Code, codeUnit);
+        }
     }
 
     pushSubsetInfo(cid.Id, PdfGID(gid), cid.Unit);
@@ -985,6 +1399,12 @@ bool PdfFont::tryMapCIDToGID(unsigned cid, PdfGlyphAccess access, unsigned& gid)
 
 bool PdfFont::tryMapCIDToGIDLoadedMetrics(unsigned cid, unsigned& gid) const
 {
+    if (m_loadedWidths != nullptr)
+    {
+        gid = cid - m_loadedWidthsOffset;
+        return true;
+    }
+
     if (!m_Encoding->IsObjectLoaded() || !m_Metrics->HasParsedWidths())
         return false;
 
@@ -1249,3 +1669,25 @@ double getGlyphMedianWidth(const PdfFontMetrics& metrics, unsigned maxGlyphCount
     std::nth_element(glyphWidths.begin(), glyphWidths.begin() + n, glyphWidths.end());
     return glyphWidths[n];
 }
+
+FontFileCache& getFontFileCache()
+{
+    static FontFileCache s_cache;
+    return s_cache;
+}
+
+shared_ptr<const PdfPreparedFontFile> getCachedFontFile(const string& key)
+{
+    auto& cache = getFontFileCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    auto found = cache.Files.Find(key);
+    return found == nullptr ? nullptr : *found;
+}
+
+shared_ptr<const PdfPreparedFontFile> addCachedFontFile(const string& key, shared_ptr<const PdfPreparedFontFile>&& file)
+{
+    auto& cache = getFontFileCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    auto cached = cache.Files.Add(key, shared_ptr<const PdfPreparedFontFile>(file));
+    return cached == nullptr ? std::move(file) : *cached;
+}
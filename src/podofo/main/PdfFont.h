@@ -7,6 +7,8 @@
 
 #include "PdfDeclarations.h"
 
+#include <mutex>
+
 #include "PdfTextState.h"
 #include "PdfName.h"
 #include "PdfEncoding.h"
@@ -16,6 +18,9 @@
 namespace PoDoFo {
 
 class PdfCharCodeMap;
+struct PdfFontWidthCache;
+struct PdfFontShapingCache;
+struct PdfPreparedFontFile;
 
 struct PODOFO_API PdfFontCreateParams final
 {
@@ -29,6 +34,23 @@ struct PODOFO_API PdfSplittedString final
     bool IsSeparator = false;
 };
 
+/// A glyph positioned by text shaping
+struct PODOFO_API PdfShapedGlyph final
+{
+    unsigned GID = 0;
+    PdfCharCode Code;       ///< The code unit of the glyph in the font encoding
+    unsigned Cluster = 0;   ///< Offset in the source utf8 string of the characters the glyph belongs to
+    double Advance = 0;     ///< Horizontal advance, in thousandths of text space unit
+    double OffsetX = 0;     ///< Horizontal displacement from the pen position, in thousandths of text space unit
+    double OffsetY = 0;     ///< Vertical displacement from the baseline, in thousandths of text space unit
+};
+
+/// The result of shaping a string, with glyphs in visual order
+struct PODOFO_API PdfShapedText final
+{
+    std::vector<PdfShapedGlyph> Glyphs;
+};
+
 /// Before you can draw text on a PDF document, you have to create
 /// a font object first. You can reuse this font object as often
 /// as you want.
@@ -48,6 +70,7 @@ class PODOFO_API PdfFont : public PdfDictionaryElement
     friend class PdfEncodingMapBase;
     friend class PdfEncodingMapSimple;
     friend class PdfFontBuiltinType1Encoding;
+    friend class PdfPainter;
 
 private:
     /// Create a new PdfFont object which will introduce itself
@@ -142,6 +165,33 @@ public:
     /// @remarks Produces a partial result also in case of failures
     bool TryGetStringLength(const std::string_view& str, const PdfTextState& state, double& width) const;
 
+    /// Retrieve the widths of many text strings in PDF units when
+    /// drawn with the current font, measuring them in a single batch
+    /// @param strs utf8 strings of which the widths should be calculated
+    /// @param state current text state
+    /// @returns the widths in PDF units, in the same order of the strings
+    /// @remarks Doesn't throw if string glyphs could not be partially or totally found
+    std::vector<double> MeasureStrings(const cspan<std::string_view>& strs, const PdfTextState& state) const;
+
+    /// @param strs utf8 strings of which the widths should be calculated
+    /// @param state current text state
+    /// @param lengths output widths
+    /// @remarks Produces a partial result also in case of failures
+    bool TryMeasureStrings(const cspan<std::string_view>& strs, const PdfTextState& state, std::vector<double>& lengths) const;
+
+    /// Shape a string with HarfBuzz, converting it to glyphs positioned
+    /// by the OpenType layout tables of the font, which supply ligatures,
+    /// kerning, contextual forms and mark placement. The used glyphs are
+    /// added to the font subset
+    /// @param str a utf8 string to shape
+    /// @param params features, language and script used for shaping
+    /// @remarks The result is cached by string and params. Shaping
+    /// requires a subsetted font with dynamic encoding, created from a
+    /// font program, and PoDoFo built with HarfBuzz support, otherwise
+    /// it throws PdfErrorCode::NotImplemented. It can be called
+    /// concurrently with text drawing on detached canvases
+    std::shared_ptr<const PdfShapedText> ShapeString(const std::string_view& str, const PdfTextShapingParams& params) const;
+
     /// Retrieve the width of a given encoded PdfString in PDF units when
     /// drawn with the current font
     /// @param encodedStr a text string of which the width should be calculated
@@ -358,6 +408,22 @@ protected:
 
     virtual void embedFontSubset();
 
+    /// Build the subset of the font program to embed. It must
+    /// not access the document, since it may be run concurrently
+    /// @returns false if the font doesn't embed a font program subset
+    virtual bool tryBuildFontFileSubset(charbuff& buffer) const;
+
+    /// Determines if the font program is subsetted when subsetting is
+    /// enabled. Only then the font name is tagged as a subset
+    virtual bool subsetsFontProgram() const;
+
+    /// Remove the generated subset tag from the font name, for
+    /// a subsetting font that ends up embedding the full program
+    void removeSubsetPrefix();
+
+    /// Get the font program data prepared by PrepareEmbedFont(), if any
+    bool tryGetPreparedFontFile(bufferview& data) const;
+
 private:
     PdfFont(const PdfFont& rhs) = delete;
 
@@ -365,6 +431,20 @@ private:
     /// Embeds pending font into PDF page
     void EmbedFont();
 
+    /// Build the font program to embed and compress it, without
+    /// accessing the document, so it can be run concurrently on
+    /// different fonts before EmbedFont(). See PdfFontManager::EmbedFonts()
+    /// @remarks Failures are ignored, and reported by EmbedFont()
+    void PrepareEmbedFont();
+
+    /// Set the maximum number of entries of the process-wide cache of
+    /// prepared font programs, see PdfFontManager::SetFontFileCacheSize()
+    static void SetFontFileCacheSize(unsigned size);
+
+    static unsigned GetFontFileCacheSize();
+
+    static void ClearFontFileCache();
+
     /// Perform initialization tasks for fonts imported or created
     /// from scratch
     void InitImported(bool wantEmbed, bool wantSubset, bool isProxy);
@@ -389,7 +469,7 @@ private:
     std::unique_ptr<std::set<PdfCharCode>> GetCharCodeSubset() const;
 
 private:
-    bool tryConvertToGIDs(const std::string_view& utf8Str, PdfGlyphAccess access, std::vector<unsigned>& gids) const;
+    bool tryConvertToGID(char32_t codePoint, PdfGlyphAccess access, unsigned& gid) const;
     bool tryAddSubsetGID(unsigned gid, const unicodeview& codePoints, PdfCID& cid);
 
     /// Map a CID to a GID
@@ -402,8 +482,27 @@ private:
 
     void initBase(const PdfEncoding& encoding);
 
+    /// Precompute the lookup of widths of fonts loaded
+    /// with /Widths or /W arrays, see GetCIDWidth()
+    void initLoadedWidths();
+
     double getStringLength(const std::vector<PdfCID>& cids, const PdfTextState& state) const;
 
+    /// Requires m_widthCacheMutex to be held
+    bool tryGetStringLength(const std::string_view& str, const PdfTextState& state, double& length) const;
+
+    /// Get the unscaled width of the glyph mapped by the code point,
+    /// or of a fallback glyph, using the per code point width cache.
+    /// Requires m_widthCacheMutex to be held
+    bool tryGetCodePointWidth(char32_t codePoint, double& width) const;
+
+    /// Get the key of the font program to embed in the font file cache
+    bool tryGetFontFileCacheKey(std::string& key) const;
+
+    bufferview getPreparedFontFileData() const;
+
+    double getShapedTextLength(const PdfShapedText& shaped, const PdfTextState& state) const;
+
     void embedFontFileData(PdfDictionary& descriptor, const PdfName& fontFileName,
         const std::function<void(PdfDictionary& dict)>& dictWriter, const bufferview& data) const;
 
@@ -438,8 +537,24 @@ private:
     std::unique_ptr<CIDSubsetMap> m_SubsetCIDMap;
     std::unique_ptr<std::unordered_map<unsigned, unsigned>> m_subsetGIDToCIDMap;
     const PdfCIDToGIDMap* m_fontProgCIDToGIDMap;
+    // Parsed widths of loaded fonts, indexed by CID minus the offset
+    GlyphMetricsListConstPtr m_loadedWidths;
+    unsigned m_loadedWidthsOffset;
     double m_WordSpacingLengthRaw;
     double m_SpaceCharLengthRaw;
+    // Serializes the updates of the subset, the dynamic encoding and
+    // the shaping cache, performed by text shaping and by painters
+    // drawing concurrently on separate detached canvases, see
+    // PdfDetachedCanvas. It's recursive since painters shape text
+    // while holding it
+    mutable std::recursive_mutex m_drawMutex;
+    std::shared_ptr<const PdfPreparedFontFile> m_preparedFontFile;
+    mutable std::mutex m_widthCacheMutex;
+    // Widths of glyphs mapped by code points, allocated on first
+    // use, see tryGetCodePointWidth(). Guarded by m_widthCacheMutex
+    mutable std::unique_ptr<PdfFontWidthCache> m_widthCache;
+    // Shaping results, keyed by shaping params and string. Guarded by m_drawMutex
+    mutable std::unique_ptr<PdfFontShapingCache> m_shapingCache;
 
 protected:
     PdfFontMetricsConstPtr m_Metrics;
@@ -117,6 +117,7 @@ PdfEncodingMapConstPtr PdfFontMetrics::getFontType1BuiltInEncoding(FT_Face face)
             codeMap.PushMapping(PdfCharCode(code, 1), codepoints);
         }
 
+        codeMap.Freeze();
         return PdfEncodingMapConstPtr(new PdfFontBuiltinType1Encoding(std::move(codeMap)));
     }
 
@@ -112,7 +112,17 @@ void PdfFontCID::embedFontSubset()
     auto cidInfo = GetCIDSystemInfo();
     m_Encoding->ExportToFont(*this, cidInfo);
 
-    embedFontFileSubset(subsetInfos, cidInfo);
+    // NOTE: The subset may have been already built concurrently
+    // by PrepareEmbedFont(), see PdfFontManager::EmbedFonts()
+    charbuff buffer;
+    bufferview data;
+    if (!tryGetPreparedFontFile(data))
+    {
+        buildFontFileSubset(subsetInfos, cidInfo, buffer);
+        data = buffer;
+    }
+
+    embedFontFileSubset(data);
 
     auto pdfaLevel = GetDocument().GetMetadata().GetPdfALevel();
     if (pdfaLevel == PdfALevel::L1A || pdfaLevel == PdfALevel::L1B)
@@ -148,6 +158,12 @@ void PdfFontCID::embedFontSubset()
     }
 }
 
+bool PdfFontCID::tryBuildFontFileSubset(charbuff& buffer) const
+{
+    buildFontFileSubset(GetCharGIDInfos(), GetCIDSystemInfo(), buffer);
+    return true;
+}
+
 PdfObject* PdfFontCID::getDescendantFontObject()
 {
     return m_DescendantFont;
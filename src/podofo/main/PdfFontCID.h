@@ -30,8 +30,10 @@ protected:
     void createWidths(PdfDictionary& fontDict, const cspan<PdfCharGIDInfo>& infos);
 
 protected:
-    virtual void embedFontFileSubset(const std::vector<PdfCharGIDInfo>& subsetInfos,
-        const PdfCIDSystemInfo& cidInfo) = 0;
+    bool tryBuildFontFileSubset(charbuff& buffer) const override;
+    virtual void buildFontFileSubset(const std::vector<PdfCharGIDInfo>& subsetInfos,
+        const PdfCIDSystemInfo& cidInfo, charbuff& buffer) const = 0;
+    virtual void embedFontFileSubset(const bufferview& data) = 0;
     void initImported() override;
 
 protected:
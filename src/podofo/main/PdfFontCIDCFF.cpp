@@ -23,16 +23,20 @@ bool PdfFontCIDCFF::SupportsSubsetting() const
 #endif // PODOFO_ENABLE_AFDKO
 }
 
-void PdfFontCIDCFF::embedFontFileSubset(const vector<PdfCharGIDInfo>& infos,
-    const PdfCIDSystemInfo& cidInfo)
+void PdfFontCIDCFF::buildFontFileSubset(const vector<PdfCharGIDInfo>& infos,
+    const PdfCIDSystemInfo& cidInfo, charbuff& buffer) const
 {
 #ifdef PODOFO_ENABLE_AFDKO
-    charbuff buffer;
     afdko::SubsetFontCFF(GetMetrics(), infos, cidInfo, buffer);
-    EmbedFontFileCFF(GetDescriptor().GetDictionary(), buffer, true);
 #else
     (void)infos;
     (void)cidInfo;
+    (void)buffer;
     PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "AFDKO support is disabled. Enable PODOFO_ENABLE_AFDKO in CMake to enable it");
 #endif
 }
+
+void PdfFontCIDCFF::embedFontFileSubset(const bufferview& data)
+{
+    EmbedFontFileCFF(GetDescriptor().GetDictionary(), data, true);
+}
@@ -28,8 +28,9 @@ public:
     bool SupportsSubsetting() const override;
 
 protected:
-    void embedFontFileSubset(const std::vector<PdfCharGIDInfo>& infos,
-        const PdfCIDSystemInfo& cidInfo) override;
+    void buildFontFileSubset(const std::vector<PdfCharGIDInfo>& infos,
+        const PdfCIDSystemInfo& cidInfo, charbuff& buffer) const override;
+    void embedFontFileSubset(const bufferview& data) override;
 };
 
 };
@@ -18,11 +18,14 @@ PdfFontCIDTrueType::PdfFontCIDTrueType(PdfDocument& doc, PdfFontMetricsConstPtr&
         const PdfEncoding& encoding)
     : PdfFontCID(doc, PdfFontType::CIDTrueType, std::move(metrics), encoding) { }
 
-void PdfFontCIDTrueType::embedFontFileSubset(const vector<PdfCharGIDInfo>& infos,
-    const PdfCIDSystemInfo& cidInfo)
+void PdfFontCIDTrueType::buildFontFileSubset(const vector<PdfCharGIDInfo>& infos,
+    const PdfCIDSystemInfo& cidInfo, charbuff& buffer) const
 {
     (void)cidInfo;
-    charbuff buffer;
     FontTrueTypeSubset::BuildFont(GetMetrics(), infos, buffer);
-    EmbedFontFileTrueType(GetDescriptor().GetDictionary(), buffer);
+}
+
+void PdfFontCIDTrueType::embedFontFileSubset(const bufferview& data)
+{
+    EmbedFontFileTrueType(GetDescriptor().GetDictionary(), data);
 }
@@ -26,8 +26,9 @@ private:
         const PdfEncoding& encoding);
 
 protected:
-    void embedFontFileSubset(const std::vector<PdfCharGIDInfo>& infos,
-        const PdfCIDSystemInfo& cidInfo) override;
+    void buildFontFileSubset(const std::vector<PdfCharGIDInfo>& infos,
+        const PdfCIDSystemInfo& cidInfo, charbuff& buffer) const override;
+    void embedFontFileSubset(const bufferview& data) override;
 };
 
 };
@@ -7,6 +7,9 @@
 
 #include <algorithm>
 #include <podofo/private/FileSystem.h>
+#include <podofo/private/OpenSSLInternal.h>
+#include <podofo/private/WorkerPool.h>
+#include <podofo/private/LruCache.h>
 
 #if defined(_WIN32) && defined(PODOFO_HAVE_WIN32GDI)
 #include <podofo/private/WindowsLeanMean.h>
@@ -35,10 +38,32 @@ namespace
         string Pattern;
         PdfFontSearchParams Params;
     };
+
+    // Process-wide cache of font metrics, shared by all documents.
+    // The least recently used entries are evicted first
+    struct MetricsCache
+    {
+        struct Entry
+        {
+            PdfFontMetricsConstPtr Metrics;
+            // Font file write time and size, for entries keyed by path
+            fs::file_time_type LastWriteTime;
+            uintmax_t Size = 0;
+        };
+
+        mutex Mutex;
+        // Metrics by face index and SHA-256 digest of the font data ("d" prefix),
+        // by face index and font file path ("f" prefix) and by search query ("q" prefix)
+        LruCache<Entry> Entries{ 256 };
+    };
 }
 
 static bool tryAdaptSearchParams(const std::string_view& patternName, const PdfFontSearchParams& params,
     unique_ptr<AdaptedFontSearch>& adaptedParams);
+static MetricsCache& getMetricsCache();
+static void clearCachedQueries(MetricsCache& cache);
+static string getQueryKey(const string_view& fontName, const PdfFontSearchParams& params);
+static void initLazyMetrics(const PdfFontMetrics& metrics);
 
 #if defined(_WIN32) && defined(PODOFO_HAVE_WIN32GDI)
 
@@ -219,7 +244,7 @@ PdfFont& PdfFontManager::GetOrCreateFont(const string_view& fontPath, unsigned f
     if (found != m_cachedPaths.end())
         return *found->second;
 
-    auto metrics = PdfFontMetrics::Create(fontPath, faceIndex);
+    auto metrics = getOrCreateCachedMetrics(normalizedPath, faceIndex);
     if (metrics == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "Invalid or unsupported font");
 
@@ -249,7 +274,123 @@ PdfFont* PdfFontManager::GetCachedFont(const PdfReference& ref)
 
 PdfFont& PdfFontManager::GetOrCreateFontFromBuffer(const bufferview& buffer, unsigned faceIndex, const PdfFontCreateParams& params)
 {
-    return getOrCreateFontHashed(PdfFontMetrics::CreateFromBuffer(buffer, faceIndex), params);
+    auto metrics = getOrCreateCachedMetricsFromBuffer(buffer, faceIndex);
+    if (metrics == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "Invalid or unsupported font");
+
+    return getOrCreateFontHashed(std::move(metrics), params);
+}
+
+PdfFontMetricsConstPtr PdfFontManager::getOrCreateCachedMetrics(const string_view& filepath, unsigned faceIndex)
+{
+    // Font files are assumed to be unchanged as
+    // long as their time and size are the same
+    auto path = fs::u8path(filepath);
+    error_code ec;
+    auto lastWriteTime = fs::last_write_time(path, ec);
+    uintmax_t size = 0;
+    if (!ec)
+        size = fs::file_size(path, ec);
+
+    if (ec)
+        return PdfFontMetrics::CreateFromFile(filepath, faceIndex, nullptr, false);
+
+    auto& cache = getMetricsCache();
+    auto key = utls::Format("f{}/{}", faceIndex, filepath);
+    {
+        unique_lock<mutex> lock(cache.Mutex);
+        auto found = cache.Entries.Find(key);
+        if (found != nullptr
+            && found->LastWriteTime == lastWriteTime
+            && found->Size == size)
+        {
+            return found->Metrics;
+        }
+    }
+
+    charbuff buffer;
+    utls::ReadTo(buffer, filepath);
+    auto ret = getOrCreateCachedMetricsFromBuffer(buffer, faceIndex, filepath);
+    if (ret == nullptr)
+        return nullptr;
+
+    MetricsCache::Entry entry;
+    entry.Metrics = ret;
+    entry.LastWriteTime = lastWriteTime;
+    entry.Size = size;
+    unique_lock<mutex> lock(cache.Mutex);
+    // NOTE: A stale entry for a modified file is replaced
+    (void)cache.Entries.Set(key, std::move(entry));
+    return ret;
+}
+
+PdfFontMetricsConstPtr PdfFontManager::getOrCreateCachedMetricsFromBuffer(const bufferview& buffer, unsigned faceIndex,
+    const string_view& filepath)
+{
+    auto& cache = getMetricsCache();
+    auto key = utls::Format("d{}/", faceIndex);
+    auto digest = ssl::ComputeHash(buffer, PdfHashingAlgorithm::SHA256);
+    key.append(digest.data(), digest.size());
+    {
+        unique_lock<mutex> lock(cache.Mutex);
+        auto found = cache.Entries.Find(key);
+        if (found != nullptr)
+            return found->Metrics;
+    }
+
+    // NOTE: Create the metrics outside the lock, it's the expensive part
+    auto metrics = PdfFontMetrics::CreateFromBuffer(buffer, faceIndex, nullptr, false);
+    if (metrics == nullptr)
+        return nullptr;
+
+    // NOTE: Metrics shared by data keep the
+    // path of the file they were loaded from
+    metrics->m_FilePath = filepath;
+
+    initLazyMetrics(*metrics);
+
+    MetricsCache::Entry entry;
+    entry.Metrics = std::move(metrics);
+    auto ret = entry.Metrics;
+    unique_lock<mutex> lock(cache.Mutex);
+    auto cached = cache.Entries.Add(key, std::move(entry));
+    return cached == nullptr ? ret : cached->Metrics;
+}
+
+void PdfFontManager::SetMetricsCacheSize(unsigned size)
+{
+    auto& cache = getMetricsCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    cache.Entries.SetMaxSize(size);
+}
+
+unsigned PdfFontManager::GetMetricsCacheSize()
+{
+    auto& cache = getMetricsCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    return cache.Entries.GetMaxSize();
+}
+
+void PdfFontManager::ClearMetricsCache()
+{
+    auto& cache = getMetricsCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    cache.Entries.Clear();
+}
+
+void PdfFontManager::SetFontFileCacheSize(unsigned size)
+{
+    PdfFont::SetFontFileCacheSize(size);
+}
+
+unsigned PdfFontManager::GetFontFileCacheSize()
+{
+    return PdfFont::GetFontFileCacheSize();
+}
+
+void PdfFontManager::ClearFontFileCache()
+{
+    PdfFont::ClearFontFileCache();
 }
 
 PdfFont& PdfFontManager::getOrCreateFontHashed(PdfFontMetricsConstPtr&& metrics, const PdfFontCreateParams& params)
@@ -288,7 +429,7 @@ PdfFont* PdfFontManager::getImportedFont(const string_view& pattern,
     }
 
     unique_ptr<AdaptedFontSearch> adaptedSearch;
-    unique_ptr<const PdfFontMetrics> metrics;
+    PdfFontMetricsConstPtr metrics;
     if (tryAdaptSearchParams(pattern, searchParams, adaptedSearch))
         metrics = searchFontMetrics(adaptedSearch->Pattern, adaptedSearch->Params, nullptr, false);
     else
@@ -322,6 +463,13 @@ PdfFontMetricsConstPtr PdfFontManager::SearchFontMetrics(const string_view& font
 
 void PdfFontManager::AddFontDirectory(const string_view& path)
 {
+    {
+        // The new fonts may change the results of searches
+        auto& cache = getMetricsCache();
+        unique_lock<mutex> lock(cache.Mutex);
+        clearCachedQueries(cache);
+    }
+
 #ifdef PODOFO_HAVE_FONTCONFIG
     auto& fc = GetFontConfigWrapper();
     fc.AddFontDirectory(path);
@@ -365,9 +513,23 @@ PdfFontMetricsConstPtr PdfFontManager::SearchFontMetrics(const string_view& font
     return searchFontMetrics(fontPattern, params, &metrics, skipNormalization);
 }
 
-unique_ptr<const PdfFontMetrics> PdfFontManager::searchFontMetrics(const string_view& fontName,
+PdfFontMetricsConstPtr PdfFontManager::searchFontMetrics(const string_view& fontName,
     const PdfFontSearchParams& params, const PdfFontMetrics* refMetrics, bool skipNormalization)
 {
+    // Metrics merged from reference metrics are specific to the
+    // loaded font, cache only the results of regular searches
+    bool useCache = refMetrics == nullptr && !skipNormalization;
+    string queryKey;
+    auto& cache = getMetricsCache();
+    if (useCache)
+    {
+        queryKey = getQueryKey(fontName, params);
+        unique_lock<mutex> lock(cache.Mutex);
+        auto found = cache.Entries.Find(queryKey);
+        if (found != nullptr)
+            return found->Metrics;
+    }
+
     string path;
     unsigned faceIndex = 0;
 #ifdef PODOFO_HAVE_FONTCONFIG
@@ -382,9 +544,14 @@ unique_ptr<const PdfFontMetrics> PdfFontManager::searchFontMetrics(const string_
     path = fc.SearchFontPath(fontName, fcParams, faceIndex);
 #endif
 
-    unique_ptr<const PdfFontMetrics> ret = nullptr;
+    PdfFontMetricsConstPtr ret;
     if (!path.empty())
-        ret = PdfFontMetrics::CreateFromFile(path, faceIndex, refMetrics, skipNormalization);
+    {
+        if (useCache)
+            ret = getOrCreateCachedMetrics(path, faceIndex);
+        else
+            ret = PdfFontMetrics::CreateFromFile(path, faceIndex, refMetrics, skipNormalization);
+    }
 
     if (ret == nullptr)
     {
@@ -394,13 +561,22 @@ unique_ptr<const PdfFontMetrics> PdfFontManager::searchFontMetrics(const string_
         if (data != nullptr)
         {
             // NOTE: The font has been already extracted from collections at this point
-            auto face = FT::CreateFaceFromBuffer(*data);
-            ret = PdfFontMetrics::CreateFromFace(face.get(), std::move(data), refMetrics, skipNormalization);
-            (void)face.release();
+            ret = PdfFontMetrics::CreateFromData(std::move(*data), refMetrics, skipNormalization);
         }
 #endif
     }
 
+    // NOTE: Failed searches are not cached, since
+    // fonts may be installed in the meantime
+    if (useCache && ret != nullptr)
+    {
+        initLazyMetrics(*ret);
+        MetricsCache::Entry entry;
+        entry.Metrics = ret;
+        unique_lock<mutex> lock(cache.Mutex);
+        (void)cache.Entries.Add(queryKey, std::move(entry));
+    }
+
     return ret;
 }
 
@@ -414,6 +590,23 @@ void PdfFontManager::EmbedFonts()
             fontToEmbeds.insert(font->GetObject().GetIndirectReference());
     }
 
+    // Build and compress the font programs concurrently. Fonts
+    // sharing the same metrics can be prepared by different jobs,
+    // since faces are locked when accessed, as long as the lazily
+    // computed properties of the metrics are initialized first
+    vector<PdfFont*> jobs;
+    for (auto& ref : fontToEmbeds)
+    {
+        auto font = m_fonts[ref].Font.get();
+        initLazyMetrics(font->GetMetrics());
+        jobs.push_back(font);
+    }
+
+    RunParallelJobs((unsigned)jobs.size(), [&jobs](unsigned index)
+    {
+        jobs[index]->PrepareEmbedFont();
+    });
+
     // Embed fonts now in deterministic order (note set<T> will guarantee this)
     for (auto& ref : fontToEmbeds)
         m_fonts[ref].Font->EmbedFont();
@@ -461,9 +654,7 @@ PdfFont& PdfFontManager::GetOrCreateFont(HFONT font, const PdfFontCreateParams&
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "Could not retrieve buffer for font!");
 
     // NOTE: The font has been already extracted from collections at this point
-    auto face = FT::CreateFaceFromBuffer(*data);
-    auto metrics = PdfFontMetrics::CreateFromFace(face.get(), std::move(data), nullptr, false);
-    (void)face.release();
+    auto metrics = PdfFontMetrics::CreateFromData(std::move(*data), nullptr, false);
     if (metrics == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "Could not create valid font!");
 
@@ -520,6 +711,11 @@ void PdfFontManager::SetFontConfigWrapper(const shared_ptr<PdfFontConfigWrapper>
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "Fontconfig wrapper can't be null");
 
     m_fontConfig = fontConfig;
+
+    // Searches performed with the previous configuration are not valid anymore
+    auto& cache = getMetricsCache();
+    unique_lock<mutex> lock(cache.Mutex);
+    clearCachedQueries(cache);
 }
 
 PdfFontConfigWrapper& PdfFontManager::GetFontConfigWrapper()
@@ -718,3 +914,31 @@ bool tryAdaptSearchParams(const string_view& fontName, const PdfFontSearchParams
 
     return true;
 }
+
+MetricsCache& getMetricsCache()
+{
+    static MetricsCache s_cache;
+    return s_cache;
+}
+
+// NOTE: The cache mutex must be held by the caller
+void clearCachedQueries(MetricsCache& cache)
+{
+    cache.Entries.EraseIf([](const string& key) { return key.front() == 'q'; });
+}
+
+string getQueryKey(const string_view& fontName, const PdfFontSearchParams& params)
+{
+    return utls::Format("q{}/{}/{}/{}/{}", params.Style.has_value() ? (int)*params.Style : -1,
+        (unsigned)params.MatchBehavior, params.FontFamilyPattern.size(), params.FontFamilyPattern, fontName);
+}
+
+void initLazyMetrics(const PdfFontMetrics& metrics)
+{
+    // Initialize lazily computed properties before the metrics
+    // are shared, so they are not written concurrently later
+    (void)metrics.GeFontFamilyNameSafe();
+    (void)metrics.GetStyle();
+    (void)metrics.GetFontFileLength1();
+    (void)metrics.GetFontFileLength2();
+}
@@ -135,6 +135,40 @@ public:
     static PdfFontMetricsConstPtr SearchFontMetrics(const std::string_view& fontPattern,
         const PdfFontSearchParams& params = { });
 
+    /// Set the maximum number of entries of the process-wide cache of
+    /// font metrics, shared by all documents. The default size is 256
+    /// entries. The cache is disabled when the size is 0
+    ///
+    /// Metrics created from font files, buffers and font searches are
+    /// cached by font data digest and face index, and file paths and
+    /// search queries are cached as well, so fonts are loaded only once
+    /// per process. The least recently used entries are evicted first
+    static void SetMetricsCacheSize(unsigned size);
+
+    /// Get the maximum number of entries of the process-wide cache of font metrics
+    static unsigned GetMetricsCacheSize();
+
+    /// Empty the process-wide cache of font metrics
+    /// @remarks Metrics already in use by fonts are not released
+    static void ClearMetricsCache();
+
+    /// Set the maximum number of entries of the process-wide cache of
+    /// embedded font programs, shared by all documents. The cache is
+    /// disabled by default, or when the size is 0
+    ///
+    /// Font programs are cached by font data digest and face index and,
+    /// for subsets, by the embedded glyphs, together with their
+    /// compressed stream data. When repeatedly generating documents
+    /// with the same fonts and glyphs, subsets are built and compressed
+    /// only once. The least recently used entries are evicted first
+    static void SetFontFileCacheSize(unsigned size);
+
+    /// Get the maximum number of entries of the process-wide cache of embedded font programs
+    static unsigned GetFontFileCacheSize();
+
+    /// Empty the process-wide cache of embedded font programs
+    static void ClearFontFileCache();
+
 #if defined(_WIN32) && defined(PODOFO_HAVE_WIN32GDI)
     PdfFont& GetOrCreateFont(HFONT font, const PdfFontCreateParams& params = { });
 #endif
@@ -230,12 +264,15 @@ private:
     using FontMap = std::unordered_map<PdfReference, Storage>;
 
 private:
-    static std::unique_ptr<const PdfFontMetrics> searchFontMetrics(const std::string_view& fontName,
+    static PdfFontMetricsConstPtr searchFontMetrics(const std::string_view& fontName,
         const PdfFontSearchParams& params, const PdfFontMetrics* refMetrics, bool skipNormalization);
     PdfFont* getImportedFont(const std::string_view& pattern,
         const PdfFontSearchParams& searchParams, const PdfFontCreateParams& createParams);
     PdfFont* addImported(std::vector<PdfFont*>& fonts, std::unique_ptr<PdfFont>&& font);
     PdfFont& getOrCreateFontHashed(PdfFontMetricsConstPtr&& metrics, const PdfFontCreateParams& params);
+    static PdfFontMetricsConstPtr getOrCreateCachedMetrics(const std::string_view& filepath, unsigned faceIndex);
+    static PdfFontMetricsConstPtr getOrCreateCachedMetricsFromBuffer(const bufferview& buffer, unsigned faceIndex,
+        const std::string_view& filepath = { });
 
 private:
     PdfFontManager(const PdfFontManager&) = delete;
@@ -6,6 +6,7 @@
 #include "PdfFontMetrics.h"
 
 #include <podofo/private/FreetypePrivate.h>
+#include <podofo/private/OpenSSLInternal.h>
 #ifdef PODOFO_ENABLE_AFDKO
 #include <podofo/private/FontUtilsAFDKO.h>
 #endif
@@ -43,20 +44,19 @@ unique_ptr<const PdfFontMetrics> PdfFontMetrics::CreateFromFile(const string_vie
     const PdfFontMetrics* refMetrics, bool skipNormalization)
 {
     charbuff buffer;
-    auto face = FT::CreateFaceFromFile(filepath, faceIndex, buffer);
-    if (face == nullptr)
+    if (!FT::TryReadFaceDataFromFile(filepath, faceIndex, buffer))
     {
         PoDoFo::LogMessage(PdfLogSeverity::Error, "Error when loading the face from the file");
         return nullptr;
     }
-    auto ret = CreateFromFace(face.get(), std::make_unique<charbuff>(std::move(buffer)), refMetrics, skipNormalization);
+
+    auto ret = CreateFromData(std::move(buffer), refMetrics, skipNormalization);
     if (ret != nullptr)
     {
         ret->m_FilePath = filepath;
         ret->m_FaceIndex = faceIndex;
     }
 
-    (void)face.release();
     return ret;
 }
 
@@ -65,22 +65,15 @@ unique_ptr<const PdfFontMetrics> PdfFontMetrics::CreateFromBuffer(const buffervi
     return CreateFromBuffer(buffer, faceIndex, nullptr, false);
 }
 
-unique_ptr<const PdfFontMetrics> PdfFontMetrics::CreateFromBuffer(const bufferview& view, unsigned faceIndex,
+unique_ptr<PdfFontMetrics> PdfFontMetrics::CreateFromBuffer(const bufferview& view, unsigned faceIndex,
     const PdfFontMetrics* refMetrics, bool skipNormalization)
 {
     charbuff buffer;
-    auto face = FT::CreateFaceFromBuffer(view, faceIndex, buffer);
-    if (face == nullptr)
-    {
-        PoDoFo::LogMessage(PdfLogSeverity::Error, "Error when loading the face from buffer");
-        return nullptr;
-    }
-
-    auto ret = CreateFromFace(face.get(), std::make_unique<charbuff>(std::move(buffer)), refMetrics, skipNormalization);
+    FT::ReadFaceDataFromBuffer(view, faceIndex, buffer);
+    auto ret = CreateFromData(std::move(buffer), refMetrics, skipNormalization);
     if (ret != nullptr)
         ret->m_FaceIndex = faceIndex;
 
-    (void)face.release();
     return ret;
 }
 
@@ -96,29 +89,39 @@ unique_ptr<const PdfFontMetrics> PdfFontMetrics::CreateMergedMetrics(bool skipNo
             // the font file to be inserted in a CID font
             charbuff cffDest;
             afdko::ConvertFontType1ToCFF(GetOrLoadFontFileData(), cffDest);
-            auto face = FT::CreateFaceFromBuffer(cffDest);
-            auto ret = unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(
-                face.get(), datahandle(std::move(cffDest)), this));
-            (void)face.release();
-            return ret;
+            shared_ptr<const charbuff> pooledData;
+            auto face = FT::GetOrCreatePooledFace(std::move(cffDest), pooledData);
+            return unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(
+                std::move(face), datahandle(std::move(pooledData)), this));
 #endif
         }
     }
 
-    auto face = GetFaceHandle();
-    auto ret = unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(face,
-        GetFontFileDataHandle(), this));
-    // Reference the face after having created a new PdfFontMetricsFreetype instance
-    FT::ReferenceFace(face);
-    return ret;
+    // NOTE: The data of this metrics is pooled, so the pooled
+    // face is found by the address of the data
+    shared_ptr<const charbuff> pooledData;
+    auto face = FT::GetOrCreatePooledFace(GetFontFileDataHandle().view(), pooledData);
+    return unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(
+        std::move(face), datahandle(std::move(pooledData)), this));
 }
 
-unique_ptr<PdfFontMetrics> PdfFontMetrics::CreateFromFace(FT_Face face, unique_ptr<charbuff>&& buffer,
+unique_ptr<PdfFontMetrics> PdfFontMetrics::CreateFromData(charbuff&& data,
     const PdfFontMetrics* refMetrics, bool skipNormalization)
 {
-    PdfFontFileType fontType;
-    if (!FT::TryGetFontFileFormat(face, fontType))
+    shared_ptr<const charbuff> pooledData;
+    auto face = FT::GetOrCreatePooledFace(std::move(data), pooledData);
+    if (face == nullptr)
+    {
+        PoDoFo::LogMessage(PdfLogSeverity::Error, "Error when loading the face from buffer");
         return nullptr;
+    }
+
+    PdfFontFileType fontType;
+    {
+        unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face.get()));
+        if (!FT::TryGetFontFileFormat(face.get(), fontType))
+            return nullptr;
+    }
 
 #ifdef PODOFO_ENABLE_AFDKO
     if (!skipNormalization)
@@ -129,19 +132,16 @@ unique_ptr<PdfFontMetrics> PdfFontMetrics::CreateFromFace(FT_Face face, unique_p
             // Unconditionally convert the Type1 font to CFF: this allow
             // the font file to be inserted in a CID font
             charbuff cffDest;
-            afdko::ConvertFontType1ToCFF(*buffer, cffDest);
-            auto newface = FT::CreateFaceFromBuffer(cffDest);
-            auto ret = unique_ptr<PdfFontMetricsFreetype>(new PdfFontMetricsFreetype(
-                newface.get(), datahandle(std::move(cffDest)), refMetrics));
-            (void)newface.release();
-            return ret;
+            afdko::ConvertFontType1ToCFF(*pooledData, cffDest);
+            face = FT::GetOrCreatePooledFace(std::move(cffDest), pooledData);
         }
     }
 #else
     (void)skipNormalization;
 #endif // PODOFO_ENABLE_AFDKO
 
-    return unique_ptr<PdfFontMetrics>(new PdfFontMetricsFreetype(face, datahandle(std::move(buffer)), refMetrics));
+    return unique_ptr<PdfFontMetrics>(new PdfFontMetricsFreetype(std::move(face),
+        datahandle(std::move(pooledData)), refMetrics));
 }
 
 unsigned PdfFontMetrics::GetGlyphCount() const
@@ -280,6 +280,7 @@ PdfCIDToGIDMapConstPtr PdfFontMetrics::GetTrueTypeBuiltinCIDToGIDMap() const
     }
 
     CIDToGIDMap map;
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
 
     // ISO 32000-2:2020 "9.6.5.4 Encodings for TrueType fonts"
     // "A TrueType font program’s built-in encoding maps directly
@@ -576,6 +577,7 @@ PdfEncodingMapConstPtr PdfFontMetrics::getDefaultEncoding(bool tryFetchCidToGidM
         auto face = GetFaceHandle();
         if (face != nullptr)
         {
+            unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
             auto ret = getFontType1BuiltInEncoding(face);
             if (tryFetchCidToGidMap && ret != nullptr)
                 cidToGidMap = getIntrinsicCIDToGIDMapType1(face, *ret, nullptr);
@@ -627,7 +629,14 @@ unsigned PdfFontMetrics::GetGlyphCountFontProgram() const
 bool PdfFontMetrics::TryGetGlyphWidthFontProgram(unsigned gid, double& width) const
 {
     auto face = GetFaceHandle();
-    if (face == nullptr || FT_Load_Glyph(face, gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
+    if (face == nullptr)
+    {
+        width = -1;
+        return false;
+    }
+
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
+    if (FT_Load_Glyph(face, gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
     {
         width = -1;
         return false;
@@ -645,6 +654,16 @@ void PdfFontMetrics::ExportType3GlyphData(PdfDictionary& fontDict, cspan<string_
     // Do nothing by default
 }
 
+const charbuff& PdfFontMetrics::getFontFileDigest() const
+{
+    // NOTE: Metrics can be shared between threads
+    std::call_once(m_fontFileDigestFlag, [this]()
+    {
+        m_fontFileDigest = ssl::ComputeHash(GetOrLoadFontFileData(), PdfHashingAlgorithm::SHA256);
+    });
+    return m_fontFileDigest;
+}
+
 bool PdfFontMetrics::HasParsedWidths() const
 {
     return m_ParsedWidths != nullptr;
@@ -658,40 +677,41 @@ unsigned PdfFontMetrics::GetParsedWidthsCount() const
     return (unsigned)m_ParsedWidths->size();
 }
 
-PdfFontMetricsBase::PdfFontMetricsBase()
-    : m_dataInit(false), m_faceInit(false), m_Face(nullptr) { }
+PdfFontMetricsBase::PdfFontMetricsBase() { }
 
-PdfFontMetricsBase::~PdfFontMetricsBase()
-{
-    FT::FreeFace(m_Face);
-}
+PdfFontMetricsBase::~PdfFontMetricsBase() { }
 
 const datahandle& PdfFontMetricsBase::GetFontFileDataHandle() const
 {
-    if (!m_dataInit)
-    {
-        auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
-        rthis.m_Data = getFontFileDataHandle();
-        rthis.m_dataInit = true;
-    }
-
+    initData();
     return m_Data;
 }
 
 FT_Face PdfFontMetricsBase::GetFaceHandle() const
 {
-    if (!m_faceInit)
-    {
-        auto& rthis = const_cast<PdfFontMetricsBase&>(*this);
-        auto view = GetFontFileDataHandle().view();
-        // NOTE: The data always represents a face, not a collection
-        if (view.size() != 0)
-            rthis.m_Face = FT::CreateFaceFromBuffer(view).release();
-
-        rthis.m_faceInit = true;
-    }
+    initData();
+    return m_Face.get();
+}
 
-    return m_Face;
+void PdfFontMetricsBase::initData() const
+{
+    // NOTE: Metrics can be shared between threads
+    std::call_once(m_dataInitFlag, [this]()
+    {
+        auto data = getFontFileDataHandle();
+        // NOTE: The data always represents a face, not a collection.
+        // Faces are pooled by font data, so metrics loaded from the
+        // same font data, also in different documents, share the face
+        // and the data. The original data is then released
+        shared_ptr<const charbuff> pooledData;
+        if (data.view().size() != 0)
+            m_Face = FT::GetOrCreatePooledFace(data.view(), pooledData);
+
+        if (m_Face == nullptr)
+            m_Data = std::move(data);
+        else
+            m_Data = datahandle(std::move(pooledData));
+    });
 }
 
 PdfCIDToGIDMapConstPtr PdfEncodingMapSimple::GetIntrinsicCIDToGIDMap(const PdfDictionary& fontDict, const PdfFontMetrics& metrics) const
@@ -709,6 +729,7 @@ PdfCIDToGIDMapConstPtr PdfEncodingMapSimple::GetIntrinsicCIDToGIDMap(const PdfDi
                 return nullptr;
 
             GetBaseEncoding(baseEncoding, differences);
+            unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
             return getIntrinsicCIDToGIDMapType1(face, *baseEncoding, differences);
         }
         case PdfFontFileType::TrueType:
@@ -727,6 +748,7 @@ PdfCIDToGIDMapConstPtr PdfEncodingMapSimple::GetIntrinsicCIDToGIDMap(const PdfDi
                 || typeid(baseEncoding) == typeid(PdfMacRomanEncoding)
                 || (metrics.GetFlags() & PdfFontDescriptorFlags::NonSymbolic) != PdfFontDescriptorFlags::None)
             {
+                unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
                 return getIntrinsicCIDToGIDMapTrueType(face, *baseEncoding, differences);
             }
 
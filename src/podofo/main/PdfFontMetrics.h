@@ -11,6 +11,8 @@
 #include <podofo/auxiliary/Matrix.h>
 #include <podofo/auxiliary/Corners.h>
 
+#include <mutex>
+
 FORWARD_DECLARE_FREETYPE();
 
 namespace PoDoFo {
@@ -338,10 +340,12 @@ private:
     static std::unique_ptr<const PdfFontMetrics> CreateFromFile(const std::string_view& filepath, unsigned faceIndex,
         const PdfFontMetrics* metrics, bool skipNormalization);
 
-    static std::unique_ptr<const PdfFontMetrics> CreateFromBuffer(const bufferview& buffer, unsigned faceIndex,
+    static std::unique_ptr<PdfFontMetrics> CreateFromBuffer(const bufferview& buffer, unsigned faceIndex,
         const PdfFontMetrics* metrics, bool skipNormalization);
 
-    static std::unique_ptr<PdfFontMetrics> CreateFromFace(FT_Face face, std::unique_ptr<charbuff>&& buffer,
+    /// Create metrics from single face font data, loaded
+    /// in a face shared with the other metrics of the same data
+    static std::unique_ptr<PdfFontMetrics> CreateFromData(charbuff&& data,
         const PdfFontMetrics* metrics, bool skipNormalization);
 
     /// Create a new font metrics by merging characteristics from this instance
@@ -359,6 +363,9 @@ private:
     void initFamilyFontNameSafe();
     PdfEncodingMapConstPtr getDefaultEncoding(bool tryFetchCidToGidMap, PdfCIDToGIDMapConstPtr& cidToGidMap) const;
 
+    /// Get the SHA-256 digest of the font program data, computed only once
+    const charbuff& getFontFileDigest() const;
+
 private:
     PdfFontMetrics(const PdfFontMetrics& rhs) = delete;
     PdfFontMetrics& operator=(const PdfFontMetrics& rhs) = delete;
@@ -369,6 +376,8 @@ private:
     GlyphMetricsListConstPtr m_ParsedWidths;
     nullable<PdfFontStyle> m_Style;
     unsigned m_FaceIndex;
+    mutable std::once_flag m_fontFileDigestFlag;
+    mutable charbuff m_fontFileDigest;
 };
 
 class PODOFO_API PdfFontMetricsBase : public PdfFontMetrics
@@ -388,10 +397,12 @@ protected:
     virtual datahandle getFontFileDataHandle() const = 0;
 
 private:
-    bool m_dataInit;
-    bool m_faceInit;
-    datahandle m_Data;
-    FT_Face m_Face;
+    void initData() const;
+
+private:
+    mutable std::once_flag m_dataInitFlag;
+    mutable datahandle m_Data;
+    mutable std::shared_ptr<FT_FaceRec_> m_Face;
 };
 
 
@@ -62,9 +62,9 @@ namespace
     };
 }
 
-PdfFontMetricsFreetype::PdfFontMetricsFreetype(FT_Face face, const datahandle& data,
+PdfFontMetricsFreetype::PdfFontMetricsFreetype(shared_ptr<FT_FaceRec_>&& face, const datahandle& data,
         const PdfFontMetrics* refMetrics) :
-    m_Face(face),
+    m_Face(std::move(face)),
     m_Data(data),
     m_SubsetPrefixLength(0),
     m_LengthsReady(false),
@@ -72,24 +72,23 @@ PdfFontMetricsFreetype::PdfFontMetricsFreetype(FT_Face face, const datahandle& d
     m_Length2(0),
     m_Length3(0)
 {
-    if (face == nullptr)
+    if (m_Face == nullptr)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The face can't be null");
 
     init(refMetrics);
 }
 
-PdfFontMetricsFreetype::~PdfFontMetricsFreetype()
-{
-    FT::FreeFace(m_Face);
-}
+PdfFontMetricsFreetype::~PdfFontMetricsFreetype() { }
 
 void PdfFontMetricsFreetype::init(const PdfFontMetrics* refMetrics)
 {
-    if (!FT::TryGetFontFileFormat(m_Face, m_FontFileType))
+    // NOTE: The face may be shared with other metrics
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(m_Face.get()));
+    if (!FT::TryGetFontFileFormat(m_Face.get(), m_FontFileType))
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "Unsupported font type");
 
     // Try to select an unicode charmap
-    if (FT_Select_Charmap(m_Face, FT_ENCODING_UNICODE) == 0)
+    if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_UNICODE) == 0)
     {
         m_HasUnicodeMapping = true;
     }
@@ -107,10 +106,10 @@ void PdfFontMetricsFreetype::init(const PdfFontMetrics* refMetrics)
     unique_ptr<MetricsFetcher> fetcher;
     if (refMetrics == nullptr)
     {
-        m_FontName = getPostscriptName(m_Face, m_FontFamilyName);
+        m_FontName = getPostscriptName(m_Face.get(), m_FontFamilyName);
         m_FontBaseName = PoDoFo::ExtractBaseFontName(m_FontName, true);
 
-        fetcher.reset(new MetricsFetcher(m_Face));
+        fetcher.reset(new MetricsFetcher(m_Face.get()));
 
         // Required metrics
         m_Flags = fetcher->GetFlags();
@@ -152,7 +151,7 @@ void PdfFontMetricsFreetype::init(const PdfFontMetrics* refMetrics)
         m_FontName = refMetrics->GetFontName();
         m_FontFamilyName = refMetrics->GetFontFamilyName();
         if (m_FontName.empty())
-            m_FontName = getPostscriptName(m_Face, m_FontFamilyName);
+            m_FontName = getPostscriptName(m_Face.get(), m_FontFamilyName);
         else
             m_SubsetPrefixLength = refMetrics->GetSubsetPrefixLength();
 
@@ -162,49 +161,49 @@ void PdfFontMetricsFreetype::init(const PdfFontMetrics* refMetrics)
         if (!refMetrics->TryGetFlags(m_Flags))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_Flags = fetcher->GetFlags();
         }
 
         if (!refMetrics->TryGetBoundingBox(m_BBox))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_BBox = fetcher->GetBoundingBox();
         }
 
         if (!refMetrics->TryGetItalicAngle(m_ItalicAngle))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_ItalicAngle = fetcher->GetItalicAngle();
         }
 
         if (!refMetrics->TryGetAscent(m_Ascent))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_Ascent = fetcher->GetAscent();
         }
 
         if (!refMetrics->TryGetDescent(m_Descent))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_Descent = fetcher->GetDescent();
         }
 
         if (!refMetrics->TryGetCapHeight(m_CapHeight))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_CapHeight = fetcher->GetCapHeight();
         }
 
         if (!refMetrics->TryGetStemV(m_StemV))
         {
             if (fetcher == nullptr)
-                fetcher.reset(new MetricsFetcher(m_Face));
+                fetcher.reset(new MetricsFetcher(m_Face.get()));
             m_StemV = fetcher->GetStemV();
         }
 
@@ -399,7 +398,8 @@ unsigned PdfFontMetricsFreetype::GetGlyphCountFontProgram() const
 
 bool PdfFontMetricsFreetype::TryGetGlyphWidthFontProgram(unsigned gid, double& width) const
 {
-    if (FT_Load_Glyph(m_Face, gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(m_Face.get()));
+    if (FT_Load_Glyph(m_Face.get(), gid, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
     {
         width = -1;
         return false;
@@ -436,7 +436,9 @@ bool PdfFontMetricsFreetype::TryGetGID(char32_t codePoint, unsigned& gid) const
         return true;
     }
 
-    gid = FT_Get_Char_Index(m_Face, codePoint);
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(m_Face.get()));
+    selectUnicodeCharmap();
+    gid = FT_Get_Char_Index(m_Face.get(), codePoint);
     return gid != 0;
 }
 
@@ -447,19 +449,30 @@ unique_ptr<PdfCMapEncoding> PdfFontMetricsFreetype::CreateToUnicodeMap(const Pdf
     FT_ULong charcode;
     FT_UInt gid;
 
-    charcode = FT_Get_First_Char(m_Face, &gid);
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(m_Face.get()));
+    selectUnicodeCharmap();
+    charcode = FT_Get_First_Char(m_Face.get(), &gid);
     while (gid != 0)
     {
         map.PushMapping({ gid, limitHints.MinCodeSize }, (char32_t)charcode);
-        charcode = FT_Get_Next_Char(m_Face, charcode, &gid);
+        charcode = FT_Get_Next_Char(m_Face.get(), charcode, &gid);
     }
 
     return std::make_unique<PdfCMapEncoding>(std::move(map));
 }
 
+void PdfFontMetricsFreetype::selectUnicodeCharmap() const
+{
+    // The face may be shared with other metrics
+    // that selected a different charmap
+    if (m_Face->charmap == nullptr || m_Face->charmap->encoding != FT_ENCODING_UNICODE)
+        (void)FT_Select_Charmap(m_Face.get(), FT_ENCODING_UNICODE);
+}
+
 bool PdfFontMetricsFreetype::tryBuildFallbackUnicodeMap()
 {
-    auto os2Table = static_cast<TT_OS2*>(FT_Get_Sfnt_Table(m_Face, FT_SFNT_OS2));
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(m_Face.get()));
+    auto os2Table = static_cast<TT_OS2*>(FT_Get_Sfnt_Table(m_Face.get(), FT_SFNT_OS2));
     if (os2Table != nullptr)
     {
         // https://learn.microsoft.com/en-us/typography/opentype/spec/recom#panose-values
@@ -472,16 +485,16 @@ bool PdfFontMetricsFreetype::tryBuildFallbackUnicodeMap()
             // as character codes with 1:1 mapping when mapping to GID.
             // This appears to be what Adobe actually does in its products
             m_fallbackUnicodeMap.reset(new unordered_map<uint32_t, unsigned>());
-            if (FT_Select_Charmap(m_Face, FT_ENCODING_MS_SYMBOL) == 0)
+            if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_MS_SYMBOL) == 0)
             {
                 // If a symbol encoding is available, just collect that
-                collectCharCodeToGIDMap(m_Face, true, *m_fallbackUnicodeMap);
+                collectCharCodeToGIDMap(m_Face.get(), true, *m_fallbackUnicodeMap);
             }
             else
             {
                 // If the symbol encoding is not available, just collect
                 // the default selected charmap
-                collectCharCodeToGIDMap(m_Face, false, *m_fallbackUnicodeMap);
+                collectCharCodeToGIDMap(m_Face.get(), false, *m_fallbackUnicodeMap);
             }
 
             return true;
@@ -491,40 +504,40 @@ bool PdfFontMetricsFreetype::tryBuildFallbackUnicodeMap()
     // Try to create an Unicode to GID char map from legacy "encodings"
     // (or better charmaps), as reported by FreeType
 
-    if (FT_Select_Charmap(m_Face, FT_ENCODING_APPLE_ROMAN) == 0)
+    if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_APPLE_ROMAN) == 0)
     {
         unordered_map<unsigned, unsigned> codeToGIDmap;
-        collectCharCodeToGIDMap(m_Face, false, codeToGIDmap);
+        collectCharCodeToGIDMap(m_Face.get(), false, codeToGIDmap);
         m_fallbackUnicodeMap.reset(new unordered_map<uint32_t, unsigned>());
         auto encoding = PdfEncodingMapFactory::GetMacRomanEncodingInstancePtr();
         encoding->CreateUnicodeToGIDMap(codeToGIDmap, *m_fallbackUnicodeMap);
         return true;
     }
 
-    if (FT_Select_Charmap(m_Face, FT_ENCODING_ADOBE_LATIN_1) == 0)
+    if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_ADOBE_LATIN_1) == 0)
     {
         unordered_map<unsigned, unsigned> codeToGIDmap;
-        collectCharCodeToGIDMap(m_Face, false, codeToGIDmap);
+        collectCharCodeToGIDMap(m_Face.get(), false, codeToGIDmap);
         m_fallbackUnicodeMap.reset(new unordered_map<uint32_t, unsigned>());
         auto encoding = PdfEncodingMapFactory::GetAppleLatin1EncodingInstancePtr();
         encoding->CreateUnicodeToGIDMap(codeToGIDmap, *m_fallbackUnicodeMap);
         return true;
     }
 
-    if (FT_Select_Charmap(m_Face, FT_ENCODING_ADOBE_STANDARD) == 0)
+    if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_ADOBE_STANDARD) == 0)
     {
         unordered_map<unsigned, unsigned> codeToGIDmap;
-        collectCharCodeToGIDMap(m_Face, false, codeToGIDmap);
+        collectCharCodeToGIDMap(m_Face.get(), false, codeToGIDmap);
         m_fallbackUnicodeMap.reset(new unordered_map<uint32_t, unsigned>());
         auto encoding = PdfEncodingMapFactory::GetStandardEncodingInstancePtr();
         encoding->CreateUnicodeToGIDMap(codeToGIDmap, *m_fallbackUnicodeMap);
         return true;
     }
 
-    if (FT_Select_Charmap(m_Face, FT_ENCODING_ADOBE_EXPERT) == 0)
+    if (FT_Select_Charmap(m_Face.get(), FT_ENCODING_ADOBE_EXPERT) == 0)
     {
         unordered_map<unsigned, unsigned> codeToGIDmap;
-        collectCharCodeToGIDMap(m_Face, false, codeToGIDmap);
+        collectCharCodeToGIDMap(m_Face.get(), false, codeToGIDmap);
         m_fallbackUnicodeMap.reset(new unordered_map<uint32_t, unsigned>());
         auto encoding = PdfEncodingMapFactory::GetMacExpertEncodingInstancePtr();
         encoding->CreateUnicodeToGIDMap(codeToGIDmap, *m_fallbackUnicodeMap);
@@ -613,7 +626,7 @@ const datahandle& PdfFontMetricsFreetype::GetFontFileDataHandle() const
 
 FT_Face PdfFontMetricsFreetype::GetFaceHandle() const
 {
-    return m_Face;
+    return m_Face.get();
 }
 
 int PdfFontMetricsFreetype::GetWeightRaw() const
@@ -735,10 +748,11 @@ string getPostscriptName(FT_Face face, string& fontFamilyName)
 }
 
 MetricsFetcher::MetricsFetcher(FT_Face face) :
-    m_face(face),
-    m_os2Table(static_cast<TT_OS2*>(FT_Get_Sfnt_Table(face, FT_SFNT_OS2))),
-    m_psTable(static_cast<TT_Postscript*>(FT_Get_Sfnt_Table(face, FT_SFNT_POST)))
+    m_face(face)
 {
+    unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
+    m_os2Table = static_cast<TT_OS2*>(FT_Get_Sfnt_Table(face, FT_SFNT_OS2));
+    m_psTable = static_cast<TT_Postscript*>(FT_Get_Sfnt_Table(face, FT_SFNT_POST));
     m_hasType1Info = FT_Get_PS_Font_Info(m_face, &m_type1Info) == 0;
 
     // CHECK-ME: Try to read Type1 tables as well?
@@ -99,7 +99,8 @@ protected:
     bool getIsItalicHint() const override;
 
 private:
-    PdfFontMetricsFreetype(FT_Face face, const datahandle& data, const PdfFontMetrics* refMetrics = nullptr);
+    PdfFontMetricsFreetype(std::shared_ptr<FT_FaceRec_>&& face, const datahandle& data,
+        const PdfFontMetrics* refMetrics = nullptr);
 
     void init(const PdfFontMetrics* refMetrics);
 
@@ -108,9 +109,10 @@ private:
     void initType1Lengths(const bufferview& view);
 
     bool tryBuildFallbackUnicodeMap();
+    void selectUnicodeCharmap() const;
 
 private:
-    FT_Face m_Face;
+    std::shared_ptr<FT_FaceRec_> m_Face;
     datahandle m_Data;
     PdfFontFileType m_FontFileType;
 
@@ -428,8 +428,16 @@ PdfFontFileType PdfFontMetricsObject::GetFontFileType() const
 
     auto face = GetFaceHandle();
     PdfFontFileType type;
-    if (face == nullptr || !FT::TryGetFontFileFormat(face, type))
+    if (face == nullptr)
+    {
         type = PdfFontFileType::Unknown;
+    }
+    else
+    {
+        unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face));
+        if (!FT::TryGetFontFileFormat(face, type))
+            type = PdfFontFileType::Unknown;
+    }
 
     const_cast<PdfFontMetricsObject&>(*this).m_FontFileType = type;
     return type;
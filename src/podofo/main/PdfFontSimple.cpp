@@ -5,6 +5,8 @@
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfFontSimple.h"
 
+#include <podofo/private/FontTrueTypeSubset.h>
+
 #include "PdfDocument.h"
 #include "PdfDifferenceEncoding.h"
 
@@ -17,6 +19,20 @@ PdfFontSimple::PdfFontSimple(PdfDocument& doc, PdfFontType type,
 {
 }
 
+bool PdfFontSimple::SupportsSubsetting() const
+{
+    // NOTE: Type1 font programs are embedded fully, but
+    // the encoding and the /Widths are still limited
+    // to the used char codes
+    return true;
+}
+
+bool PdfFontSimple::subsetsFontProgram() const
+{
+    // Only TrueType font programs can be subsetted at the moment
+    return GetType() == PdfFontType::TrueType && m_Metrics->GetFontFileType() == PdfFontFileType::TrueType;
+}
+
 void PdfFontSimple::getWidthsArray(PdfArray& arr) const
 {
     unsigned gid;
@@ -55,7 +71,10 @@ void PdfFontSimple::initImported()
     dict.AddKey("Subtype"_n, subType);
     dict.AddKey("BaseFont"_n, PdfName(GetName()));
 
-    m_Encoding->ExportToFont(*this);
+    // NOTE: When subsetting, the encoding is exported
+    // on embedding, when the used char codes are known
+    if (!IsSubsettingEnabled())
+        m_Encoding->ExportToFont(*this);
 
     if (!GetMetrics().IsStandard14FontMetrics() || IsEmbeddingEnabled())
     {
@@ -86,46 +105,93 @@ void PdfFontSimple::embedFont()
 
 void PdfFontSimple::embedFontSubset()
 {
-    // NOTE: For now it's supported only for Type 3 fonts
-    PODOFO_ASSERT(GetType() == PdfFontType::Type3);
-
-    auto& matrix = m_Metrics->GetMatrix();
-    auto diffEncoding = dynamic_cast<const PdfDifferenceEncoding*>(&m_Encoding->GetEncodingMap());
-    if (diffEncoding == nullptr)
+    PODOFO_ASSERT(m_Descriptor != nullptr);
+    m_Encoding->ExportToFont(*this);
+    if (!HasCIDSubset())
     {
-        m_Metrics->ExportType3GlyphData(GetDictionary(), { });
+        // No char code was used, just embed the full
+        // font, which then is not tagged as a subset
+        removeSubsetPrefix();
+        GetDictionary().AddKey("BaseFont"_n, PdfName(GetName()));
+        m_Descriptor->GetDictionary().AddKey("FontName"_n, PdfName(GetName()));
+        embedFont();
+        return;
     }
-    else
-    {
-        auto cidInfos = GetCharGIDInfos();
-        unsigned first = GetEncoding().GetFirstChar().Code;
-        unsigned last = GetEncoding().GetLastChar().Code;
 
+    auto infos = GetCharGIDInfos();
+    createSubsetWidths(infos);
+    if (GetType() == PdfFontType::Type3)
+    {
         vector<string_view> glyphs;
-        vector<double> widths(last - first + 1);
-        const PdfName* name;
-        for (unsigned i = 0; i < cidInfos.size(); i++)
+        auto diffEncoding = dynamic_cast<const PdfDifferenceEncoding*>(&m_Encoding->GetEncodingMap());
+        if (diffEncoding != nullptr)
         {
-            auto& cidInfo = cidInfos[i];
-            if (!diffEncoding->GetDifferences().TryGetMappedName((unsigned char)cidInfo.OrigCid, name))
-                continue;
-
-            // Check for overflows before insertion. Missing widths are already handled
-            // by default value (/MissingWidth in the descriptor)
-            if (cidInfo.OrigCid - first < widths.size())
-                widths[cidInfo.OrigCid - first] = m_Metrics->GetGlyphWidth(cidInfo.Gid.MetricsId) / matrix[0];
-
-            glyphs.push_back(name->GetString());
+            const PdfName* name;
+            for (auto& info : infos)
+            {
+                if (diffEncoding->GetDifferences().TryGetMappedName((unsigned char)info.OrigCid, name))
+                    glyphs.push_back(name->GetString());
+            }
         }
 
         m_Metrics->ExportType3GlyphData(GetDictionary(), glyphs);
+        return;
+    }
 
-        PdfArray arr;
-        arr.reserve(widths.size());
-        for (unsigned i = 0; i < widths.size(); i++)
-            arr.Add(PdfObject(widths[i]));
+    // NOTE: The subset may have been already built concurrently
+    // by PrepareEmbedFont(), see PdfFontManager::EmbedFonts()
+    auto& descriptor = m_Descriptor->GetDictionary();
+    charbuff buffer;
+    bufferview data;
+    if (tryGetPreparedFontFile(data))
+        EmbedFontFileTrueType(descriptor, data);
+    else if (tryBuildFontFileSubset(buffer))
+        EmbedFontFileTrueType(descriptor, buffer);
+    else
+        EmbedFontFile(descriptor);
+}
 
-        auto& widthsObj = GetDocument().GetObjects().CreateObject(std::move(arr));
-        GetDictionary().AddKeyIndirect("Widths"_n, widthsObj);
+bool PdfFontSimple::tryBuildFontFileSubset(charbuff& buffer) const
+{
+    if (!subsetsFontProgram())
+        return false;
+
+    // The subset maps the char codes to the glyphs
+    // with a new 'cmap', also by their code points
+    auto infos = GetCharGIDInfos();
+    vector<char32_t> codePoints(infos.size());
+    CodePointSpan span;
+    for (unsigned i = 0; i < infos.size(); i++)
+    {
+        if (m_Encoding->GetToUnicodeMapSafe().TryGetCodePoints(PdfCharCode(infos[i].OrigCid, 1), span)
+            && span.GetSize() == 1)
+        {
+            codePoints[i] = *span;
+        }
     }
+
+    FontTrueTypeSubset::BuildFontSimple(*m_Metrics, infos, codePoints, buffer);
+    return true;
+}
+
+void PdfFontSimple::createSubsetWidths(const cspan<PdfCharGIDInfo>& infos)
+{
+    // NOTE: Infos are ordered by the original CID which, in
+    // non CID-keyed fonts, is equivalent to the char code
+    auto& matrix = m_Metrics->GetMatrix();
+    unsigned first = infos[0].OrigCid;
+    unsigned last = infos[infos.size() - 1].OrigCid;
+
+    // Unused char codes in the range get a zero width
+    vector<double> widths(last - first + 1);
+    for (auto& info : infos)
+        widths[info.OrigCid - first] = m_Metrics->GetGlyphWidth(info.Gid.MetricsId) / matrix[0];
+
+    PdfArray arr;
+    arr.reserve(widths.size());
+    for (unsigned i = 0; i < widths.size(); i++)
+        arr.Add(PdfObject(widths[i]));
+
+    auto& widthsObj = GetDocument().GetObjects().CreateObject(std::move(arr));
+    GetDictionary().AddKeyIndirect("Widths"_n, widthsObj);
 }
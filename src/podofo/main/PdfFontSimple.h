@@ -33,15 +33,23 @@ private:
     PdfFontSimple(PdfDocument& doc, PdfFontType type,
         PdfFontMetricsConstPtr&& metrics, const PdfEncoding& encoding);
 
+public:
+    bool SupportsSubsetting() const override;
+
 protected:
     void embedFont() override final;
 
     void embedFontSubset() override final;
 
+    bool tryBuildFontFileSubset(charbuff& buffer) const override;
+
+    bool subsetsFontProgram() const override;
+
     void initImported() override;
 
 private:
     void getWidthsArray(PdfArray& widths) const;
+    void createSubsetWidths(const cspan<PdfCharGIDInfo>& infos);
 
 protected:
     PdfObject* m_Descriptor;
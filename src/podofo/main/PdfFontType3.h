@@ -34,9 +34,6 @@ private:
     ///
     PdfFontType3(PdfDocument& doc, PdfFontMetricsConstPtr&& metrics,
         const PdfEncoding& encoding);
-
-public:
-    bool SupportsSubsetting() const override;
 };
 
 };
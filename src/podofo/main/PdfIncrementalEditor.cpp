@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfIncrementalEditor.h"
+
+#include <podofo/auxiliary/StreamDevice.h>
+#include <podofo/private/PdfWriter.h>
+#include <podofo/private/PdfParser.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+PdfIncrementalEditor::PdfIncrementalEditor(shared_ptr<InputStreamDevice> device,
+        PdfLoadOptions opts, const string_view& password) :
+    PdfDocument(true),
+    m_Version(PdfVersionDefault),
+    m_InitialVersion(PdfVersionDefault),
+    m_HasXRefStream(false),
+    m_MagicOffset(0),
+    m_PrevXRefOffset(0)
+{
+    if (device == nullptr)
+        PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
+
+    loadFromDevice(std::move(device), opts, password);
+}
+
+PdfIncrementalEditor::PdfIncrementalEditor(const string_view& filename,
+        PdfLoadOptions opts, const string_view& password) :
+    PdfDocument(true),
+    m_Version(PdfVersionDefault),
+    m_InitialVersion(PdfVersionDefault),
+    m_HasXRefStream(false),
+    m_MagicOffset(0),
+    m_PrevXRefOffset(0)
+{
+    if (filename.length() == 0)
+        PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
+
+    loadFromDevice(std::make_shared<FileStreamDevice>(filename), opts, password);
+}
+
+PdfIncrementalEditor::~PdfIncrementalEditor()
+{
+    // NOTE: The parser detaches from the object list on destruction
+}
+
+void PdfIncrementalEditor::loadFromDevice(shared_ptr<InputStreamDevice>&& device,
+    PdfLoadOptions opts, const string_view& password)
+{
+    m_device = std::move(device);
+
+    bool strictParsing = (opts & PdfLoadOptions::StrictParsing) != PdfLoadOptions::None;
+    SetStrictParsing(strictParsing);
+
+    m_parser.reset(new PdfParser(PdfDocument::GetObjects()));
+    m_parser->SetStrictParsing(strictParsing);
+    m_parser->SetLoadObjectsOnDemand(true);
+    m_parser->SetPassword(password);
+    m_parser->Parse(*m_device);
+
+    m_Version = m_parser->GetPdfVersion();
+    m_InitialVersion = m_Version;
+    m_HasXRefStream = m_parser->HasXRefStream();
+    m_PrevXRefOffset = m_parser->GetXRefOffset();
+    m_MagicOffset = m_parser->GetMagicOffset();
+    auto entryPoint = m_parser->TakeEntryPoints();
+    SetEntryPoints(std::move(entryPoint.Trailer), entryPoint.Catalog);
+
+    auto encrypt = m_parser->GetEncrypt();
+    if (encrypt != nullptr)
+        m_Encrypt.reset(new PdfEncryptSession(*encrypt));
+
+    Init();
+}
+
+void PdfIncrementalEditor::SaveUpdate(const string_view& filename, PdfSaveOptions opts)
+{
+    FileStreamDevice device(filename, FileMode::Append);
+    this->SaveUpdate(device, opts);
+}
+
+void PdfIncrementalEditor::SaveUpdate(OutputStreamDevice& device, PdfSaveOptions opts)
+{
+    // NOTE: Garbage collection and objects deduplication would
+    // require to visit, and hence load, the whole document
+    if ((opts & PdfSaveOptions::NoMetadataUpdate) == PdfSaveOptions::None)
+    {
+        GetMetadata().SetModifyDate(PdfDate::LocalNow());
+        (void)GetMetadata().TrySyncXMPMetadata();
+    }
+
+    GetFonts().EmbedFonts();
+
+    PdfWriter writer(this->GetObjects(), this->GetTrailer().GetObject(), m_MagicOffset);
+    writer.SetPdfVersion(GetMetadata().GetPdfVersion());
+    writer.SetPdfALevel(GetMetadata().GetPdfALevel());
+    writer.SetSaveOptions(opts);
+    writer.SetPrevXRefOffset(m_PrevXRefOffset);
+    writer.SetUseXRefStream(m_HasXRefStream);
+    writer.SetIncrementalUpdate(true);
+
+    if (m_Encrypt != nullptr)
+        writer.SetEncrypt(*m_Encrypt);
+
+    if (m_InitialVersion < this->GetPdfVersion())
+    {
+        if (this->GetPdfVersion() < PdfVersion::V1_0 || this->GetPdfVersion() > PdfVersion::V2_0)
+            PODOFO_RAISE_ERROR(PdfErrorCode::ValueOutOfRange);
+
+        GetCatalog().GetDictionary().AddKey("Version"_n, PoDoFo::GetPdfVersionName(GetPdfVersion()));
+    }
+
+    try
+    {
+        device.Seek(0, SeekDirection::End);
+        writer.Write(device);
+    }
+    catch (PdfError& e)
+    {
+        PODOFO_PUSH_FRAME(e);
+        throw;
+    }
+
+    m_PrevXRefOffset = writer.GetCurrXRefOffset();
+}
+
+bool PdfIncrementalEditor::HasOwnerPermissions() const
+{
+    return m_Encrypt == nullptr || m_Encrypt->HasOwnerPermissions();
+}
+
+const PdfEncrypt* PdfIncrementalEditor::GetEncrypt() const
+{
+    if (m_Encrypt == nullptr)
+        return nullptr;
+
+    return &m_Encrypt->GetEncrypt();
+}
+
+void PdfIncrementalEditor::SetPdfVersion(PdfVersion version)
+{
+    m_Version = version;
+}
+
+PdfVersion PdfIncrementalEditor::GetPdfVersion() const
+{
+    return m_Version;
+}
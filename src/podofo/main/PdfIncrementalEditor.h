@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_INCREMENTAL_EDITOR_H
+#define PDF_INCREMENTAL_EDITOR_H
+
+#include <podofo/auxiliary/InputDevice.h>
+#include <podofo/auxiliary/OutputDevice.h>
+
+#include "PdfDocument.h"
+#include "PdfEncryptSession.h"
+
+namespace PoDoFo {
+
+class PdfParser;
+
+/// PdfIncrementalEditor edits an existing PDF file by appending
+/// incremental updates to it, without loading the whole document.
+///
+/// Only the cross reference sections and the trailer are read when
+/// loading: the objects are read on demand from the input device when
+/// they are first accessed, so the memory usage depends only on the
+/// objects actually touched and not on the size of the file. Modified and
+/// newly created objects are appended as an update section that links
+/// the previous cross reference section with /Prev.
+///
+/// The input device must remain readable for the whole lifetime
+/// of the editor.
+///
+/// @see PdfMemDocument
+class PODOFO_API PdfIncrementalEditor final : public PdfDocument
+{
+public:
+    /// Load the document from an input device
+    ///
+    /// @param device the input device containing the PDF
+    /// @param opts load options. PdfLoadOptions::LoadStreamsEagerly is ignored
+    /// @param password optional password for encrypted documents
+    /// @remarks Documents with broken cross reference sections can't be
+    /// edited incrementally and an exception is thrown
+    PdfIncrementalEditor(std::shared_ptr<InputStreamDevice> device,
+        PdfLoadOptions opts = PdfLoadOptions::None, const std::string_view& password = { });
+
+    /// Load the document from a file
+    ///
+    /// @param filename filename of the file which is going to be opened
+    /// @param opts load options. PdfLoadOptions::LoadStreamsEagerly is ignored
+    /// @param password optional password for encrypted documents
+    PdfIncrementalEditor(const std::string_view& filename,
+        PdfLoadOptions opts = PdfLoadOptions::None, const std::string_view& password = { });
+
+    ~PdfIncrementalEditor();
+
+    /// Append the document changes to a file as an incremental update
+    ///
+    /// @param filename filename of the document
+    /// @param opts save options. PdfSaveOptions::DeduplicateObjects and
+    /// garbage collection are not supported and are ignored
+    ///
+    /// This is an overloaded member function for your convenience.
+    void SaveUpdate(const std::string_view& filename, PdfSaveOptions opts = PdfSaveOptions::None);
+
+    /// Append the document changes to an output device as an incremental update
+    ///
+    /// @param device write to this output device. It should contain
+    /// the original document, as only the changes are written at its end
+    /// @param opts save options. PdfSaveOptions::DeduplicateObjects and
+    /// garbage collection are not supported and are ignored
+    void SaveUpdate(OutputStreamDevice& device, PdfSaveOptions opts = PdfSaveOptions::None);
+
+    bool HasOwnerPermissions() const override;
+
+    const PdfEncrypt* GetEncrypt() const override;
+
+    inline size_t GetMagicOffset() const { return m_MagicOffset; }
+
+protected:
+    void SetPdfVersion(PdfVersion version) override;
+
+    PdfVersion GetPdfVersion() const override;
+
+private:
+    void loadFromDevice(std::shared_ptr<InputStreamDevice>&& device, PdfLoadOptions opts, const std::string_view& password);
+
+private:
+    PdfIncrementalEditor(const PdfIncrementalEditor&) = delete;
+    PdfIncrementalEditor& operator=(const PdfIncrementalEditor&) = delete;
+
+private:
+    PdfVersion m_Version;
+    PdfVersion m_InitialVersion;
+    bool m_HasXRefStream;
+    size_t m_MagicOffset;
+    size_t m_PrevXRefOffset;
+    std::unique_ptr<PdfEncryptSession> m_Encrypt;
+    std::shared_ptr<InputStreamDevice> m_device;
+    std::unique_ptr<PdfParser> m_parser;
+};
+
+};
+
+#endif // PDF_INCREMENTAL_EDITOR_H
@@ -67,7 +67,8 @@ PdfIndirectObjectList::PdfIndirectObjectList() :
     m_Document(nullptr),
     m_LastObjectNumber(0),
     m_FreeObjectsInvalidated(false),
-    m_StreamFactory(nullptr)
+    m_StreamFactory(nullptr),
+    m_ObjectLoader(nullptr)
 {
 }
 
@@ -75,7 +76,8 @@ PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document) :
     m_Document(&document),
     m_LastObjectNumber(0),
     m_FreeObjectsInvalidated(false),
-    m_StreamFactory(nullptr)
+    m_StreamFactory(nullptr),
+    m_ObjectLoader(nullptr)
 {
 }
 
@@ -85,7 +87,8 @@ PdfIndirectObjectList::PdfIndirectObjectList(PdfDocument& document, const PdfInd
     m_FreeObjectsInvalidated(false),
     m_FreeObjects(rhs.m_FreeObjects),
     m_UnavailableObjects(rhs.m_UnavailableObjects),
-    m_StreamFactory(nullptr)
+    m_StreamFactory(nullptr),
+    m_ObjectLoader(nullptr)
 {
     // Copy all objects from source, resetting parent and indirect reference
     for (auto obj : rhs.m_Objects)
@@ -126,6 +129,25 @@ PdfObject& PdfIndirectObjectList::MustGetObject(const PdfReference& ref) const
 
 PdfObject* PdfIndirectObjectList::GetObject(const PdfReference& ref) const
 {
+    auto it = m_Objects.lower_bound(ref);
+    if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
+    {
+        if (m_ObjectLoader == nullptr)
+            return nullptr;
+
+        // NOTE: Loading the object on demand pushes it on the
+        // list, even if the lookup is logically const
+        return const_cast<PdfIndirectObjectList&>(*this).tryLoadObject(ref);
+    }
+
+    return *it;
+}
+
+PdfObject* PdfIndirectObjectList::tryLoadObject(const PdfReference& ref)
+{
+    if (!m_ObjectLoader->TryLoadObject(ref))
+        return nullptr;
+
     auto it = m_Objects.lower_bound(ref);
     if (it == m_Objects.end() || (*it)->GetIndirectReference() != ref)
         return nullptr;
@@ -522,6 +544,11 @@ void PdfIndirectObjectList::SetStreamFactory(StreamFactory* factory)
     m_StreamFactory = factory;
 }
 
+void PdfIndirectObjectList::SetObjectLoader(ObjectLoader* loader)
+{
+    m_ObjectLoader = loader;
+}
+
 void PdfIndirectObjectList::ResetFreeObjectsInvalidated()
 {
     m_FreeObjectsInvalidated = false;
@@ -63,6 +63,8 @@ public:
     /// and returns a pointer to it if it is found.
     /// @param ref the object to be found
     /// @returns the found object or nullptr if no object was found.
+    /// @remarks If the objects are loaded on demand, looking up an object
+    /// not yet loaded pushes it on the list, so lookups can't be concurrent
     PdfObject* GetObject(const PdfReference& ref) const;
 
     /// Creates a new object and inserts it into the vector.
@@ -146,6 +148,22 @@ private:
         virtual std::unique_ptr<PdfObjectStreamProvider> CreateStream() = 0;
     };
 
+    /// This class is used to load objects on demand, when
+    /// they are looked up and not found in the list
+    class PODOFO_API ObjectLoader
+    {
+    public:
+        virtual ~ObjectLoader() { }
+
+        /// Try to load the object with the given reference,
+        /// pushing it on the list
+        ///
+        /// @param ref the reference of the object to load
+        ///
+        /// @returns true if the object was loaded
+        virtual bool TryLoadObject(const PdfReference& ref) = 0;
+    };
+
     using ReferenceSet = std::set<PdfReference>;
     using ObserverList = std::vector<Observer*>;
     using ObjectList = std::set<PdfObject*, PdfObjectInequality>;
@@ -262,6 +280,11 @@ private:
     /// @param factory a stream factory or nullptr to reset to the default factory
     void SetStreamFactory(StreamFactory* factory);
 
+    /// Sets an ObjectLoader which is used whenever a looked up object is not found
+    ///
+    /// @param loader an object loader or nullptr to disable loading objects on demand
+    void SetObjectLoader(ObjectLoader* loader);
+
     /// Reset the flag which determines if the free objects were invalidated
     void ResetFreeObjectsInvalidated();
 
@@ -282,6 +305,9 @@ private:
 
     void addNewObject(std::unique_ptr<PdfObject>&& obj);
 
+    /// Load the object with the object loader and push it on the list
+    PdfObject* tryLoadObject(const PdfReference& ref);
+
     /// @returns the next free object reference
     PdfReference getNextFreeObject();
 
@@ -304,6 +330,7 @@ private:
 
     ObserverList m_observers;
     StreamFactory* m_StreamFactory;
+    ObjectLoader* m_ObjectLoader;
 };
 
 };
@@ -8,6 +8,8 @@
 #include <podofo/auxiliary/StreamDevice.h>
 #include <podofo/private/PdfWriter.h>
 #include <podofo/private/PdfParser.h>
+#include <podofo/private/PdfParserObject.h>
+#include <podofo/private/FileSystem.h>
 
 #include "PdfCommon.h"
 
@@ -139,7 +141,7 @@ void PdfMemDocument::Load(shared_ptr<InputStreamDevice> device, PdfLoadOptions o
 }
 
 void PdfMemDocument::loadFromDevice(shared_ptr<InputStreamDevice>&& device,
-    PdfLoadOptions opts, const string_view& password)
+    PdfLoadOptions opts, const string_view& password, const PdfAuthenticator* authenticator)
 {
     this->Clear();
     m_device = std::move(device);
@@ -157,12 +159,19 @@ void PdfMemDocument::loadFromDevice(shared_ptr<InputStreamDevice>&& device,
         parser.SetLoadStreamsEagerly(true);
 
     parser.SetPassword(password);
+    parser.SetAuthenticator(authenticator);
     parser.Parse(*m_device);
     initFromParser(parser);
 }
 
 void PdfMemDocument::Save(const string_view& filename, PdfSaveOptions options)
 {
+    // The source file is truncated when saving over it
+    auto source = dynamic_cast<FileStreamDevice*>(m_device.get());
+    error_code ec;
+    if (source != nullptr && fs::equivalent(fs::u8path(source->GetFilepath()), fs::u8path(filename), ec))
+        detachSource();
+
     FileStreamDevice device(filename, FileMode::Create);
     this->Save(device, options);
 }
@@ -248,6 +257,12 @@ void PdfMemDocument::beforeWrite(PdfSaveOptions opts)
 
     GetFonts().EmbedFonts();
 
+    if ((opts & PdfSaveOptions::DeduplicateObjects) !=
+        PdfSaveOptions::None)
+    {
+        (void)DeduplicateObjects();
+    }
+
     // After we are done with all operations on objects,
     // we can collect garbage
     if ((opts & PdfSaveOptions::NoCollectGarbage) ==
@@ -257,6 +272,20 @@ void PdfMemDocument::beforeWrite(PdfSaveOptions opts)
     }
 }
 
+void PdfMemDocument::detachSource()
+{
+    for (auto obj : GetObjects())
+    {
+        auto parserObj = dynamic_cast<PdfParserObject*>(obj);
+        if (parserObj != nullptr)
+            parserObj->DetachSource();
+    }
+
+    auto trailer = dynamic_cast<PdfParserObject*>(&GetTrailer().GetObject());
+    if (trailer != nullptr)
+        trailer->DetachSource();
+}
+
 void PdfMemDocument::SetEncrypted(const string_view& userPassword, const string_view& ownerPassword,
     PdfPermissions protection, PdfEncryptionAlgorithm algorithm,
     PdfKeyLength keyLength)
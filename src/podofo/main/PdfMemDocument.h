@@ -34,6 +34,8 @@ class PdfEncryptSession;
 class PODOFO_API PdfMemDocument final : public PdfDocument
 {
     PODOFO_PRIVATE_FRIEND(class PdfWriter);
+    PODOFO_PRIVATE_FRIEND(class PdfSigningContext);
+    PODOFO_PRIVATE_FRIEND(class PdfPasswordAuthenticator);
 
 public:
     /// Construct a new PdfMemDocument
@@ -104,6 +106,9 @@ public:
     /// @see Save, SaveUpdate
     ///
     /// This is an overloaded member function for your convenience.
+    /// @remarks When saving over the file the document was loaded from,
+    /// all the objects are loaded in memory before truncating it, and
+    /// PdfSaveOptions::CopyUnmodifiedObjects has no effect
     void Save(const std::string_view& filename, PdfSaveOptions opts = PdfSaveOptions::None);
 
     /// Save the complete document to an output device
@@ -188,7 +193,8 @@ private:
     PdfMemDocument(bool empty);
 
 private:
-    void loadFromDevice(std::shared_ptr<InputStreamDevice>&& device, PdfLoadOptions opts, const std::string_view& password);
+    void loadFromDevice(std::shared_ptr<InputStreamDevice>&& device, PdfLoadOptions opts, const std::string_view& password,
+        const PdfAuthenticator* authenticator = nullptr);
 
     /// Internal method to load all objects from a PdfParser object.
     /// The objects will be removed from the parser and are now
@@ -202,6 +208,12 @@ private:
 
     void beforeWrite(PdfSaveOptions options);
 
+    /// Load all the objects, so they are not read from the source device anymore
+    void detachSource();
+
+    /// The device the document was loaded from, if any
+    InputStreamDevice* getDevice() const { return m_device.get(); }
+
 private:
     PdfMemDocument& operator=(const PdfMemDocument&) = delete;
 
@@ -23,6 +23,7 @@ namespace PoDoFo {
 class PODOFO_API PdfMemoryObjectStream final : public PdfObjectStreamProvider
 {
     friend class PdfObject;
+    friend class PdfObjectStream;
     friend class PdfIndirectObjectList;
     PODOFO_PRIVATE_FRIEND(class PdfImmediateWriter);
 
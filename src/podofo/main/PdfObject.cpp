@@ -270,6 +270,29 @@ void PdfObject::WriteFinal(OutputStream& stream, PdfWriteFlags writeMode, const
     ResetDirty();
 }
 
+void PdfObject::WriteFinal(OutputStream& stream, PdfWriteFlags writeMode,
+    const PdfStatefulEncrypt* encrypt, InputStream& rawStream,
+    size_t rawLength, charbuff& buffer)
+{
+    DelayedLoad();
+    if (m_IndirectReference.IsIndirect())
+        WriteHeader(stream, writeMode, buffer);
+
+    // Add the key without triggering SetDirty
+    m_Variant.GetDictionaryUnsafe().AddKeyNoDirtySet("Length"_n, PdfVariant(static_cast<int64_t>(rawLength)));
+    m_Variant.Write(stream, writeMode, encrypt, buffer);
+    stream.Write('\n');
+
+    stream.Write("stream\n");
+    rawStream.CopyTo(stream, rawLength);
+    stream.Write("\nendstream\n");
+
+    if (m_IndirectReference.IsIndirect())
+        stream.Write("endobj\n");
+
+    ResetDirty();
+}
+
 void PdfObject::write(OutputStream& stream, bool skipLengthFix,
     PdfWriteFlags writeMode, const PdfStatefulEncrypt* encrypt, charbuff& buffer) const
 {
@@ -43,6 +43,7 @@ class PODOFO_API PdfObject
     PODOFO_PRIVATE_FRIEND(class PdfObjectStreamParser);
     PODOFO_PRIVATE_FRIEND(class PdfParser);
     PODOFO_PRIVATE_FRIEND(class PdfParserObject);
+    PODOFO_PRIVATE_FRIEND(class PdfSigningContext);
     PODOFO_PRIVATE_FRIEND(class PdfWriter);
     PODOFO_PRIVATE_FRIEND(class PdfImmediateWriter);
     PODOFO_PRIVATE_FRIEND(class PdfXRef);
@@ -474,6 +475,12 @@ private:
     void WriteFinal(OutputStream& stream, PdfWriteFlags writeMode,
         const PdfStatefulEncrypt* encrypt, charbuff& buffer);
 
+    // To be called by PdfWriter. Write the object with the given
+    // already encoded and encrypted stream data
+    void WriteFinal(OutputStream& stream, PdfWriteFlags writeMode,
+        const PdfStatefulEncrypt* encrypt, InputStream& rawStream,
+        size_t rawLength, charbuff& buffer);
+
     // To be called by PdfStreamedObjectStream
     void SetNumberNoDirtySet(int64_t l);
 
@@ -6,6 +6,7 @@
 #include "PdfObjectStream.h"
 
 #include "PdfDocument.h"
+#include "PdfMemoryObjectStream.h"
 #include <podofo/auxiliary/InputDevice.h>
 #include <podofo/auxiliary/StreamDevice.h>
 
@@ -127,6 +128,7 @@ void PdfObjectStream::Unwrap()
 
         auto outputStream = objectStream.GetOutputStreamRaw();
         inputStream.CopyTo(outputStream);
+        outputStream.Close();
 
         // Handle left over media filters/decode parameters
         auto& dict = obj.GetDictionaryUnsafe();
@@ -378,12 +380,30 @@ void PdfObjectStream::setData(InputStream& stream, PdfFilterList filters,
         stream.CopyTo(output);
     else
         stream.CopyTo(output, (size_t)size);
+
+    output.Close();
 }
 
 void PdfObjectStream::InitData(InputStream& stream, size_t size, PdfFilterList&& filterList)
 {
     PdfObjectOutputStream output(*this);
     stream.CopyTo(output, size);
+    output.Close();
+    m_Filters = std::move(filterList);
+}
+
+void PdfObjectStream::InitData(charbuff&& buffer, PdfFilterList&& filterList)
+{
+    auto memoryStream = dynamic_cast<PdfMemoryObjectStream*>(m_Provider.get());
+    if (memoryStream == nullptr)
+    {
+        SpanStreamDevice input(buffer);
+        InitData(input, buffer.size(), std::move(filterList));
+        return;
+    }
+
+    ensureClosed();
+    memoryStream->m_buffer = std::move(buffer);
     m_Filters = std::move(filterList);
 }
 
@@ -435,18 +455,33 @@ PdfObjectOutputStream::PdfObjectOutputStream()
 
 PdfObjectOutputStream::~PdfObjectOutputStream()
 {
+    try
+    {
+        Close();
+    }
+    catch (PdfError& e)
+    {
+        PoDoFo::LogMessage(PdfLogSeverity::Error, "Error closing the stream output: {}", e.what());
+    }
+}
+
+void PdfObjectOutputStream::Close()
+{
+    if (m_stream == nullptr)
+        return;
+
     // NOTE: Dispose the actual output stream now, so
     // all data can be flushed before ending appending
     m_output = nullptr;
-    if (m_stream != nullptr)
-    {
-        // Unlock the stream
-        m_stream->m_locked = false;
+    auto stream = m_stream;
+    m_stream = nullptr;
 
-        auto document = m_stream->GetParent().GetDocument();
-        if (document != nullptr)
-            document->GetObjects().EndAppendStream(*m_stream);
-    }
+    // Unlock the stream
+    stream->m_locked = false;
+
+    auto document = stream->GetParent().GetDocument();
+    if (document != nullptr)
+        document->GetObjects().EndAppendStream(*stream);
 }
 
 PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectOutputStream&& rhs) noexcept
@@ -542,11 +577,13 @@ PdfObjectOutputStream::PdfObjectOutputStream(PdfObjectStream& stream,
 
 void PdfObjectOutputStream::writeBuffer(const char* buffer, size_t size)
 {
+    PODOFO_RAISE_LOGIC_IF(m_output == nullptr, "The output stream is closed");
     WriteBuffer(*m_output, buffer, size);
 }
 
 void PdfObjectOutputStream::flush()
 {
+    PODOFO_RAISE_LOGIC_IF(m_output == nullptr, "The output stream is closed");
     Flush(*m_output);
 }
 
@@ -48,6 +48,11 @@ public:
     PdfObjectOutputStream();
     ~PdfObjectOutputStream();
     PdfObjectOutputStream(PdfObjectOutputStream&& rhs) noexcept;
+
+    /// Flush all the data and end writing the stream. Errors are
+    /// raised, while they are only logged if the output stream is
+    /// disposed without closing it first
+    void Close();
 private:
     /// @param raw when true, ignore filters on the creation of the stream,
     ///      while still setting them on the object
@@ -204,6 +209,9 @@ private:
 
     void InitData(InputStream& stream, size_t len, PdfFilterList&& filterList);
 
+    /// Initialize the data moving the buffer, if the stream is held in memory
+    void InitData(charbuff&& buffer, PdfFilterList&& filterList);
+
     /// Copy data and non data fields from rhs
     void CopyFrom(const PdfObjectStream& rhs);
 
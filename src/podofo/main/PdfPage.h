@@ -20,6 +20,7 @@ namespace PoDoFo {
 class PdfDocument;
 class InputStream;
 class PdfPage;
+class PdfContentStreamCache;
 
 struct PODOFO_API PdfTextEntry final
 {
@@ -44,6 +45,10 @@ struct PODOFO_API PdfTextExtractParams final
 
     ///< A callback to early interrupt text extraction
     std::function<bool(const AbortCheckInfo& info)> AbortCheck = nullptr;
+
+    ///< An optional cache of Form XObjects contents, to be shared
+    /// when extracting text from multiple pages drawing the same forms
+    std::shared_ptr<PdfContentStreamCache> FormXObjectCache;
 };
 
 template <typename TField>
@@ -134,6 +139,7 @@ class PODOFO_API PdfPage final : public PdfDictionaryElement, public PdfCanvas
     PODOFO_PRIVATE_FRIEND(class PdfPageTest);
     friend class PdfPageCollection;
     friend class PdfDocument;
+    friend class PdfDetachedCanvas;
 
 private:
     /// Create a new PdfPage object.
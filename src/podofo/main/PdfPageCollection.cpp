@@ -285,6 +285,40 @@ PdfPage& PdfPageCollection::CreatePageAt(unsigned atIndex, PdfPageSize pageSize)
     return CreatePageAt(atIndex, PdfPage::CreateStandardPageSize(pageSize));
 }
 
+unique_ptr<PdfDetachedCanvas> PdfPageCollection::CreateDetachedCanvas(const nullable<Rect>& size_)
+{
+    FlattenStructure();
+    auto size = getActualRect(size_);
+    unique_ptr<PdfPage> page(new PdfPage(GetDocument(), size));
+    return unique_ptr<PdfDetachedCanvas>(new PdfDetachedCanvas(std::move(page)));
+}
+
+unique_ptr<PdfDetachedCanvas> PdfPageCollection::CreateDetachedCanvas(PdfPageSize pageSize)
+{
+    return CreateDetachedCanvas(PdfPage::CreateStandardPageSize(pageSize));
+}
+
+PdfPage& PdfPageCollection::AppendDetachedCanvas(PdfDetachedCanvas& canvas)
+{
+    return InsertDetachedCanvasAt(GetCount(), canvas);
+}
+
+PdfPage& PdfPageCollection::InsertDetachedCanvasAt(unsigned atIndex, PdfDetachedCanvas& canvas)
+{
+    if (&canvas.GetPage().GetDocument() != &GetDocument())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The canvas belongs to a different document");
+
+    FlattenStructure();
+    unsigned pageCount = this->GetCount();
+    if (atIndex > pageCount)
+        atIndex = pageCount;
+
+    auto page = canvas.TakePage();
+    auto& pageRef = *page;
+    insertPageAt(atIndex, std::move(page));
+    return pageRef;
+}
+
 void PdfPageCollection::CreatePagesAt(unsigned atIndex, unsigned count, const nullable<Rect>& size_)
 {
     FlattenStructure();
@@ -10,6 +10,7 @@
 #include "PdfElement.h"
 #include "PdfArray.h"
 #include "PdfPage.h"
+#include "PdfDetachedCanvas.h"
 
 namespace PoDoFo {
 
@@ -102,6 +103,23 @@ namespace PoDoFo {
         void CreatePagesAt(unsigned atIndex, unsigned count, const nullable<Rect>& size = nullptr);
         void CreatePagesAt(unsigned atIndex, unsigned count, PdfPageSize pageSize);
 
+        /// Creates a new page that is not yet inserted in the page tree
+        /// and returns a canvas to paint it, also from a separate thread
+        /// @param size a Rect specifying the size of the page (i.e the /MediaBox key) in PDF units
+        /// @remarks Creation must happen sequentially on the document thread
+        /// @see PdfDetachedCanvas
+        std::unique_ptr<PdfDetachedCanvas> CreateDetachedCanvas(const nullable<Rect>& size = nullptr);
+        std::unique_ptr<PdfDetachedCanvas> CreateDetachedCanvas(PdfPageSize pageSize);
+
+        /// Appends the page of a painted detached canvas to the page tree
+        /// @remarks All painters using the canvas must have finished drawing
+        /// @returns the appended page
+        PdfPage& AppendDetachedCanvas(PdfDetachedCanvas& canvas);
+
+        /// Inserts the page of a painted detached canvas at index atIndex
+        /// @returns the inserted page
+        PdfPage& InsertDetachedCanvasAt(unsigned atIndex, PdfDetachedCanvas& canvas);
+
         /// Appends another PdfDocument to this document.
         /// @param doc the document to append
         void AppendDocumentPages(const PdfDocument& doc);
@@ -198,6 +198,7 @@ void PdfPage::ExtractTextTo(vector<PdfTextEntry>& entries, const string_view& pa
     PdfContentReaderArgs args;
     // Images are not needed for text extraction
     args.Flags = PdfContentReaderFlags::SkipHandleNonFormXObjects | PdfContentReaderFlags::SkipFetchInlineImages;
+    args.FormXObjectCache = params.FormXObjectCache;
     PdfContentStreamReader reader(*this, args);
     PdfContent content;
     vector<double> lengths;
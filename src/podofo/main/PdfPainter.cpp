@@ -19,6 +19,10 @@
 using namespace std;
 using namespace PoDoFo;
 
+// Minimum TJ adjustment written for shaped text, in
+// thousandths of text space unit
+constexpr double ShapedTextDeltaThreshold = 0.001;
+
 static string expandTabs(const string_view& str, unsigned tabWidth, unsigned tabCount);
 
 PdfPainter::PdfPainter() :
@@ -333,11 +337,17 @@ void PdfPainter::DrawText(const string_view& str, double x, double y,
     checkStream();
     checkStatus(StatusDefault);
     checkFont();
+    auto lock = lockFont();
 
     // NOTE: Pre-resolve all throwable operations before emitting any stream operators
     auto& font = *m_StateStack.Current->TextState.Font;
     auto expStr = this->expandTabs(str);
-    auto encoded = font.GetEncoding().ConvertToEncoded(expStr);
+    charbuff encoded;
+    shared_ptr<const PdfShapedText> shaped;
+    if (m_TextShaping.has_value())
+        shaped = font.ShapeString(expStr, *m_TextShaping);
+    else
+        encoded = font.GetEncoding().ConvertToEncoded(expStr);
     tryAddResource(font.GetObject(), PdfResourceType::Font);
 
     vector<array<double, 4>> linesToDraw;
@@ -347,7 +357,7 @@ void PdfPainter::DrawText(const string_view& str, double x, double y,
     drawText(expStr, x, y,
         (style & PdfDrawTextStyle::Underline) != PdfDrawTextStyle::Regular,
         (style & PdfDrawTextStyle::StrikeThrough) != PdfDrawTextStyle::Regular, linesToDraw,
-        encoded);
+        encoded, shaped.get());
     PoDoFo::WriteOperator_ET(m_stream);
     drawLines(linesToDraw);
     restore();
@@ -355,7 +365,7 @@ void PdfPainter::DrawText(const string_view& str, double x, double y,
 
 void PdfPainter::drawText(const string_view& str, double x, double y,
     bool isUnderline, bool isStrikeThrough, vector<array<double, 4>>& linesToDraw,
-    string_view encoded)
+    string_view encoded, const PdfShapedText* shaped)
 {
     auto& textState = m_StateStack.Current->TextState;
     auto& font = *textState.Font;
@@ -363,13 +373,17 @@ void PdfPainter::drawText(const string_view& str, double x, double y,
 
     if (isUnderline || isStrikeThrough)
     {
+        double length = shaped == nullptr
+            ? font.GetStringLength(expStr, textState)
+            : font.getShapedTextLength(*shaped, textState);
+
         // Draw underline
         this->setLineWidth(font.GetUnderlineThickness(textState));
         if (isUnderline)
         {
             linesToDraw.push_back({ x,
                 y + font.GetUnderlinePosition(textState),
-                x + font.GetStringLength(expStr, textState),
+                x + length,
                 y + font.GetUnderlinePosition(textState)
             });
         }
@@ -379,7 +393,7 @@ void PdfPainter::drawText(const string_view& str, double x, double y,
         {
             linesToDraw.push_back({ x,
                 y + font.GetStrikeThroughPosition(textState),
-                x + font.GetStringLength(expStr, textState),
+                x + length,
                 y + font.GetStrikeThroughPosition(textState)
             });
         }
@@ -387,8 +401,77 @@ void PdfPainter::drawText(const string_view& str, double x, double y,
 
     PoDoFo::WriteOperator_Td(m_stream, x, y);
 
-    PoDoFo::WriteOperator_Tj(m_stream, encoded,
-        !font.GetEncoding().IsSimpleEncoding());
+    if (shaped == nullptr)
+    {
+        PoDoFo::WriteOperator_Tj(m_stream, encoded,
+            !font.GetEncoding().IsSimpleEncoding());
+    }
+    else
+    {
+        writeShapedText(*shaped);
+    }
+}
+
+void PdfPainter::writeShapedText(const PdfShapedText& shaped)
+{
+    auto& textState = m_StateStack.Current->TextState;
+    auto& font = *textState.Font;
+    auto& metrics = font.GetMetrics();
+    bool hex = !font.GetEncoding().IsSimpleEncoding();
+
+    // Track, in thousandths of text space unit, the pen position
+    // of the shaped text and the one where the PDF viewer will
+    // place the next glyph, which advances by the glyph width.
+    // The difference is written as a TJ adjustment. Vertical
+    // offsets are written as a text rise, splitting the TJ array
+    double pen = 0;
+    double pdfPen = 0;
+    double rise = 0;
+    bool arrayOpen = false;
+    charbuff encoded;
+    for (auto& glyph : shaped.Glyphs)
+    {
+        if (glyph.OffsetY != rise)
+        {
+            if (arrayOpen)
+            {
+                PoDoFo::WriteOperator_TJ_End(m_stream);
+                arrayOpen = false;
+            }
+
+            rise = glyph.OffsetY;
+            PoDoFo::WriteOperator_Ts(m_stream, rise * textState.FontSize / 1000);
+        }
+
+        if (!arrayOpen)
+        {
+            PoDoFo::WriteOperator_TJ_Begin(m_stream);
+            arrayOpen = true;
+        }
+
+        double delta = pdfPen - (pen + glyph.OffsetX);
+        if (std::abs(delta) >= ShapedTextDeltaThreshold)
+            PoDoFo::WriteOperator_TJ_Delta(m_stream, delta);
+
+        encoded.clear();
+        glyph.Code.AppendTo(encoded);
+        PoDoFo::WriteOperator_TJ_String(m_stream, encoded, hex);
+        pdfPen = pen + glyph.OffsetX + metrics.GetGlyphWidth(glyph.GID) * 1000;
+        pen += glyph.Advance;
+    }
+
+    if (arrayOpen)
+    {
+        // Move the pen at the end of the shaped text
+        double delta = pdfPen - pen;
+        if (std::abs(delta) >= ShapedTextDeltaThreshold)
+            PoDoFo::WriteOperator_TJ_Delta(m_stream, delta);
+
+        PoDoFo::WriteOperator_TJ_End(m_stream);
+    }
+
+    if (rise != 0)
+        PoDoFo::WriteOperator_Ts(m_stream, 0);
 }
 
 void PdfPainter::DrawTextMultiLine(const string_view& str, const Rect& rect,
@@ -407,6 +490,8 @@ void PdfPainter::DrawTextMultiLine(const string_view& str, double x, double y, d
     if (width <= 0 || height <= 0) // nonsense arguments
         return;
 
+    auto lock = lockFont();
+
     drawMultiLineText(str, x, y, width, height,
         params.HorizontalAlignment, params.VerticalAlignment,
         params.SkipClip, params.PreserveTrailingSpaces, params.Style);
@@ -421,6 +506,7 @@ void PdfPainter::DrawTextAligned(const string_view& str, double x, double y, dou
     checkStream();
     checkStatus(StatusDefault | StatusTextObject);
     checkFont();
+    auto lock = lockFont();
 
     // NOTE: Pre-resolve all throwable operations before emitting any stream operators
     auto& font = *m_StateStack.Current->TextState.Font;
@@ -681,12 +767,37 @@ void PdfPainter::AddText(const string_view& str)
     checkStream();
     checkStatus(StatusTextObject);
     checkFont();
+    auto lock = lockFont();
     auto expStr = this->expandTabs(str);
     auto& font = *m_StateStack.Current->TextState.Font;
     // NOTE: Pre-resolve throwable operations before emitting any stream operators
-    auto encoded = font.GetEncoding().ConvertToEncoded(expStr);
-    PoDoFo::WriteOperator_Tj(m_stream, encoded,
-        !font.GetEncoding().IsSimpleEncoding());
+    if (m_TextShaping.has_value())
+    {
+        auto shaped = font.ShapeString(expStr, *m_TextShaping);
+        writeShapedText(*shaped);
+    }
+    else
+    {
+        auto encoded = font.GetEncoding().ConvertToEncoded(expStr);
+        PoDoFo::WriteOperator_Tj(m_stream, encoded,
+            !font.GetEncoding().IsSimpleEncoding());
+    }
+}
+
+void PdfPainter::SetTextShaping(nullable<const PdfTextShapingParams&> params)
+{
+    if (params.has_value())
+        m_TextShaping = *params;
+    else
+        m_TextShaping = nullptr;
+}
+
+nullable<const PdfTextShapingParams&> PdfPainter::GetTextShaping() const
+{
+    if (m_TextShaping.has_value())
+        return *m_TextShaping;
+    else
+        return { };
 }
 
 void PdfPainter::EndText()
@@ -1103,6 +1214,13 @@ void PdfPainter::checkFont() const
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Font should be set prior calling the method");
 }
 
+unique_lock<recursive_mutex> PdfPainter::lockFont() const
+{
+    // Encoding text may update the font subset and dynamic
+    // encoding maps, which can be shared with other painters
+    return unique_lock<recursive_mutex>(m_StateStack.Current->TextState.Font->m_drawMutex);
+}
+
 void PdfPainter::checkStatus(int expectedStatus)
 {
     if ((expectedStatus & m_painterStatus) == 0)
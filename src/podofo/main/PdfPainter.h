@@ -14,12 +14,15 @@
 #include "PdfPattern.h"
 #include "PdfContentStreamOperators.h"
 
+#include <mutex>
+
 #include <podofo/auxiliary/StateStack.h>
 
 namespace PoDoFo {
 
 class PdfExtGState;
 class PdfFont;
+struct PdfShapedText;
 class PdfImage;
 class PdfObjectStream;
 class PdfXObject;
@@ -461,6 +464,17 @@ public:
     /// @see TabWidth
     inline unsigned short GetTabWidth() const { return m_TabWidth; }
 
+    /// Set the params to shape text drawn with DrawText and
+    /// TextObject.AddText, or null to disable text shaping.
+    /// Shaped text is written with TJ operators positioning
+    /// the glyphs. Default is null
+    /// @remarks Requires PoDoFo built with HarfBuzz
+    /// @see PdfFont::ShapeString
+    void SetTextShaping(nullable<const PdfTextShapingParams&> params);
+
+    /// Get the params used to shape text, if any
+    nullable<const PdfTextShapingParams&> GetTextShaping() const;
+
     /// Return the current page that is that on the painter.
     ///
     /// @returns the current page of the painter or nullptr if none is set
@@ -618,7 +632,9 @@ private:
 
     void drawText(const std::string_view& str, double x, double y,
         bool isUnderline, bool isStrikeThrough, std::vector<std::array<double, 4>>& linesToDraw,
-        std::string_view encoded);
+        std::string_view encoded, const PdfShapedText* shaped = nullptr);
+
+    void writeShapedText(const PdfShapedText& shaped);
 
     void drawMultiLineText(const std::string_view& str, double x, double y, double width, double height,
         PdfHorizontalAlignment hAlignment, PdfVerticalAlignment vAlignment, bool skipClip, bool preserveTrailingSpaces,
@@ -639,6 +655,7 @@ private:
     void resetPath();
     void checkPathOpened() const;
     void checkFont() const;
+    std::unique_lock<std::recursive_mutex> lockFont() const;
     void finishDrawing();
     void checkStatus(int expectedStatus);
     void enterTextObject();
@@ -679,6 +696,8 @@ private:
     /// spaces before drawing text. Default is a value of 4
     unsigned short m_TabWidth;
 
+    nullable<PdfTextShapingParams> m_TextShaping;
+
     /// temporary stream buffer
     PdfStringStream m_stream;
 
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfPasswordAuthenticator.h"
+#include <podofo/private/WorkerPool.h>
+#include <podofo/private/OpenSSLInternal.h>
+#include <podofo/private/LruCache.h>
+#include "PdfMemDocument.h"
+
+#include <atomic>
+
+using namespace std;
+using namespace PoDoFo;
+
+// Enough for the documents of a batch session, while bounding the memory
+static constexpr unsigned MaxCacheSize = 64;
+
+static charbuff computePasswordHash(const string_view& password);
+static charbuff computePasswordsHash(const cspan<string_view>& passwords, unsigned count);
+
+struct PdfPasswordAuthenticator::PasswordCache
+{
+    struct Entry
+    {
+        charbuff PasswordHash;
+        unsigned PasswordIndex = 0;
+        charbuff PrecedingPasswordsHash;
+    };
+
+    mutex Mutex;
+    // Document ID -> SHA-256 of the password and of the candidates preceding it
+    LruCache<Entry> Entries{ MaxCacheSize };
+};
+
+PdfPasswordAuthenticator::PdfPasswordAuthenticator()
+    : m_cache(new PasswordCache()) { }
+
+PdfPasswordAuthenticator::~PdfPasswordAuthenticator() { }
+
+bool PdfPasswordAuthenticator::TryAuthenticate(const PdfEncrypt& encrypt, const PdfString& documentId,
+    const cspan<string_view>& passwords, PdfEncryptContext& context, unsigned& passwordIndex) const
+{
+    // NOTE: Documents with no /ID are legitimate with the AESV3
+    // security handlers, but they can't be told apart in the cache
+    string cacheKey(documentId.GetRawData());
+    unsigned candidateCount = (unsigned)passwords.size();
+    unsigned cachedIndex = (unsigned)passwords.size();
+    if (!cacheKey.empty())
+    {
+        charbuff cachedHash;
+        charbuff cachedPrecedingHash;
+        unsigned i = 0;
+        {
+            unique_lock<mutex> lock(m_cache->Mutex);
+            auto found = m_cache->Entries.Find(cacheKey);
+            if (found != nullptr)
+            {
+                cachedHash = found->PasswordHash;
+                cachedPrecedingHash = found->PrecedingPasswordsHash;
+                i = found->PasswordIndex;
+            }
+        }
+
+        // Look for the cached password first at its previous position
+        bool samePosition = i < passwords.size() && computePasswordHash(passwords[i]) == cachedHash;
+        if (cachedHash.size() != 0 && !samePosition)
+        {
+            for (i = 0; i < passwords.size(); i++)
+            {
+                if (computePasswordHash(passwords[i]) == cachedHash)
+                    break;
+            }
+        }
+
+        if (i < passwords.size() && cachedHash.size() != 0)
+        {
+            // If the cached password still authenticates, only the
+            // candidates preceding it are left to try. They are known
+            // to fail already if they didn't change since the last time
+            PdfEncryptContext cachedContext;
+            encrypt.Authenticate(passwords[i], documentId, cachedContext);
+            if (cachedContext.IsAuthenticated())
+            {
+                context = cachedContext;
+                cachedIndex = i;
+                if (samePosition && computePasswordsHash(passwords, i) == cachedPrecedingHash)
+                    candidateCount = 0;
+                else
+                    candidateCount = i;
+            }
+        }
+    }
+
+    // Jobs are dispatched in index order, so skipping the candidates
+    // that follow the best match still finds the first match
+    mutex resultMutex;
+    atomic<unsigned> bestIndex(cachedIndex);
+    RunParallelJobs(candidateCount, [&](unsigned index)
+    {
+        if (index > bestIndex)
+            return;
+
+        PdfEncryptContext jobContext;
+        encrypt.Authenticate(passwords[index], documentId, jobContext);
+        if (!jobContext.IsAuthenticated())
+            return;
+
+        unique_lock<mutex> lock(resultMutex);
+        if (index < bestIndex)
+        {
+            bestIndex = index;
+            context = jobContext;
+        }
+    });
+
+    if (bestIndex == passwords.size())
+        return false;
+
+    passwordIndex = bestIndex;
+    if (!cacheKey.empty())
+    {
+        PasswordCache::Entry entry;
+        entry.PasswordHash = computePasswordHash(passwords[passwordIndex]);
+        entry.PasswordIndex = passwordIndex;
+        entry.PrecedingPasswordsHash = computePasswordsHash(passwords, passwordIndex);
+        unique_lock<mutex> lock(m_cache->Mutex);
+        (void)m_cache->Entries.Set(cacheKey, std::move(entry));
+    }
+
+    return true;
+}
+
+bool PdfPasswordAuthenticator::TryLoad(PdfMemDocument& doc, const shared_ptr<InputStreamDevice>& device,
+    const cspan<string_view>& passwords, int& passwordIndex, PdfLoadOptions opts) const
+{
+    if (device == nullptr)
+        PODOFO_RAISE_ERROR(PdfErrorCode::InvalidHandle);
+
+    // The candidates are tried while parsing, only if the document
+    // can't be read with no password. Parsing with no probing first
+    // also keeps the cross reference recovery of the normal loading
+    bool authenticating = false;
+    unsigned index = numeric_limits<unsigned>::max();
+    PdfAuthenticator authenticator = [&](const PdfEncrypt& encrypt, const PdfString& documentId,
+        PdfEncryptContext& context)
+    {
+        authenticating = true;
+        return TryAuthenticate(encrypt, documentId, passwords, context, index);
+    };
+
+    try
+    {
+        doc.loadFromDevice(shared_ptr<InputStreamDevice>(device), opts, { }, &authenticator);
+    }
+    catch (PdfError& e)
+    {
+        if (e.GetCode() == PdfErrorCode::InvalidPassword && authenticating)
+            return false;
+
+        throw;
+    }
+
+    passwordIndex = index == numeric_limits<unsigned>::max() ? -1 : (int)index;
+    return true;
+}
+
+void PdfPasswordAuthenticator::ClearCache()
+{
+    unique_lock<mutex> lock(m_cache->Mutex);
+    m_cache->Entries.Clear();
+}
+
+charbuff computePasswordHash(const string_view& password)
+{
+    return ssl::ComputeHash(password, PdfHashingAlgorithm::SHA256);
+}
+
+charbuff computePasswordsHash(const cspan<string_view>& passwords, unsigned count)
+{
+    // Prefix every password with its length, so
+    // different lists can't produce the same data
+    charbuff data;
+    for (unsigned i = 0; i < count; i++)
+    {
+        uint32_t length = (uint32_t)passwords[i].length();
+        data.append((const char*)&length, sizeof(length));
+        data.append(passwords[i]);
+    }
+
+    return ssl::ComputeHash(data, PdfHashingAlgorithm::SHA256);
+}
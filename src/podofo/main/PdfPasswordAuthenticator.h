@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_PASSWORD_AUTHENTICATOR_H
+#define PDF_PASSWORD_AUTHENTICATOR_H
+
+#include "PdfDeclarations.h"
+
+namespace PoDoFo
+{
+    class InputStreamDevice;
+    class PdfEncrypt;
+    class PdfEncryptContext;
+    class PdfMemDocument;
+    class PdfString;
+
+    /// Authenticates encrypted documents trying a list of candidate
+    /// passwords. The candidates are tested concurrently on a pool of
+    /// worker threads, which pays off with the costly key derivation of
+    /// the AESV3 security handlers. The key of every candidate is still
+    /// derived on its own: there's no multi-buffer SHA-2 implementation
+    /// hashing several candidates in lockstep
+    /// @remarks TryAuthenticate() and TryLoad() can be called concurrently.
+    /// The SHA-256 digests of the passwords that successfully authenticated
+    /// the most recent documents are cached by document ID, together with
+    /// their position in the candidate list. When the candidates preceding
+    /// the cached password didn't change, only the cached password is tried.
+    /// Otherwise, when the cached password is still a candidate, only the
+    /// candidates preceding it are tried, so the first matching candidate
+    /// is still the one reported
+    class PODOFO_API PdfPasswordAuthenticator final
+    {
+    public:
+        PdfPasswordAuthenticator();
+        ~PdfPasswordAuthenticator();
+
+    public:
+        /// Try to authenticate either the user or the owner with the candidate passwords
+        /// @param encrypt the encryption of the document
+        /// @param documentId the first element of the /ID array in the document trailer
+        /// @param passwords the candidate passwords
+        /// @param context the encryption context, filled with the authentication
+        /// result of the first matching candidate. It's left untouched if none matches
+        /// @param passwordIndex the index of the first matching candidate
+        /// @returns true if one of the candidates matches
+        bool TryAuthenticate(const PdfEncrypt& encrypt, const PdfString& documentId,
+            const cspan<std::string_view>& passwords, PdfEncryptContext& context,
+            unsigned& passwordIndex) const;
+
+        /// Load the document from the device, trying the candidate
+        /// passwords if the document is encrypted
+        /// @param passwordIndex the index of the matching candidate,
+        /// or -1 if no password is required to read the document
+        /// @returns false if the document is encrypted and none of the candidates matches
+        bool TryLoad(PdfMemDocument& doc, const std::shared_ptr<InputStreamDevice>& device,
+            const cspan<std::string_view>& passwords, int& passwordIndex,
+            PdfLoadOptions opts = PdfLoadOptions::None) const;
+
+        /// Clear the cached passwords
+        void ClearCache();
+
+    private:
+        PdfPasswordAuthenticator(const PdfPasswordAuthenticator&) = delete;
+        PdfPasswordAuthenticator& operator=(const PdfPasswordAuthenticator&) = delete;
+
+    private:
+        struct PasswordCache;
+
+    private:
+        std::unique_ptr<PasswordCache> m_cache;
+    };
+}
+
+#endif // PDF_PASSWORD_AUTHENTICATOR_H
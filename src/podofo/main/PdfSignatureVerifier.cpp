@@ -0,0 +1,452 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include <podofo/private/PdfDeclarationsPrivate.h>
+#include "PdfSignatureVerifier.h"
+#include <podofo/private/OpenSSLInternal.h>
+#include <podofo/private/WorkerPool.h>
+#include <podofo/private/LruCache.h>
+#include "PdfMemDocument.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+constexpr size_t BufferSize = 65536;
+
+// Enough for the signers of a batch session, while bounding the memory
+constexpr unsigned MaxChainCacheSize = 256;
+
+namespace
+{
+    /// <summary>
+    /// A signature being verified, with the state of the digest of its signed data
+    /// </summary>
+    struct SignatureEntry
+    {
+        size_t ResultIndex = 0;
+        size_t Range[4] = { };
+        unique_ptr<CMS_ContentInfo, decltype(&CMS_ContentInfo_free)> Cms{ nullptr, CMS_ContentInfo_free };
+        CMS_SignerInfo* Signer = nullptr;
+        X509* SignerCert = nullptr;
+        unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> Digest{ nullptr, EVP_MD_CTX_free };
+    };
+}
+
+static bool tryPrepareEntry(const PdfDictionary& value, size_t length, SignatureEntry& entry,
+    PdfSignatureVerificationResult& result);
+static void appendRangeData(SignatureEntry& entry, size_t pos, const char* buffer, size_t size);
+static void getValidityWindow(X509_STORE_CTX* ctx, X509* signerCert, time_t& notBefore, time_t& notAfter);
+static time_t getTime(const ASN1_TIME* time, time_t now);
+static void setFailure(PdfSignatureVerificationResult& result, PdfSignatureVerificationStatus status,
+    const string_view& error, bool appendOpenSSLError = false);
+
+struct PdfSignatureVerifier::ChainCache
+{
+    struct Entry
+    {
+        int Error = X509_V_OK;
+        // The window of verification times where the result holds
+        time_t NotBefore = 0;
+        time_t NotAfter = 0;
+    };
+
+    mutex Mutex;
+    // Certificate chain digest -> X.509 verification result
+    LruCache<Entry> Entries{ MaxChainCacheSize };
+};
+
+PdfSignatureVerifier::PdfSignatureVerifier()
+    : m_store(X509_STORE_new()), m_chainCache(new ChainCache())
+{
+    if (m_store == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OutOfMemory, "X509_STORE_new");
+
+    // Trusted certificates are trust anchors, even if not self-signed
+    X509_STORE_set_flags(m_store, X509_V_FLAG_PARTIAL_CHAIN);
+}
+
+PdfSignatureVerifier::~PdfSignatureVerifier()
+{
+    X509_STORE_free(m_store);
+}
+
+void PdfSignatureVerifier::AddTrustedCertificates(const bufferview& certs)
+{
+    auto in = (const unsigned char*)certs.data();
+    unique_ptr<X509, decltype(&X509_free)> cert(d2i_X509(nullptr, &in, (int)certs.size()), X509_free);
+    if (cert != nullptr)
+    {
+        if (X509_STORE_add_cert(m_store, cert.get()) != 1)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "X509_STORE_add_cert");
+    }
+    else
+    {
+        unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new_mem_buf(certs.data(), (int)certs.size()), BIO_free);
+        if (bio == nullptr)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OutOfMemory, "BIO_new_mem_buf");
+
+        unsigned count = 0;
+        while (true)
+        {
+            cert.reset(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+            if (cert == nullptr)
+                break;
+
+            if (X509_STORE_add_cert(m_store, cert.get()) != 1)
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "X509_STORE_add_cert");
+
+            count++;
+        }
+
+        // Clear the expected end of file error
+        ERR_clear_error();
+        if (count == 0)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidInput, "No certificate could be loaded");
+    }
+
+    ClearCache();
+}
+
+vector<PdfSignatureVerificationResult> PdfSignatureVerifier::Verify(const shared_ptr<InputStreamDevice>& device,
+    nullable<time_t> verificationTime) const
+{
+    if (device == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The input device must be not null");
+
+    time_t now = verificationTime.has_value() ? *verificationTime : time(nullptr);
+    PdfMemDocument doc;
+    doc.Load(device);
+    size_t length = device->GetLength();
+
+    vector<PdfSignatureVerificationResult> results;
+    vector<SignatureEntry> entries;
+    size_t dataEnd = 0;
+    for (auto field : doc.GetFieldsIterator())
+    {
+        const PdfDictionary* value;
+        auto valueObj = field->GetDictionary().FindKey("V");
+        if (field->GetType() != PdfFieldType::Signature
+            || valueObj == nullptr || !valueObj->TryGetDictionary(value))
+        {
+            // Not a signed signature field
+            continue;
+        }
+
+        auto& result = results.emplace_back();
+        result.FieldName = field->GetFullName();
+        SignatureEntry entry;
+        entry.ResultIndex = results.size() - 1;
+        if (!tryPrepareEntry(*value, length, entry, result))
+            continue;
+
+        dataEnd = std::max(dataEnd, entry.Range[2] + entry.Range[3]);
+        entries.push_back(std::move(entry));
+    }
+
+    if (entries.size() == 0)
+        return results;
+
+    // Digest the signed data of all the signatures in a single pass
+    charbuff buffer(BufferSize);
+    device->Seek(0);
+    size_t pos = 0;
+    while (pos < dataEnd)
+    {
+        size_t readSize = std::min(BufferSize, dataEnd - pos);
+        device->Read(buffer.data(), readSize);
+
+        for (auto& entry : entries)
+            appendRangeData(entry, pos, buffer.data(), readSize);
+
+        pos += readSize;
+    }
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned digestSize;
+    for (auto& entry : entries)
+    {
+        auto& result = results[entry.ResultIndex];
+        if (EVP_DigestFinal_ex(entry.Digest.get(), digest, &digestSize) != 1)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "EVP_DigestFinal_ex");
+
+        auto messageDigest = (ASN1_OCTET_STRING*)CMS_signed_get0_data_by_OBJ(entry.Signer,
+            OBJ_nid2obj(NID_pkcs9_messageDigest), -3, V_ASN1_OCTET_STRING);
+        if (messageDigest == nullptr)
+        {
+            setFailure(result, PdfSignatureVerificationStatus::Malformed, "Missing the message digest attribute");
+            continue;
+        }
+
+        if ((unsigned)ASN1_STRING_length(messageDigest) != digestSize
+            || std::memcmp(ASN1_STRING_get0_data(messageDigest), digest, digestSize) != 0)
+        {
+            setFailure(result, PdfSignatureVerificationStatus::Modified, "The signed data digest doesn't match");
+            continue;
+        }
+
+        if (CMS_SignerInfo_verify(entry.Signer) != 1)
+        {
+            setFailure(result, PdfSignatureVerificationStatus::Invalid, "The signature verification failed", true);
+            continue;
+        }
+
+        unique_ptr<STACK_OF(X509), void(*)(STACK_OF(X509)*)> certs(CMS_get1_certs(entry.Cms.get()),
+            [](STACK_OF(X509)* certs) { sk_X509_pop_free(certs, X509_free); });
+
+        // The chain is identified by the digest of the signer
+        // certificate followed by all the included certificates
+        charbuff chain = ssl::GetEncoded(entry.SignerCert);
+        for (int i = 0, count = certs == nullptr ? 0 : sk_X509_num(certs.get()); i < count; i++)
+            chain.append(ssl::GetEncoded(sk_X509_value(certs.get(), i)));
+
+        int error = validateChain(ssl::ComputeHash(chain, PdfHashingAlgorithm::SHA256), now,
+            [&](time_t& notBefore, time_t& notAfter) {
+            unique_ptr<X509_STORE_CTX, decltype(&X509_STORE_CTX_free)> ctx(X509_STORE_CTX_new(), X509_STORE_CTX_free);
+            if (ctx == nullptr || X509_STORE_CTX_init(ctx.get(), m_store, entry.SignerCert, certs.get()) != 1)
+                PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "X509_STORE_CTX_init");
+
+            X509_STORE_CTX_set_time(ctx.get(), 0, now);
+            int verified = X509_verify_cert(ctx.get());
+            getValidityWindow(ctx.get(), entry.SignerCert, notBefore, notAfter);
+            if (verified == 1)
+                return (int)X509_V_OK;
+
+            int ret = X509_STORE_CTX_get_error(ctx.get());
+            return ret == X509_V_OK ? (int)X509_V_ERR_UNSPECIFIED : ret;
+        });
+
+        if (error != X509_V_OK)
+        {
+            setFailure(result, PdfSignatureVerificationStatus::Untrusted, X509_verify_cert_error_string(error));
+            continue;
+        }
+
+        result.Status = PdfSignatureVerificationStatus::Valid;
+    }
+
+    return results;
+}
+
+void PdfSignatureVerifier::Verify(const cspan<shared_ptr<InputStreamDevice>>& devices,
+    vector<vector<PdfSignatureVerificationResult>>& results, nullable<time_t> verificationTime) const
+{
+    results.clear();
+    results.resize(devices.size());
+    RunParallelJobs((unsigned)devices.size(), [&](unsigned index)
+    {
+        try
+        {
+            results[index] = Verify(devices[index], verificationTime);
+        }
+        catch (PdfError& e)
+        {
+            results[index].clear();
+            auto& result = results[index].emplace_back();
+            setFailure(result, PdfSignatureVerificationStatus::Malformed, e.what());
+        }
+    });
+}
+
+void PdfSignatureVerifier::ClearCache()
+{
+    unique_lock<mutex> lock(m_chainCache->Mutex);
+    m_chainCache->Entries.Clear();
+}
+
+int PdfSignatureVerifier::validateChain(const string& chainKey, time_t verificationTime,
+    const function<int(time_t& notBefore, time_t& notAfter)>& validate) const
+{
+    {
+        // The validation is checked against the verification time, so
+        // a cached result is stale outside the window where it holds
+        unique_lock<mutex> lock(m_chainCache->Mutex);
+        auto found = m_chainCache->Entries.Find(chainKey);
+        if (found != nullptr && verificationTime >= found->NotBefore && verificationTime <= found->NotAfter)
+            return found->Error;
+    }
+
+    // NOTE: Validate outside the lock. Concurrent
+    // validations of the same chain are harmless
+    ChainCache::Entry entry;
+    entry.Error = validate(entry.NotBefore, entry.NotAfter);
+
+    // Before or after the validity window of the chain, the
+    // result holds until or since the window boundary
+    if (verificationTime < entry.NotBefore)
+    {
+        entry.NotAfter = entry.NotBefore - 1;
+        entry.NotBefore = numeric_limits<time_t>::min();
+    }
+    else if (verificationTime > entry.NotAfter)
+    {
+        entry.NotBefore = entry.NotAfter + 1;
+        entry.NotAfter = numeric_limits<time_t>::max();
+    }
+
+    int error = entry.Error;
+    unique_lock<mutex> lock(m_chainCache->Mutex);
+    (void)m_chainCache->Entries.Set(chainKey, std::move(entry));
+    return error;
+}
+
+// Compute the intersection of the validity periods of the certificates
+// of the verified chain, or just of the signer one if no chain was built
+void getValidityWindow(X509_STORE_CTX* ctx, X509* signerCert, time_t& notBefore, time_t& notAfter)
+{
+    time_t now = time(nullptr);
+    notBefore = numeric_limits<time_t>::min();
+    notAfter = numeric_limits<time_t>::max();
+    auto chain = X509_STORE_CTX_get0_chain(ctx);
+    int count = chain == nullptr ? 0 : sk_X509_num(chain);
+    for (int i = 0; i < std::max(count, 1); i++)
+    {
+        X509* cert = count == 0 ? signerCert : sk_X509_value(chain, i);
+        notBefore = std::max(notBefore, getTime(X509_get0_notBefore(cert), now));
+        notAfter = std::min(notAfter, getTime(X509_get0_notAfter(cert), now));
+    }
+}
+
+// Convert the time by its distance from now, which
+// avoids the platform specific UTC time conversions
+time_t getTime(const ASN1_TIME* time, time_t now)
+{
+    int days;
+    int seconds;
+    if (time == nullptr || ASN1_TIME_diff(&days, &seconds, nullptr, time) != 1)
+    {
+        // Malformed times can't define a window: bound it to the current time
+        return now;
+    }
+
+    return now + (time_t)days * 86400 + seconds;
+}
+
+bool tryPrepareEntry(const PdfDictionary& value, size_t length, SignatureEntry& entry,
+    PdfSignatureVerificationResult& result)
+{
+    auto subFilter = value.FindKeyAsSafe<PdfName>("SubFilter");
+    if (subFilter != "adbe.pkcs7.detached" && subFilter != "ETSI.CAdES.detached")
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Unsupported,
+            utls::Format("Unsupported signature sub filter \"{}\"", subFilter.GetString()));
+        return false;
+    }
+
+    auto byteRangeObj = value.FindKey("ByteRange");
+    const PdfArray* byteRange;
+    if (byteRangeObj == nullptr || !byteRangeObj->TryGetArray(byteRange) || byteRange->size() != 4)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Malformed, "Invalid /ByteRange");
+        return false;
+    }
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        int64_t num;
+        if (!(*byteRange)[i].TryGetNumber(num) || num < 0)
+        {
+            setFailure(result, PdfSignatureVerificationStatus::Malformed, "Invalid /ByteRange");
+            return false;
+        }
+
+        entry.Range[i] = (size_t)num;
+    }
+
+    // The ranges must be ordered and contained in the document
+    if (entry.Range[0] + entry.Range[1] > entry.Range[2] || entry.Range[2] + entry.Range[3] > length)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Malformed, "Invalid /ByteRange");
+        return false;
+    }
+
+    result.RevisionLength = entry.Range[2] + entry.Range[3];
+    result.CoversWholeDocument = entry.Range[0] == 0 && result.RevisionLength == length;
+
+    auto contentsObj = value.FindKey("Contents");
+    const PdfString* contents;
+    if (contentsObj == nullptr || !contentsObj->TryGetString(contents))
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Malformed, "Missing /Contents");
+        return false;
+    }
+
+    // NOTE: The /Contents is padded with zeroes, that are ignored when decoding
+    auto data = contents->GetRawData();
+    auto in = (const unsigned char*)data.data();
+    entry.Cms.reset(d2i_CMS_ContentInfo(nullptr, &in, (long)data.size()));
+    if (entry.Cms == nullptr)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Malformed, "Invalid CMS structure", true);
+        return false;
+    }
+
+    auto signers = CMS_get0_SignerInfos(entry.Cms.get());
+    if (signers == nullptr || sk_CMS_SignerInfo_num(signers) != 1)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Unsupported, "Only CMS structures with a single signer are supported");
+        return false;
+    }
+
+    entry.Signer = sk_CMS_SignerInfo_value(signers, 0);
+    if (CMS_signed_get_attr_count(entry.Signer) <= 0)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Unsupported, "Signatures without signed attributes are not supported");
+        return false;
+    }
+
+    // Match the signer with the certificates included in the CMS structure
+    (void)CMS_set1_signers_certs(entry.Cms.get(), nullptr, 0);
+    X509_ALGOR* digestAlgor;
+    CMS_SignerInfo_get0_algs(entry.Signer, nullptr, &entry.SignerCert, &digestAlgor, nullptr);
+    ERR_clear_error();
+    if (entry.SignerCert == nullptr)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Malformed, "The signer certificate is missing");
+        return false;
+    }
+
+    result.SignerCertificate = ssl::GetEncoded(entry.SignerCert);
+
+    const ASN1_OBJECT* digestObj;
+    X509_ALGOR_get0(&digestObj, nullptr, nullptr, digestAlgor);
+    auto md = EVP_get_digestbyobj(digestObj);
+    if (md == nullptr)
+    {
+        setFailure(result, PdfSignatureVerificationStatus::Unsupported, "Unsupported digest algorithm");
+        return false;
+    }
+
+    entry.Digest.reset(EVP_MD_CTX_new());
+    if (entry.Digest == nullptr || EVP_DigestInit_ex(entry.Digest.get(), md, nullptr) != 1)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "EVP_DigestInit_ex");
+
+    return true;
+}
+
+// Append to the digest the part of the buffer, starting
+// at the given device position, that lies in the ranges
+void appendRangeData(SignatureEntry& entry, size_t pos, const char* buffer, size_t size)
+{
+    for (unsigned i = 0; i < 4; i += 2)
+    {
+        size_t start = std::max(pos, entry.Range[i]);
+        size_t end = std::min(pos + size, entry.Range[i] + entry.Range[i + 1]);
+        if (start >= end)
+            continue;
+
+        if (EVP_DigestUpdate(entry.Digest.get(), buffer + (start - pos), end - start) != 1)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::OpenSSLError, "EVP_DigestUpdate");
+    }
+}
+
+void setFailure(PdfSignatureVerificationResult& result, PdfSignatureVerificationStatus status,
+    const string_view& error, bool appendOpenSSLError)
+{
+    result.Status = status;
+    result.Error = error;
+    if (appendOpenSSLError)
+    {
+        result.Error.append(". Internal OpenSSL error:\n");
+        ssl::GetOpenSSLError(result.Error);
+    }
+}
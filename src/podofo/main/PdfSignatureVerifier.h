@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_SIGNATURE_VERIFIER_H
+#define PDF_SIGNATURE_VERIFIER_H
+
+#include <ctime>
+#include <functional>
+
+#include "PdfDeclarations.h"
+
+extern "C"
+{
+    // OpenSSL forward declaration
+    struct x509_store_st;
+}
+
+namespace PoDoFo
+{
+    class InputStreamDevice;
+
+    enum class PdfSignatureVerificationStatus : uint8_t
+    {
+        Unknown = 0,
+        Valid,          ///< The signature is valid and the signer certificate chain is trusted
+        Untrusted,      ///< The signature is valid, but the signer certificate chain couldn't be validated
+        Modified,       ///< The digest of the signed data doesn't match the signed digest
+        Invalid,        ///< The CMS signature couldn't be verified
+        Malformed,      ///< The signature dictionary or the CMS structure are malformed
+        Unsupported,    ///< The signature sub filter or the CMS structure are not supported
+    };
+
+    /// The result of the verification of a signature field
+    struct PODOFO_API PdfSignatureVerificationResult final
+    {
+        std::string FieldName;          ///< The signature field full name
+        PdfSignatureVerificationStatus Status = PdfSignatureVerificationStatus::Unknown;
+        size_t RevisionLength = 0;      ///< The length of the signed revision, as given by the /ByteRange
+        bool CoversWholeDocument = false;
+        charbuff SignerCertificate;     ///< ASN.1 DER encoded X.509 signer certificate, if found
+        std::string Error;              ///< A description of the failure, if any
+    };
+
+    /// Verifies the CMS signatures (adbe.pkcs7.detached and ETSI.CAdES.detached
+    /// sub filters) of documents against a local trust store, without
+    /// performing any network access. The signed data of all signatures of a
+    /// document is digested in a single pass over the input device
+    /// @remarks Verify() can be called concurrently. The results of the
+    /// validation of the most recently verified certificate chains are
+    /// cached. They are reused only for verification times where the
+    /// validity periods of the certificates of the chain give the same result
+    class PODOFO_API PdfSignatureVerifier final
+    {
+    public:
+        PdfSignatureVerifier();
+        ~PdfSignatureVerifier();
+
+    public:
+        /// Add certificates to the trust store. Trusted certificates
+        /// are trust anchors, even if they are not self-signed
+        /// @param certs an ASN.1 DER encoded X.509 certificate, or one or more PEM encoded certificates
+        /// @remarks Must not be called concurrently with Verify()
+        void AddTrustedCertificates(const bufferview& certs);
+
+        /// Verify all the signed signature fields of the document read from the device
+        /// @param verificationTime the time the validity of the certificates is
+        /// checked at. The current time is used if not specified
+        std::vector<PdfSignatureVerificationResult> Verify(const std::shared_ptr<InputStreamDevice>& device,
+            nullable<time_t> verificationTime = { }) const;
+
+        /// Verify the signatures of many documents concurrently
+        /// @param results the results of every document, in input order. If a document
+        /// can't be loaded, its results consist of a single Malformed result with no field name
+        /// @param verificationTime the time the validity of the certificates is
+        /// checked at. The current time is used if not specified
+        void Verify(const cspan<std::shared_ptr<InputStreamDevice>>& devices,
+            std::vector<std::vector<PdfSignatureVerificationResult>>& results,
+            nullable<time_t> verificationTime = { }) const;
+
+        /// Clear the cached certificate chain validation results
+        void ClearCache();
+
+    private:
+        int validateChain(const std::string& chainKey, time_t verificationTime,
+            const std::function<int(time_t& notBefore, time_t& notAfter)>& validate) const;
+
+    private:
+        PdfSignatureVerifier(const PdfSignatureVerifier&) = delete;
+        PdfSignatureVerifier& operator=(const PdfSignatureVerifier&) = delete;
+
+    private:
+        struct ChainCache;
+
+    private:
+        struct x509_store_st* m_store;
+        std::unique_ptr<ChainCache> m_chainCache;
+    };
+}
+
+#endif // PDF_SIGNATURE_VERIFIER_H
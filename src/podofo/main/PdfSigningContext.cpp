@@ -14,9 +14,9 @@ constexpr const char* ByteRangeBeacon = "[ 0 1234567890 1234567890 1234567890]";
 constexpr size_t BufferSize = 65536;
 
 static PdfSignature& getSignature(PdfDocument& doc, int pageIndex, const PdfReference& signatureRef);
-static size_t readForSignature(StreamDevice& device, size_t contentsBeaconOffset, size_t contentsBeaconSize,
-    char* buffer, size_t size);
-static void adjustByteRange(StreamDevice& device, size_t byteRangeOffset, size_t magicOffset,
+static void appendDataForSignature(PdfSigner& signer, const bufferview& data, size_t offset,
+    size_t contentsBeaconOffset, size_t contentsBeaconSize);
+static void adjustByteRange(StreamDevice& device, size_t deviceOffset, size_t byteRangeOffset, size_t magicOffset,
     size_t contentsBeaconOffset, size_t contentsBeaconSize, PdfArray& byteRangeArr, charbuff& buffer);
 static void setSignature(StreamDevice& device, const string_view& sigData,
     size_t contentsBeaconOffset, charbuff& buffer);
@@ -37,6 +37,49 @@ namespace
         uint8_t _Unused = 0;
         uint32_t XMLFragmentSize = 0;
     };
+
+    /// <summary>
+    /// An output device that forwards the written data to another
+    /// device while appending it to the signers, so the signed data
+    /// doesn't need to be read back. The data starting from the first
+    /// written signature beacon is instead retained, as the /ByteRange
+    /// and the /Contents must be filled before it can be written. The
+    /// retained data is bounded only by the size of the written update
+    /// </summary>
+    class SigningOutputDevice final : public OutputStreamDevice
+    {
+    public:
+        SigningOutputDevice(OutputStreamDevice& device, size_t magicOffset, size_t position,
+            vector<PdfSigner*> signers, vector<shared_ptr<size_t>> beacons);
+
+    public:
+        /// The offset of the retained data
+        size_t GetTailOffset() const { return m_tailOffset; }
+        charbuff& GetTail() { return m_tail; }
+
+        size_t GetLength() const override { return m_position; }
+        size_t GetPosition() const override { return m_position; }
+        bool Eof() const override { return true; }
+        bool CanSeek() const override { return true; }
+
+    protected:
+        void writeBuffer(const char* buffer, size_t size) override;
+        void flush() override;
+        void seek(ssize_t offset, SeekDirection direction) override;
+        void truncate() override;
+
+    private:
+        void appendData(const char* buffer, size_t size);
+
+    private:
+        OutputStreamDevice* m_device;
+        size_t m_magicOffset;
+        vector<PdfSigner*> m_signers;
+        vector<shared_ptr<size_t>> m_beacons;
+        size_t m_position;
+        size_t m_tailOffset;
+        charbuff m_tail;
+    };
 }
 
 PdfSigningContext::PdfSigningContext()
@@ -226,13 +269,28 @@ void PdfSigningContext::StartSigning(PdfMemDocument& doc, shared_ptr<StreamDevic
     if (m_signers.size() == 0)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "No signers were configured");
 
+    if (m_signers.size() != 1)
+    {
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented,
+            "Deferred signing of multiple signature fields is currently not implemented");
+    }
+
     m_doc = &doc;
     m_device = std::move(device);
 
     charbuff tmpbuff;
-    m_contexts = prepareSignatureContexts(doc, true);
+    auto entries = getSignerEntries();
+    auto& entry = *entries[0];
+    m_contexts = prepareSignatureContexts(true);
+    prepareSignature(doc, entry, m_contexts[entry.second.ContextIndex]);
     saveDocForSigning(doc, *m_device, saveOptions);
-    appendDataForSigning(doc, *m_device, m_contexts, &results.Intermediate, tmpbuff);
+    appendDataForSigning(doc, *m_device, 0, doc.GetMagicOffset(), entries, 0, m_contexts, tmpbuff);
+
+    auto& signer = *entry.second.Signer;
+    signer.FetchIntermediateResult(tmpbuff);
+    for (unsigned i = 0, count = signer.GetSignerIdentityCount(); i < count; i++)
+        signer.UnpackIntermediateResult(tmpbuff, i, results.Intermediate[PdfSignerId(entry.first, i)]);
+
     m_status = Status::Started;
 }
 
@@ -242,7 +300,11 @@ void PdfSigningContext::FinishSigning(const PdfSigningResults& processedResults)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "A deferred signing has not been started");
 
     charbuff tmpbuff;
-    computeSignatures(m_contexts, *m_doc, *m_device, &processedResults, tmpbuff);
+    for (auto& pair : m_signers)
+    {
+        computeSignature(pair, m_contexts[pair.second.ContextIndex], *m_doc, *m_device,
+            0, &processedResults, tmpbuff);
+    }
 
     m_doc = nullptr;
     m_device = nullptr;
@@ -440,44 +502,125 @@ void PdfSigningContext::Sign(PdfMemDocument& doc, StreamDevice& device, PdfSaveO
 
     charbuff tmpbuff;
 
-    auto contexts = prepareSignatureContexts(doc, false);
-    saveDocForSigning(doc, device, saveOptions);
-    appendDataForSigning(doc, device, contexts, nullptr, tmpbuff);
-    computeSignatures(contexts, doc, device, nullptr, tmpbuff);
+    // NOTE: Every signature is written in its own incremental update, as
+    // signatures in the same revision would cover each other's /Contents.
+    // The pending signers have been appended the data up to dataOffset
+    auto entries = getSignerEntries();
+    auto contexts = prepareSignatureContexts(false);
+    size_t dataOffset = doc.GetMagicOffset();
+    for (unsigned i = 0; i < entries.size(); i++)
+    {
+        auto& entry = *entries[i];
+        auto& ctx = contexts[entry.second.ContextIndex];
+        if (i != 0)
+        {
+            resetDirty(doc);
+            saveOptions &= ~PdfSaveOptions::SaveOnSigning;
+        }
+
+        prepareSignature(doc, entry, ctx);
+        saveDocForSigning(doc, device, saveOptions);
+        appendDataForSigning(doc, device, 0, dataOffset, entries, i, contexts, tmpbuff);
+        computeSignature(entry, ctx, doc, device, 0, nullptr, tmpbuff);
+        dataOffset = *ctx.Beacons.ContentsOffset;
+    }
 }
 
-PdfSignerId PdfSigningContext::addSigner(const PdfSignature& signature, PdfSigner* signer,
-    shared_ptr<PdfSigner>&& storage)
+void PdfSigningContext::Sign(PdfMemDocument& doc, OutputStreamDevice& device, PdfSaveOptions saveOptions)
 {
-    if (m_signers.size() != 0)
+    ensureNotStarted();
+    checkDocument(doc, saveOptions);
+    if (m_signers.size() == 0)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "No signers were configured");
+
+    charbuff tmpbuff;
+
+    auto entries = getSignerEntries();
+    auto contexts = prepareSignatureContexts(false);
+    vector<PdfSigner*> signers;
+    for (auto entry : entries)
+        signers.push_back(entry->second.Signer);
+
+    size_t position = 0;
+    if ((saveOptions & PdfSaveOptions::SaveOnSigning) == PdfSaveOptions::None)
     {
-        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Signing multiple signature fields "
-            "or signing the same field with multiple signers is currently not implemented");
+        // The incremental update must follow the original document
+        auto source = doc.getDevice();
+        if (source == nullptr)
+        {
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle,
+                "The document was not loaded from a device. Use PdfSaveOptions::SaveOnSigning to save it fully");
+        }
+
+        SigningOutputDevice signingDevice(device, doc.GetMagicOffset(), position, signers, { });
+        source->Seek(0);
+        source->CopyTo(signingDevice);
+        position = signingDevice.GetPosition();
     }
 
-    auto reference = signature.GetObject().GetIndirectReference();
-    auto found = m_signers.find(reference);
-    SignerDescriptors* descs;
-    if (found == m_signers.end())
+    // NOTE: Every signature is written in its own incremental update,
+    // see Sign(PdfMemDocument&, StreamDevice&, PdfSaveOptions)
+    for (unsigned i = 0; i < entries.size(); i++)
     {
-        auto widget = signature.GetWidget();
-        int pageIndex;
-        if (widget == nullptr)
-            pageIndex = -1;
-        else
-            pageIndex = (int)widget->MustGetPage().GetIndex();
+        auto& entry = *entries[i];
+        auto& ctx = contexts[entry.second.ContextIndex];
+        if (i != 0)
+        {
+            resetDirty(doc);
+            saveOptions &= ~PdfSaveOptions::SaveOnSigning;
+        }
+
+        // The data preceding the beacons is appended to
+        // the signers of the following updates as well
+        prepareSignature(doc, entry, ctx);
+        SigningOutputDevice signingDevice(device, doc.GetMagicOffset(), position,
+            vector<PdfSigner*>(signers.begin() + i, signers.end()),
+            { ctx.Beacons.ContentsOffset, ctx.Beacons.ByteRangeOffset });
+        saveDocForSigning(doc, signingDevice, saveOptions);
+
+        // Fill the retained data with the signature and finally write it
+        auto& tail = signingDevice.GetTail();
+        size_t tailOffset = signingDevice.GetTailOffset();
+        {
+            SpanStreamDevice tailDevice(tail.data(), tail.size());
+            appendDataForSigning(doc, tailDevice, tailOffset, tailOffset, entries, i, contexts, tmpbuff);
+            computeSignature(entry, ctx, doc, tailDevice, tailOffset, nullptr, tmpbuff);
+        }
+
+        // The signers of the following updates also cover the final /Contents
+        size_t contentsOffset = *ctx.Beacons.ContentsOffset - tailOffset;
+        for (unsigned j = i + 1; j < entries.size(); j++)
+            signers[j]->AppendData({ tail.data() + contentsOffset, tail.size() - contentsOffset });
 
-        descs = &m_signers[reference];
-        descs->SignatureFullName = signature.GetFullName();
-        descs->SignaturePageIndex = pageIndex;
-        descs->ContextIndex = (unsigned)m_contexts.size();
-        m_contexts.resize(m_contexts.size() + 1);
+        device.Write(tail);
+        position = tailOffset + tail.size();
     }
-    else
+
+    device.Flush();
+}
+
+PdfSignerId PdfSigningContext::addSigner(const PdfSignature& signature, PdfSigner* signer,
+    shared_ptr<PdfSigner>&& storage)
+{
+    auto reference = signature.GetObject().GetIndirectReference();
+    if (m_signers.find(reference) != m_signers.end())
     {
-        descs = &found->second;
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented,
+            "Signing the same field with multiple signers is currently not implemented");
     }
 
+    auto widget = signature.GetWidget();
+    int pageIndex;
+    if (widget == nullptr)
+        pageIndex = -1;
+    else
+        pageIndex = (int)widget->MustGetPage().GetIndex();
+
+    auto descs = &m_signers[reference];
+    descs->SignatureFullName = signature.GetFullName();
+    descs->SignaturePageIndex = pageIndex;
+    descs->ContextIndex = (unsigned)m_contexts.size();
+    m_contexts.resize(m_contexts.size() + 1);
     descs->Signer = signer;
     descs->SignerStorage = std::move(storage);
     return PdfSignerId(reference, 0);
@@ -498,15 +641,23 @@ void PdfSigningContext::checkDocument(PdfMemDocument& doc, PdfSaveOptions saveOp
     }
 }
 
+// Get the signers in the order they were added
+PdfSigningContext::SignerEntries PdfSigningContext::getSignerEntries()
+{
+    SignerEntries ret(m_signers.size());
+    for (auto& pair : m_signers)
+        ret[pair.second.ContextIndex] = &pair;
+
+    return ret;
+}
+
 // Prepare signature contexts, running dry-run signature computation
-vector<PdfSigningContext::SignerContext> PdfSigningContext::prepareSignatureContexts(
-    PdfMemDocument& doc, bool deferredSigning)
+vector<PdfSigningContext::SignerContext> PdfSigningContext::prepareSignatureContexts(bool deferredSigning)
 {
     vector<SignerContext> ret(m_signers.size());
     for (auto& pair : m_signers)
     {
         auto& descs = pair.second;
-        auto& signature = getSignature(doc, descs.SignaturePageIndex, pair.first);
         auto& ctx = ret[descs.ContextIndex];
         auto& signer = descs.Signer;
         signer->Reset();
@@ -516,13 +667,20 @@ vector<PdfSigningContext::SignerContext> PdfSigningContext::prepareSignatureCont
             signer->ComputeSignature(ctx.Contents, true);
         ctx.BeaconSize = ctx.Contents.size();
         prepareBeaconsData(ctx.BeaconSize, ctx.Beacons.ContentsBeacon, ctx.Beacons.ByteRangeBeacon);
-        signature.PrepareForSigning(signer->GetSignatureFilter(), signer->GetSignatureSubFilter(),
-            signer->GetSignatureType(), ctx.Beacons);
+        signer->Reset();
     }
     return ret;
 }
 
-void PdfSigningContext::saveDocForSigning(PdfMemDocument& doc, StreamDevice& device, PdfSaveOptions saveOptions)
+void PdfSigningContext::prepareSignature(PdfMemDocument& doc, SignerMap::value_type& entry, SignerContext& ctx)
+{
+    auto& signature = getSignature(doc, entry.second.SignaturePageIndex, entry.first);
+    auto& signer = *entry.second.Signer;
+    signature.PrepareForSigning(signer.GetSignatureFilter(), signer.GetSignatureSubFilter(),
+        signer.GetSignatureType(), ctx.Beacons);
+}
+
+void PdfSigningContext::saveDocForSigning(PdfMemDocument& doc, OutputStreamDevice& device, PdfSaveOptions saveOptions)
 {
     auto& form = doc.GetOrCreateAcroForm();
     auto sigFlags = form.GetSigFlags();
@@ -550,128 +708,113 @@ void PdfSigningContext::saveDocForSigning(PdfMemDocument& doc, StreamDevice& dev
     device.Flush();
 }
 
-void PdfSigningContext::appendDataForSigning(PdfMemDocument& doc, StreamDevice& device,
-    vector<SignerContext>& contexts, std::unordered_map<PdfSignerId, charbuff>* intermediateResults, charbuff& tmpbuff)
+// Append the data starting from dataOffset to the signer at the given
+// index and, up to its /Contents, to the signers of the following updates
+void PdfSigningContext::appendDataForSigning(PdfMemDocument& doc, StreamDevice& device, size_t deviceOffset,
+    size_t dataOffset, const SignerEntries& entries, unsigned index, vector<SignerContext>& contexts, charbuff& tmpbuff)
 {
-    for (auto& pair : m_signers)
+    auto& signer = *entries[index]->second.Signer;
+    auto& ctx = contexts[entries[index]->second.ContextIndex];
+    size_t contentsOffset = *ctx.Beacons.ContentsOffset;
+    size_t contentsSize = ctx.Beacons.ContentsBeacon.size();
+
+    // Write the final /ByteRange first
+    adjustByteRange(device, deviceOffset, *ctx.Beacons.ByteRangeOffset, doc.GetMagicOffset(),
+        contentsOffset, contentsSize, ctx.ByteRangeArr, tmpbuff);
+    device.Flush();
+
+    // Read the data from the device in a single pass
+    device.Seek(dataOffset - deviceOffset);
+    tmpbuff.resize(BufferSize);
+    size_t offset = dataOffset;
+    size_t readBytes;
+    bool eof;
+    while ((readBytes = device.Read(tmpbuff.data(), BufferSize, eof)) != 0)
     {
-        auto& descs = pair.second;
-        auto& signer = *descs.Signer;
-        auto& ctx = contexts[descs.ContextIndex];
-
-        adjustByteRange(device, *ctx.Beacons.ByteRangeOffset, doc.GetMagicOffset(), *ctx.Beacons.ContentsOffset,
-            ctx.Beacons.ContentsBeacon.size(), ctx.ByteRangeArr, tmpbuff);
-        device.Flush();
-
-        // Read data from the device to prepare the signature
-        signer.Reset();
-        device.Seek(doc.GetMagicOffset());
-        size_t readBytes;
-        tmpbuff.resize(BufferSize);
-        while ((readBytes = readForSignature(device, *ctx.Beacons.ContentsOffset, ctx.Beacons.ContentsBeacon.size(),
-            tmpbuff.data(), BufferSize)) != 0)
+        bufferview data(tmpbuff.data(), readBytes);
+        appendDataForSignature(signer, data, offset, contentsOffset, contentsSize);
+        if (offset < contentsOffset)
         {
-            signer.AppendData({ tmpbuff.data(), readBytes });
+            for (unsigned i = index + 1; i < entries.size(); i++)
+                entries[i]->second.Signer->AppendData({ data.data(), std::min(data.size(), contentsOffset - offset) });
         }
 
-        if (intermediateResults != nullptr)
-        {
-            signer.FetchIntermediateResult(tmpbuff);
-            for (unsigned i = 0, count = signer.GetSignerIdentityCount(); i < count; i++)
-                signer.UnpackIntermediateResult(tmpbuff, i, (*intermediateResults)[PdfSignerId(pair.first, i)]);
-        }
+        offset += readBytes;
+        if (eof)
+            break;
     }
 }
 
-void PdfSigningContext::computeSignatures(std::vector<SignerContext>& contexts, PdfMemDocument& doc, StreamDevice& device,
-    const PdfSigningResults* processedResults, charbuff& tmpbuff)
+void PdfSigningContext::computeSignature(SignerMap::value_type& entry, SignerContext& ctx, PdfMemDocument& doc,
+    StreamDevice& device, size_t deviceOffset, const PdfSigningResults* processedResults, charbuff& tmpbuff)
 {
-    for (auto& pair : m_signers)
-    {
-        auto& descs = pair.second;
-        auto& signature = getSignature(doc, descs.SignaturePageIndex, pair.first);
-        auto& signer = *descs.Signer;
-        auto& ctx = contexts[descs.ContextIndex];
+    auto& descs = entry.second;
+    auto& signature = getSignature(doc, descs.SignaturePageIndex, entry.first);
+    auto& signer = *descs.Signer;
 
-        if (!signer.SkipBufferClear())
-            ctx.Contents.clear();
+    if (!signer.SkipBufferClear())
+        ctx.Contents.clear();
 
-        if (processedResults == nullptr)
-        {
-            signer.ComputeSignature(ctx.Contents, false);
-        }
-        else
-        {
-            for (unsigned i = 0, count = signer.GetSignerIdentityCount(); i < count; i++)
-                signer.AssembleProcessedResult(processedResults->Intermediate.at((PdfSignerId(pair.first, i))), i, tmpbuff);
+    if (processedResults == nullptr)
+    {
+        signer.ComputeSignature(ctx.Contents, false);
+    }
+    else
+    {
+        for (unsigned i = 0, count = signer.GetSignerIdentityCount(); i < count; i++)
+            signer.AssembleProcessedResult(processedResults->Intermediate.at((PdfSignerId(entry.first, i))), i, tmpbuff);
 
-            signer.ComputeSignatureDeferred(tmpbuff, ctx.Contents, false);
-        }
+        signer.ComputeSignatureDeferred(tmpbuff, ctx.Contents, false);
+    }
 
-        if (ctx.Contents.size() > ctx.BeaconSize)
-            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Actual signature size bigger than beacon size");
+    if (ctx.Contents.size() > ctx.BeaconSize)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "Actual signature size bigger than beacon size");
 
-        // Ensure the signature will be as big as the
-        // beacon size previously cached to fill all
-        // available reserved space for the /Contents
-        ctx.Contents.resize(ctx.BeaconSize);
-        setSignature(device, ctx.Contents, *ctx.Beacons.ContentsOffset, tmpbuff);
-        device.Flush();
+    // Ensure the signature will be as big as the
+    // beacon size previously cached to fill all
+    // available reserved space for the /Contents
+    ctx.Contents.resize(ctx.BeaconSize);
+    setSignature(device, ctx.Contents, *ctx.Beacons.ContentsOffset - deviceOffset, tmpbuff);
+    device.Flush();
 
-        // Finally set actual /ByteRange on the signature without dirty set
-        signature.SetContentsByteRangeNoDirtySet(ctx.Contents, std::move(ctx.ByteRangeArr));
-    }
+    // Finally set actual /ByteRange on the signature without dirty set
+    signature.SetContentsByteRangeNoDirtySet(ctx.Contents, std::move(ctx.ByteRangeArr));
 }
 
-size_t readForSignature(StreamDevice& device, size_t contentsBeaconOffset, size_t contentsBeaconSize,
-    char* buffer, size_t bufferSize)
+// The objects written by a signing update must not be written again by the following ones
+void PdfSigningContext::resetDirty(PdfMemDocument& doc)
 {
-    if (device.Eof())
-        return 0;
+    for (auto obj : doc.GetObjects())
+        obj->ResetDirty();
+}
 
-    size_t pos = device.GetPosition();
-    size_t readSize = 0;
-    // Check if we are before beacon
-    if (pos < contentsBeaconOffset)
-    {
-        readSize = std::min(bufferSize, contentsBeaconOffset - pos);
-        if (readSize > 0)
-        {
-            device.Read(buffer, readSize);
-            buffer += readSize;
-            bufferSize -= readSize;
-            if (bufferSize == 0)
-                return readSize;
-        }
-    }
+void appendDataForSignature(PdfSigner& signer, const bufferview& data, size_t offset,
+    size_t contentsBeaconOffset, size_t contentsBeaconSize)
+{
+    // Append the data preceding the beacon
+    if (offset < contentsBeaconOffset)
+        signer.AppendData({ data.data(), std::min(data.size(), contentsBeaconOffset - offset) });
 
-    // shift at the end of beacon
-    if ((pos + readSize) >= contentsBeaconOffset
-        && pos < (contentsBeaconOffset + contentsBeaconSize))
+    // Append the data following the beacon
+    size_t contentsBeaconEnd = contentsBeaconOffset + contentsBeaconSize;
+    if (offset + data.size() > contentsBeaconEnd)
     {
-        device.Seek(contentsBeaconOffset + contentsBeaconSize);
+        size_t skip = offset < contentsBeaconEnd ? contentsBeaconEnd - offset : 0;
+        signer.AppendData({ data.data() + skip, data.size() - skip });
     }
-
-    // read after beacon
-    bufferSize = std::min(bufferSize, device.GetLength() - device.GetPosition());
-    if (bufferSize == 0)
-        return readSize;
-
-    device.Read(buffer, bufferSize);
-    return readSize + bufferSize;
 }
 
-void adjustByteRange(StreamDevice& device, size_t byteRangeOffset, size_t magicOffset,
+void adjustByteRange(StreamDevice& device, size_t deviceOffset, size_t byteRangeOffset, size_t magicOffset,
     size_t contentsBeaconOffset, size_t contentsBeaconSize, PdfArray& byteRangeArr, charbuff& buffer)
 {
     // Get final position
-    size_t fileEnd = device.GetLength();
+    size_t fileEnd = deviceOffset + device.GetLength();
     byteRangeArr.Add(PdfObject(static_cast<int64_t>(0))); // This must ignore magic offset != 0
     byteRangeArr.Add(PdfObject(static_cast<int64_t>(contentsBeaconOffset - magicOffset)));
     byteRangeArr.Add(PdfObject(static_cast<int64_t>(contentsBeaconOffset + contentsBeaconSize - magicOffset)));
     byteRangeArr.Add(PdfObject(static_cast<int64_t>(fileEnd - (contentsBeaconOffset + contentsBeaconSize))));
 
-    device.Seek(byteRangeOffset);
+    device.Seek(byteRangeOffset - deviceOffset);
     byteRangeArr.Write(device, PdfWriteFlags::None, { }, buffer);
 }
 
@@ -694,6 +837,88 @@ void prepareBeaconsData(size_t signatureSize, string& contentsBeacon, string& by
     byteRangeBeacon.resize(char_traits<char>::length(ByteRangeBeacon), ' ');
 }
 
+SigningOutputDevice::SigningOutputDevice(OutputStreamDevice& device, size_t magicOffset, size_t position,
+        vector<PdfSigner*> signers, vector<shared_ptr<size_t>> beacons) :
+    m_device(&device),
+    m_magicOffset(magicOffset),
+    m_signers(std::move(signers)),
+    m_beacons(std::move(beacons)),
+    m_position(position),
+    m_tailOffset(numeric_limits<size_t>::max())
+{
+    // Mark the beacons as not written yet
+    for (auto& beacon : m_beacons)
+        *beacon = numeric_limits<size_t>::max();
+}
+
+void SigningOutputDevice::writeBuffer(const char* buffer, size_t size)
+{
+    if (m_tailOffset == numeric_limits<size_t>::max())
+    {
+        for (auto& beacon : m_beacons)
+        {
+            if (*beacon < m_tailOffset)
+                m_tailOffset = *beacon;
+        }
+
+        if (m_tailOffset < m_position)
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InternalLogic, "The signature beacon has already been written");
+
+        if (m_tailOffset >= m_position + size)
+        {
+            // No beacon has been written yet, or it's past this chunk
+            appendData(buffer, size);
+            m_device->Write(buffer, size);
+            m_position += size;
+            return;
+        }
+
+        size_t prefixSize = m_tailOffset - m_position;
+        appendData(buffer, prefixSize);
+        m_device->Write(buffer, prefixSize);
+        m_position += prefixSize;
+        buffer += prefixSize;
+        size -= prefixSize;
+    }
+
+    m_tail.append(buffer, size);
+    m_position += size;
+}
+
+void SigningOutputDevice::appendData(const char* buffer, size_t size)
+{
+    // Skip the data before the magic offset
+    if (m_position + size <= m_magicOffset)
+        return;
+
+    if (m_position < m_magicOffset)
+    {
+        buffer += m_magicOffset - m_position;
+        size -= m_magicOffset - m_position;
+    }
+
+    for (auto signer : m_signers)
+        signer->AppendData({ buffer, size });
+}
+
+void SigningOutputDevice::flush()
+{
+    m_device->Flush();
+}
+
+void SigningOutputDevice::seek(ssize_t offset, SeekDirection direction)
+{
+    // NOTE: The data can only be appended, so allow
+    // seeking only to the current position
+    if ((direction == SeekDirection::Begin ? (size_t)offset : m_position + offset) != m_position)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::NotImplemented, "Seeking a signing output device is not supported");
+}
+
+void SigningOutputDevice::truncate()
+{
+    PODOFO_RAISE_ERROR(PdfErrorCode::NotImplemented);
+}
+
 PdfSignerId::PdfSignerId()
     : m_SignerIndex(0) { }
 
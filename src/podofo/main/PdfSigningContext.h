@@ -74,9 +74,23 @@ namespace PoDoFo
         PdfSignerId AddSigner(const PdfSignature& signature, std::shared_ptr<PdfSigner> signer);
 
         /// Start a blocking event-driven signing procedure
+        /// @remarks The signature fields are signed in the order the signers were added,
+        /// each one in its own incremental update, as signatures in the same revision would
+        /// cover each other's /Contents. Only the first update follows PdfSaveOptions::SaveOnSigning
         void Sign(PdfMemDocument& doc, StreamDevice& device, PdfSaveOptions options = PdfSaveOptions::None);
 
+        /// Start a blocking event-driven signing procedure on a write-only device
+        /// @remarks The signed data is appended to the signers while it's written, so the
+        /// device is never read back. The data of each update from the signature dictionary
+        /// onwards is kept in memory until its signature is computed: this is usually the tail
+        /// of the update, but with PdfSaveOptions::SaveOnSigning and a signature field that
+        /// already exists with a low object number it's almost the whole document. Unless
+        /// PdfSaveOptions::SaveOnSigning is specified, the original document is copied to the
+        /// device before the update, so it must have been loaded from a device
+        void Sign(PdfMemDocument& doc, OutputStreamDevice& device, PdfSaveOptions options = PdfSaveOptions::None);
+
         /// Start a deferred (aka "async") signing procedure
+        /// @remarks Only a single signature field can be signed with a deferred procedure
         /// @param results instance where intermediate results will be stored
         /// @param doc the document to be signed
         /// @param device device where to perform the operation
@@ -127,6 +141,9 @@ namespace PoDoFo
             PdfArray ByteRangeArr;
         };
 
+        using SignerMap = std::unordered_map<PdfReference, SignerDescriptors>;
+        using SignerEntries = std::vector<SignerMap::value_type*>;
+
         enum class Status
         {
             Config,     ///< The context is still configuring signers
@@ -145,19 +162,22 @@ namespace PoDoFo
             std::shared_ptr<PdfSigner>&& storage);
         void ensureNotStarted() const;
         void checkDocument(PdfMemDocument& doc, PdfSaveOptions saveOptions) const;
-        std::vector<SignerContext> prepareSignatureContexts(PdfMemDocument& doc, bool deferredSigning);
-        void saveDocForSigning(PdfMemDocument& doc, StreamDevice& device, PdfSaveOptions saveOptions);
-        void appendDataForSigning(PdfMemDocument& doc, StreamDevice& device, std::vector<SignerContext>& contexts,
-            std::unordered_map<PdfSignerId, charbuff>* intermediateResults, charbuff& tmpbuff);
-        void computeSignatures(std::vector<SignerContext>& contexts, PdfMemDocument& doc, StreamDevice& device,
-            const PdfSigningResults* processedResults, charbuff& tmpbuff);
+        SignerEntries getSignerEntries();
+        std::vector<SignerContext> prepareSignatureContexts(bool deferredSigning);
+        void prepareSignature(PdfMemDocument& doc, SignerMap::value_type& entry, SignerContext& ctx);
+        void saveDocForSigning(PdfMemDocument& doc, OutputStreamDevice& device, PdfSaveOptions saveOptions);
+        void appendDataForSigning(PdfMemDocument& doc, StreamDevice& device, size_t deviceOffset, size_t dataOffset,
+            const SignerEntries& entries, unsigned index, std::vector<SignerContext>& contexts, charbuff& tmpbuff);
+        void computeSignature(SignerMap::value_type& entry, SignerContext& ctx, PdfMemDocument& doc, StreamDevice& device,
+            size_t deviceOffset, const PdfSigningResults* processedResults, charbuff& tmpbuff);
+        static void resetDirty(PdfMemDocument& doc);
 
     private:
         PdfSigningContext(const PdfSigningContext&) = delete;
         PdfSigningContext& operator==(const PdfSigningContext&) = delete;
 
     private:
-        std::unordered_map<PdfReference, SignerDescriptors> m_signers;
+        SignerMap m_signers;
         // Used during deferred signing
         PdfMemDocument* m_doc;
         std::shared_ptr<StreamDevice> m_device;
@@ -12,6 +12,9 @@ using namespace PoDoFo;
 PdfStatefulEncrypt::PdfStatefulEncrypt(const PdfEncrypt& encrypt, PdfEncryptContext& context, const PdfReference& objref)
     : m_encrypt(&encrypt), m_context(&context), m_currReference(objref) { }
 
+PdfStatefulEncrypt::PdfStatefulEncrypt(const shared_ptr<PdfEncryptSession>& session, const PdfReference& objref)
+    : m_session(session), m_encrypt(&session->GetEncrypt()), m_context(&session->GetContext()), m_currReference(objref) { }
+
 void PdfStatefulEncrypt::EncryptTo(charbuff& out, const bufferview& view) const
 {
     m_encrypt->EncryptTo(out, view, *m_context, m_currReference);
@@ -26,3 +29,21 @@ size_t PdfStatefulEncrypt::CalculateStreamLength(size_t length) const
 {
     return m_encrypt->CalculateStreamLength(length);
 }
+
+bool PdfStatefulEncrypt::CanReuseCiphertext(PdfEncryptSession& session, const PdfReference& objref) const
+{
+    if (objref != m_currReference)
+        return false;
+
+    auto& encrypt = session.GetEncrypt();
+    auto& context = session.GetContext();
+    if (&encrypt == m_encrypt && &context == m_context)
+        return true;
+
+    // Object keys are derived just from the encryption key, the
+    // algorithm and the object reference
+    return encrypt.GetEncryptAlgorithm() == m_encrypt->GetEncryptAlgorithm()
+        && encrypt.GetKeyLength() == m_encrypt->GetKeyLength()
+        && context.IsAuthenticated() && m_context->IsAuthenticated()
+        && std::memcmp(context.GetEncryptionKey(), m_context->GetEncryptionKey(), m_encrypt->GetKeyLengthBytes()) == 0;
+}
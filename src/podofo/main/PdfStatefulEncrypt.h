@@ -5,15 +5,21 @@
 #define PDF_STATEFUL_ENCRYPT_H
 
 #include "PdfReference.h"
-#include "PdfEncrypt.h"
+#include "PdfEncryptSession.h"
 
 namespace PoDoFo
 {
     class PODOFO_API PdfStatefulEncrypt final
     {
+        friend class PdfString;
+
     public:
         PdfStatefulEncrypt(const PdfEncrypt& encrypt, PdfEncryptContext& context, const PdfReference& objref);
 
+        /// Create a stateful encrypt that shares the ownership of the session,
+        /// allowing decrypted strings to defer the decryption on first access
+        PdfStatefulEncrypt(const std::shared_ptr<PdfEncryptSession>& session, const PdfReference& objref);
+
     public:
         /// Encrypt a character span
         void EncryptTo(charbuff& out, const bufferview& view) const;
@@ -23,11 +29,17 @@ namespace PoDoFo
 
         size_t CalculateStreamLength(size_t length) const;
 
+        /// Determine if data encrypted with the given session for the given
+        /// object can be decrypted with this stateful encrypt, hence it
+        /// can be written as is
+        bool CanReuseCiphertext(PdfEncryptSession& session, const PdfReference& objref) const;
+
     private:
         PdfStatefulEncrypt(const PdfStatefulEncrypt&) = delete;
         PdfStatefulEncrypt& operator=(const PdfStatefulEncrypt&) = delete;
 
     private:
+        std::shared_ptr<PdfEncryptSession> m_session;
         const PdfEncrypt* m_encrypt;
         PdfEncryptContext* m_context;
         PdfReference m_currReference;       // Reference of the current PdfObject
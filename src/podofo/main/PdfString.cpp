@@ -12,6 +12,7 @@
 #include "PdfPredefinedEncoding.h"
 #include "PdfEncodingFactory.h"
 #include "PdfTokenizer.h"
+#include "PdfStatefulEncrypt.h"
 #include <podofo/auxiliary/OutputDevice.h>
 
 using namespace std;
@@ -175,17 +176,28 @@ PdfString PdfString::FromHexData(const string_view& hexView, const PdfStatefulEn
         buffer.push_back(decodedChar);
     }
 
-    if (encrypt != nullptr)
+    buffer.shrink_to_fit();
+    return fromRaw(std::move(buffer), true, encrypt);
+}
+
+PdfString PdfString::fromRaw(charbuff&& buff, bool isHex, const PdfStatefulEncrypt* encrypt)
+{
+    // NOTE: Empty strings are not encrypted
+    if (encrypt == nullptr || buff.size() == 0)
+        return PdfString(std::move(buff), isHex);
+
+    if (encrypt->m_session == nullptr)
     {
         charbuff decrypted;
-        encrypt->DecryptTo(decrypted, buffer);
-        return PdfString(std::move(decrypted), true);
-    }
-    else
-    {
-        buffer.shrink_to_fit();
-        return PdfString(std::move(buffer), true);
+        encrypt->DecryptTo(decrypted, buff);
+        return PdfString(std::move(decrypted), isHex);
     }
+
+    // Keep the encrypted data and the session, so
+    // the string will be decrypted on first access
+    PdfString ret(std::move(buff), isHex);
+    ret.m_data->Decryption.reset(new DeferredDecryption{ encrypt->m_session, encrypt->m_currReference });
+    return ret;
 }
 
 void PdfString::Write(OutputStream& device, PdfWriteFlags writeFlags,
@@ -196,10 +208,21 @@ void PdfString::Write(OutputStream& device, PdfWriteFlags writeFlags,
     // Strings in PDF documents may contain \0 especially if they are encrypted
     // this case has to be handled!
 
+    if (m_dataAllocated && m_data->Decryption != nullptr && encrypt != nullptr
+        && encrypt->CanReuseCiphertext(*m_data->Decryption->Session, m_data->Decryption->ObjectReference))
+    {
+        // The string was never accessed and the encryption
+        // is unchanged: just write the cipher text
+        utls::SerializeEncodedString(device, m_data->Chars, m_isHex,
+            (writeFlags & PdfWriteFlags::SkipDelimiters) != PdfWriteFlags::None);
+        return;
+    }
+
     string_view view;
     bool stringEvalued;
     if (m_dataAllocated)
     {
+        ensureDecrypted();
         view = m_data->Chars;
         stringEvalued = m_data->StringEvaluated;
     }
@@ -287,9 +310,14 @@ string_view PdfString::GetString() const
 bool PdfString::IsEmpty() const
 {
     if (m_dataAllocated)
+    {
+        ensureDecrypted();
         return m_data->Chars.empty();
+    }
     else
+    {
         return m_Utf8View.empty();
+    }
 }
 
 bool PdfString::IsStringEvaluated() const
@@ -300,6 +328,14 @@ bool PdfString::IsStringEvaluated() const
         return true;
 }
 
+bool PdfString::IsDecrypted() const
+{
+    if (m_dataAllocated)
+        return m_data->Decryption == nullptr;
+    else
+        return true;
+}
+
 bool PdfString::operator==(const PdfString& rhs) const
 {
     if (this->m_dataAllocated)
@@ -309,6 +345,9 @@ bool PdfString::operator==(const PdfString& rhs) const
             if (this->m_data == rhs.m_data)
                 return true;
 
+            this->ensureDecrypted();
+            rhs.ensureDecrypted();
+
             if (this->m_data->StringEvaluated != this->m_data->StringEvaluated)
                 return false;
 
@@ -461,12 +500,32 @@ void PdfString::initFromUtf8String(const char* str, size_t length, bool literal)
     }
 }
 
+void PdfString::ensureDecrypted() const
+{
+    PODOFO_INVARIANT(m_dataAllocated);
+    if (m_data->Decryption == nullptr)
+        return;
+
+    // The context of the session is shared by all the strings of the document
+    auto& decryption = *m_data->Decryption;
+    charbuff decrypted;
+    {
+        unique_lock<mutex> lock(decryption.Session->m_Mutex);
+        decryption.Session->GetEncrypt().DecryptTo(decrypted, m_data->Chars,
+            decryption.Session->GetContext(), decryption.ObjectReference);
+    }
+    m_data->Chars.swap(decrypted);
+    m_data->Decryption = nullptr;
+}
+
 void PdfString::ensureCharsEvaluated() const
 {
     PODOFO_INVARIANT(m_dataAllocated);
     if (m_data->StringEvaluated)
         return;
 
+    ensureDecrypted();
+
     auto encoding = getEncoding(m_data->Chars);
     switch (encoding)
     {
@@ -528,6 +587,7 @@ string_view PdfString::GetRawData() const
     if (!m_dataAllocated || m_data->StringEvaluated)
         PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The raw data buffer has been evaluated to a string");
 
+    ensureDecrypted();
     return m_data->Chars;
 }
 
@@ -5,10 +5,12 @@
 #ifndef PDF_STRING_H
 #define PDF_STRING_H
 
-#include "PdfBaseDataTypes.h"
+#include "PdfReference.h"
 
 namespace PoDoFo {
 
+class PdfEncryptSession;
+
 /// A string that can be written to a PDF document.
 /// If it contains binary data it is automatically
 /// converted into a hex string, otherwise a normal PDF
@@ -19,6 +21,8 @@ namespace PoDoFo {
 ///
 class PODOFO_API PdfString final : private PdfDataMember, public PdfDataProvider<PdfString>
 {
+    friend class PdfTokenizer;
+
 public:
     /// Create an empty string
     PdfString();
@@ -67,6 +71,7 @@ public:
     /// Set hex-encoded data as the strings data.
     /// @param hexView must be hex-encoded data.
     /// @param encrypt if !nullptr, assume the hex data is encrypted and should be decrypted after hex-decoding.
+    ///     The decryption is deferred to first access if the stateful encrypt shares the ownership of the session
     static PdfString FromHexData(const std::string_view& hexView, const PdfStatefulEncrypt* encrypt = { });
 
     /// Check if this is a hex string.
@@ -87,6 +92,14 @@ public:
     /// True if the raw data buffer has been evaluated to a string
     bool IsStringEvaluated() const;
 
+    /// False if the raw data buffer is still encrypted, and
+    /// it will be decrypted on first access
+    /// @remarks Different strings of a document can be accessed concurrently,
+    /// as the decryptions sharing the document encryption are serialized.
+    /// As with the evaluation of the raw data, the same string instance, or
+    /// its copies, must not be accessed concurrently before it's decrypted
+    bool IsDecrypted() const;
+
     /// The contents of the string as UTF-8 string.
     ///
     /// The string's contents are always returned as
@@ -144,16 +157,27 @@ private:
     /// @param literal true if the string should be treated as literal
     ///
     void initFromUtf8String(const char* str, size_t length, bool literal);
+    /// Create a string from raw data, decrypting it with the given encrypt, if any
+    static PdfString fromRaw(charbuff&& buff, bool isHex, const PdfStatefulEncrypt* encrypt);
+    void ensureDecrypted() const;
     void ensureCharsEvaluated() const;
     void moveFrom(PdfString&& rhs);
 
 private:
+    struct DeferredDecryption
+    {
+        std::shared_ptr<PdfEncryptSession> Session;
+        PdfReference ObjectReference;
+    };
+
     struct StringData
     {
         StringData(charbuff&& buff, bool stringEvaluated);
 
         charbuff Chars;
         bool StringEvaluated;
+        // Set if Chars is still encrypted
+        std::unique_ptr<DeferredDecryption> Decryption;
     };
 
 private:
@@ -4,29 +4,153 @@
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfStringStream.h"
 
-#include <podofo/private/outstringstream.h>
-
 using namespace std;
-using namespace cmn;
 using namespace PoDoFo;
 
+// Large enough to format in fixed notation all the coordinates
+// commonly found in content streams, with the default precision
+constexpr unsigned FloatFormatDefaultSize = 32;
+
+// The default precision of std::ostream
+constexpr unsigned short DefaultPrecision = 6;
+
+template <typename TInt>
+static void appendInteger(string& buffer, TInt value);
+template <typename TFloat>
+static void appendFloat(string& buffer, TFloat value, unsigned short precision);
+
+namespace
+{
+    /// Stream buffer that appends to a string, used by the
+    /// iostream fallback for types not handled natively
+    class StringAppendBuffer final : public streambuf
+    {
+    public:
+        StringAppendBuffer(string& buffer)
+            : m_buffer(&buffer) { }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+                return traits_type::not_eof(ch);
+
+            m_buffer->push_back(traits_type::to_char_type(ch));
+            return ch;
+        }
+
+        streamsize xsputn(const char_type* s, streamsize count) override
+        {
+            m_buffer->append(s, (size_t)count);
+            return count;
+        }
+
+    private:
+        string* m_buffer;
+    };
+
+    class StringAppendStream final : public ostream
+    {
+    public:
+        StringAppendStream(string& buffer)
+            : ostream(nullptr), m_buffer(buffer)
+        {
+            this->rdbuf(&m_buffer);
+        }
+
+    private:
+        StringAppendBuffer m_buffer;
+    };
+}
+
 PdfStringStream::PdfStringStream()
-    : m_stream(new outstringstream())
+    : m_precision(DefaultPrecision)
+{
+}
+
+PdfStringStream::~PdfStringStream() { }
+
+PdfStringStream& PdfStringStream::operator<<(char ch)
+{
+    m_buffer.push_back(ch);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(const char* str)
+{
+    m_buffer.append(str);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(const string_view& view)
+{
+    m_buffer.append(view.data(), view.size());
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(const string& str)
+{
+    m_buffer.append(str);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(short val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(unsigned short val)
 {
-    m_stream->imbue(utls::GetInvariantLocale());
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(int val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(unsigned val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(long val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(unsigned long val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(long long val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
+}
+
+PdfStringStream& PdfStringStream::operator<<(unsigned long long val)
+{
+    appendInteger(m_buffer, val);
+    return *this;
 }
 
 PdfStringStream& PdfStringStream::operator<<(float val)
 {
-    utls::FormatTo(m_temp, val, (unsigned short)m_stream->precision());
-    (*m_stream) << m_temp;
+    appendFloat(m_buffer, val, m_precision);
     return *this;
 }
 
 PdfStringStream& PdfStringStream::operator<<(double val)
 {
-    utls::FormatTo(m_temp, val, (unsigned char)m_stream->precision());
-    (*m_stream) << m_temp;
+    appendFloat(m_buffer, val, m_precision);
     return *this;
 }
 
@@ -35,42 +159,110 @@ PdfStringStream& PdfStringStream::operator<<(
 {
     // Note that std::endl will itself append \n character and
     // the underlying stream won't turn it to \r\n on Windows
-    (void)pfn(*m_stream);
+    (void)pfn(getStream());
     return *this;
 }
 
+void PdfStringStream::Reserve(size_t size)
+{
+    m_buffer.reserve(size);
+}
+
 string_view PdfStringStream::GetString() const
 {
-    return static_cast<const outstringstream&>(*m_stream).str();
+    return m_buffer;
 }
 
 string PdfStringStream::TakeString()
 {
-    return static_cast<outstringstream&>(*m_stream).take_str();
+    string ret = std::move(m_buffer);
+    m_buffer.clear();
+    return ret;
 }
 
 void PdfStringStream::Clear()
 {
-    static_cast<outstringstream&>(*m_stream).clear();
-    m_temp.clear();
+    m_buffer.clear();
 }
 
 void PdfStringStream::SetPrecision(unsigned short value)
 {
-    (void)m_stream->precision(value);
+    m_precision = value;
+    if (m_stream != nullptr)
+        (void)m_stream->precision(value);
 }
 
 unsigned short PdfStringStream::GetPrecision() const
 {
-    return (unsigned short)m_stream->precision();
+    return m_precision;
 }
 
 unsigned PdfStringStream::GetSize() const
 {
-    return (unsigned)static_cast<const outstringstream&>(*m_stream).size();
+    return (unsigned)m_buffer.size();
 }
 
 void PdfStringStream::writeBuffer(const char* buffer, size_t size)
 {
-    m_stream->write(buffer, size);
+    m_buffer.append(buffer, size);
+}
+
+ostream& PdfStringStream::getStream()
+{
+    if (m_stream == nullptr)
+    {
+        m_stream.reset(new StringAppendStream(m_buffer));
+        m_stream->imbue(utls::GetInvariantLocale());
+        (void)m_stream->precision(m_precision);
+    }
+
+    return *m_stream;
+}
+
+template <typename TInt>
+void appendInteger(string& buffer, TInt value)
+{
+    // One more character for the sign and one for
+    // the digit not covered by digits10
+    array<char, numeric_limits<TInt>::digits10 + 2> arr;
+    auto res = std::to_chars(arr.data(), arr.data() + arr.size(), value);
+    buffer.append(arr.data(), res.ptr - arr.data());
+}
+
+template <typename TFloat>
+void appendFloat(string& buffer, TFloat value, unsigned short precision)
+{
+    size_t offset = buffer.size();
+    buffer.resize(offset + FloatFormatDefaultSize);
+    auto result = std::to_chars(buffer.data() + offset, buffer.data() + buffer.size(),
+        value, chars_format::fixed, precision);
+    if (result.ec == errc::value_too_large)
+    {
+        // Very large magnitudes: reserve space for all the integral
+        // digits, sign, decimal point and the requested precision
+        buffer.resize(offset + numeric_limits<TFloat>::max_exponent10 + 3 + precision);
+        result = std::to_chars(buffer.data() + offset, buffer.data() + buffer.size(),
+            value, chars_format::fixed, precision);
+    }
+
+    // Remove trailing zeroes and the decimal point, if left alone
+    const char* cursor = buffer.data() + offset;
+    size_t len = result.ptr - cursor;
+    if (precision != 0)
+    {
+        while (cursor[len - 1] == '0')
+            len--;
+
+        if (cursor[len - 1] == '.')
+            len--;
+    }
+
+    // Normalize negative values rounded to "-0"
+    if (len == 2 && cursor[0] == '-' && cursor[1] == '0')
+    {
+        buffer[offset] = '0';
+        len = 1;
+    }
+
+    buffer.resize(offset + len);
 }
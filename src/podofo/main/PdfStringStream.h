@@ -12,15 +12,21 @@ namespace PoDoFo
     /// A specialized Pdf output string stream
     /// It supplies an iostream-like operator<< interface,
     /// while still inheriting OutputStream
+    /// \remarks Strings, characters and numbers are appended directly
+    /// to an internal buffer, with no iostream/locale machinery involved.
+    /// Other types fall back to a lazily created std::ostream, imbued
+    /// with the invariant locale, writing to the same buffer
     class PODOFO_API PdfStringStream final : public OutputStream
     {
     public:
         PdfStringStream();
 
+        ~PdfStringStream();
+
         template <typename T>
         inline PdfStringStream& operator<<(T const& val)
         {
-            (*m_stream) << val;
+            getStream() << val;
             return *this;
         }
 
@@ -28,10 +34,41 @@ namespace PoDoFo
         PdfStringStream& operator<<(
             std::ostream& (*pfn)(std::ostream&));
 
+        PdfStringStream& operator<<(char ch);
+
+        PdfStringStream& operator<<(const char* str);
+
+        PdfStringStream& operator<<(const std::string_view& view);
+
+        PdfStringStream& operator<<(const std::string& str);
+
+        PdfStringStream& operator<<(short val);
+
+        PdfStringStream& operator<<(unsigned short val);
+
+        PdfStringStream& operator<<(int val);
+
+        PdfStringStream& operator<<(unsigned val);
+
+        PdfStringStream& operator<<(long val);
+
+        PdfStringStream& operator<<(unsigned long val);
+
+        PdfStringStream& operator<<(long long val);
+
+        PdfStringStream& operator<<(unsigned long long val);
+
+        /// Append the float value with fixed notation, using
+        /// the current precision and trimming trailing zeroes
         PdfStringStream& operator<<(float val);
 
+        /// Append the double value with fixed notation, using
+        /// the current precision and trimming trailing zeroes
         PdfStringStream& operator<<(double val);
 
+        /// Reserve capacity in the internal buffer
+        void Reserve(size_t size);
+
         std::string_view GetString() const;
 
         std::string TakeString();
@@ -44,17 +81,21 @@ namespace PoDoFo
 
         unsigned GetSize() const;
 
-        explicit operator std::ostream& () { return *m_stream; }
+        explicit operator std::ostream& () { return getStream(); }
 
     protected:
-        void writeBuffer(const char* buffer, size_t size);
+        void writeBuffer(const char* buffer, size_t size) override;
+
+    private:
+        std::ostream& getStream();
 
     private:
         using OutputStream::Flush;
         using OutputStream::Write;
 
     private:
-        charbuff m_temp;
+        charbuff m_buffer;
+        unsigned short m_precision;
         std::unique_ptr<std::ostream> m_stream;
     };
 }
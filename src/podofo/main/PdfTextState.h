@@ -11,6 +11,19 @@ namespace PoDoFo
 {
     class PdfFont;
 
+    /// Parameters for shaping text with HarfBuzz
+    struct PODOFO_API PdfTextShapingParams final
+    {
+        /// Comma separated OpenType features in HarfBuzz syntax,
+        /// eg. "liga,-kern,ss01". Default features of the script
+        /// are applied unless explicitly disabled
+        std::string Features;
+        /// BCP 47 language tag, eg. "ar". If empty the default language is used
+        std::string Language;
+        /// ISO 15924 script tag, eg. "Arab". If empty the script is guessed from the text
+        std::string Script;
+    };
+
     // TODO: Add missing properties ISO 32000-1:2008 "9.3 Text State Parameters and Operators"
     struct PODOFO_API PdfTextState final
     {
@@ -718,16 +718,8 @@ bool PdfTokenizer::ReadString(InputStreamDevice& device, PdfVariant& variant, co
 
     if (m_charBuffer.size() != 0)
     {
-        if (encrypt != nullptr)
-        {
-            charbuff decrypted;
-            encrypt->DecryptTo(decrypted, { m_charBuffer.data(), m_charBuffer.size() });
-            new(&variant.m_String)PdfString(std::move(decrypted), false);
-        }
-        else
-        {
-            new(&variant.m_String)PdfString(charbuff(m_charBuffer.data(), m_charBuffer.size()), false);
-        }
+        new(&variant.m_String)PdfString(PdfString::fromRaw(
+            charbuff(m_charBuffer.data(), m_charBuffer.size()), false, encrypt));
     }
     else
     {
@@ -33,6 +33,7 @@
 #include "main/PdfFunction.h"
 #include "main/PdfColor.h"
 #include "main/PdfContentStreamReader.h"
+#include "main/PdfContentStreamRewriter.h"
 #include "main/PdfPostScriptTokenizer.h"
 #include "main/PdfData.h"
 #include "main/PdfDate.h"
@@ -55,6 +56,8 @@
 #include "main/PdfSigner.h"
 #include "main/PdfSignerCms.h"
 #include "main/PdfSigningContext.h"
+#include "main/PdfSignatureVerifier.h"
+#include "main/PdfPasswordAuthenticator.h"
 #include "main/PdfObjectStream.h"
 #include "main/PdfString.h"
 #include "main/PdfTokenizer.h"
@@ -67,6 +70,7 @@
 #include "main/PdfAnnotationWidget.h"
 #include "main/PdfContents.h"
 #include "main/PdfDestination.h"
+#include "main/PdfDetachedCanvas.h"
 #include "main/PdfDocument.h"
 #include "main/PdfElement.h"
 #include "main/PdfExtGState.h"
@@ -95,6 +99,7 @@
 #include "main/PdfImage.h"
 #include "main/PdfInfo.h"
 #include "main/PdfMemDocument.h"
+#include "main/PdfIncrementalEditor.h"
 #include "main/PdfNameTrees.h"
 #include "main/PdfOutlines.h"
 #include "main/PdfPage.h"
@@ -42,6 +42,9 @@ static uint32_t GetTableCheksum(const char* buf, uint32_t size);
 
 static bool TryAdvanceCompoundOffset(unsigned& offset, unsigned flags);
 
+static unsigned GetCMapFormat4Length(const map<uint16_t, uint16_t>& mappings);
+static void WriteCMapFormat4(OutputStream& output, const map<uint16_t, uint16_t>& mappings);
+
 FontTrueTypeSubset::FontTrueTypeSubset(InputStreamDevice& device, const PdfFontMetrics& metrics) :
     m_device(&device),
     m_metrics(&metrics),
@@ -50,7 +53,8 @@ FontTrueTypeSubset::FontTrueTypeSubset(InputStreamDevice& device, const PdfFontM
     m_HMetricsCount(0),
     m_unitsPerEM(0),
     m_hmtxTableOffset(0),
-    m_leftSideBearingsOffset(0)
+    m_leftSideBearingsOffset(0),
+    m_writeCMap(false)
 {
 }
 
@@ -67,6 +71,30 @@ void FontTrueTypeSubset::BuildFont(const PdfFontMetrics& metrics, const cspan<Pd
     subset.buildFont(infos, output);
 }
 
+void FontTrueTypeSubset::BuildFontSimple(const PdfFontMetrics& metrics, const cspan<PdfCharGIDInfo>& infos,
+    const cspan<char32_t>& codePoints, charbuff& output)
+{
+    if (infos.empty())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "The cid/gid map must not be empty");
+
+    if (codePoints.size() != infos.size())
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidInput, "The code points must match the cid/gid map");
+
+    if (metrics.GetFontFileType() != PdfFontFileType::TrueType)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidFontData, "The font to be subsetted is not a TrueType font");
+
+    SpanStreamDevice input(metrics.GetOrLoadFontFileData());
+    FontTrueTypeSubset subset(input, metrics);
+    subset.m_writeCMap = true;
+    for (unsigned i = 0; i < infos.size(); i++)
+    {
+        // NOTE: Glyphs of the infos follow glyph 0 in the subset
+        subset.m_charCodeMappings.push_back({ infos[i].OrigCid, codePoints[i], i + 1 });
+    }
+
+    subset.buildFont(infos, output);
+}
+
 void FontTrueTypeSubset::buildFont(const cspan<PdfCharGIDInfo>& infos, charbuff& output)
 {
     init();
@@ -89,6 +117,20 @@ void FontTrueTypeSubset::init()
     initTables();
     getNumberOfGlyphs();
     determineLongLocaTable();
+    if (m_writeCMap)
+        initCMapTable();
+}
+
+void FontTrueTypeSubset::initCMapTable()
+{
+    // The 'cmap' table of the original font is never copied: add
+    // a new one keeping the tables sorted by tag, as it's required
+    // by the table directory
+    TrueTypeTable tbl;
+    tbl.Tag = TTAG_cmap;
+    auto it = std::lower_bound(m_tables.begin(), m_tables.end(), tbl,
+        [](const TrueTypeTable& lhs, const TrueTypeTable& rhs) { return lhs.Tag < rhs.Tag; });
+    m_tables.insert(it, tbl);
 }
 
 unsigned FontTrueTypeSubset::getTableOffset(unsigned tag)
@@ -404,6 +446,59 @@ void FontTrueTypeSubset::writeHmtxTable(OutputStream& output)
     }
 }
 
+// Write a 'cmap' table with the (1,0), (3,0) and (3,1) subtables,
+// which are the ones looked up in simple TrueType fonts, see
+// ISO 32000-2:2020 9.6.5.4 "Encodings for TrueType fonts"
+// Ref: https://learn.microsoft.com/en-us/typography/opentype/spec/cmap
+void FontTrueTypeSubset::writeCMapTable(OutputStream& output)
+{
+    // Macintosh Roman subtable, mapping char codes directly
+    char macGlyphs[256] = { };
+    // Microsoft Symbol subtable, mapping char codes in the 0xF000-0xF0FF range
+    map<uint16_t, uint16_t> symbolMappings;
+    // Microsoft Unicode BMP subtable
+    map<uint16_t, uint16_t> unicodeMappings;
+    for (auto& mapping : m_charCodeMappings)
+    {
+        if (mapping.Code > 0xFF)
+            continue;
+
+        if (mapping.GlyphIndex <= 0xFF)
+            macGlyphs[mapping.Code] = (char)mapping.GlyphIndex;
+
+        symbolMappings.insert({ (uint16_t)(0xF000 | mapping.Code), (uint16_t)mapping.GlyphIndex });
+        if (mapping.CodePoint != U'\0' && mapping.CodePoint < 0xFFFF)
+            unicodeMappings.insert({ (uint16_t)mapping.CodePoint, (uint16_t)mapping.GlyphIndex });
+    }
+
+    constexpr unsigned SubtableCount = 3;
+    constexpr unsigned MacSubtableLength = 3 * sizeof(uint16_t) + 256;
+    unsigned macOffset = 2 * sizeof(uint16_t) + SubtableCount * (2 * sizeof(uint16_t) + sizeof(uint32_t));
+    unsigned symbolOffset = macOffset + MacSubtableLength;
+    unsigned unicodeOffset = symbolOffset + GetCMapFormat4Length(symbolMappings);
+
+    utls::WriteUInt16BE(output, 0);                 // version
+    utls::WriteUInt16BE(output, SubtableCount);
+    utls::WriteUInt16BE(output, 1);                 // platformID, Macintosh
+    utls::WriteUInt16BE(output, 0);                 // encodingID, Roman
+    utls::WriteUInt32BE(output, macOffset);
+    utls::WriteUInt16BE(output, 3);                 // platformID, Windows
+    utls::WriteUInt16BE(output, 0);                 // encodingID, Symbol
+    utls::WriteUInt32BE(output, symbolOffset);
+    utls::WriteUInt16BE(output, 3);                 // platformID, Windows
+    utls::WriteUInt16BE(output, 1);                 // encodingID, Unicode BMP
+    utls::WriteUInt32BE(output, unicodeOffset);
+
+    // Format 0: Byte encoding table
+    utls::WriteUInt16BE(output, 0);                 // format
+    utls::WriteUInt16BE(output, MacSubtableLength);
+    utls::WriteUInt16BE(output, 0);                 // language
+    output.Write(macGlyphs, std::size(macGlyphs));
+
+    WriteCMapFormat4(output, symbolMappings);
+    WriteCMapFormat4(output, unicodeMappings);
+}
+
 // "The 'loca' table stores the offsets to the locations
 // of the glyphs in the font relative to the beginning of
 // the 'glyf' table. [..] To make it possible to compute
@@ -514,6 +609,9 @@ void FontTrueTypeSubset::writeTables(charbuff& buffer)
             case TTAG_hmtx:
                 writeHmtxTable(output);
                 break;
+            case TTAG_cmap:
+                writeCMapTable(output);
+                break;
             case TTAG_cvt:
             case TTAG_fpgm:
             case TTAG_prep:
@@ -580,6 +678,51 @@ bool TryAdvanceCompoundOffset(unsigned& offset, unsigned flags)
     return true;
 }
 
+unsigned GetCMapFormat4Length(const map<uint16_t, uint16_t>& mappings)
+{
+    // Header, reservedPad and 4 arrays of one item per segment
+    unsigned segCount = (unsigned)mappings.size() + 1;
+    return 8 * sizeof(uint16_t) + 4 * sizeof(uint16_t) * segCount;
+}
+
+// Format 4: Segment mapping to delta values. Write one segment
+// per mapping, plus the final segment required by the specification
+// Ref: https://learn.microsoft.com/en-us/typography/opentype/spec/cmap#format-4-segment-mapping-to-delta-values
+void WriteCMapFormat4(OutputStream& output, const map<uint16_t, uint16_t>& mappings)
+{
+    unsigned segCount = (unsigned)mappings.size() + 1;
+    uint16_t entrySelector = (uint16_t)std::floor(std::log2(segCount));
+    uint16_t searchRange = (uint16_t)(2 * (1u << entrySelector));
+    utls::WriteUInt16BE(output, 4);                 // format
+    utls::WriteUInt16BE(output, (uint16_t)GetCMapFormat4Length(mappings));
+    utls::WriteUInt16BE(output, 0);                 // language
+    utls::WriteUInt16BE(output, (uint16_t)(2 * segCount));
+    utls::WriteUInt16BE(output, searchRange);
+    utls::WriteUInt16BE(output, entrySelector);
+    utls::WriteUInt16BE(output, (uint16_t)(2 * segCount - searchRange));
+
+    // endCode
+    for (auto& pair : mappings)
+        utls::WriteUInt16BE(output, pair.first);
+    utls::WriteUInt16BE(output, 0xFFFF);
+
+    utls::WriteUInt16BE(output, 0);                 // reservedPad
+
+    // startCode
+    for (auto& pair : mappings)
+        utls::WriteUInt16BE(output, pair.first);
+    utls::WriteUInt16BE(output, 0xFFFF);
+
+    // idDelta, which is added modulo 65536 to the char code
+    for (auto& pair : mappings)
+        utls::WriteUInt16BE(output, (uint16_t)(pair.second - pair.first));
+    utls::WriteUInt16BE(output, 1);
+
+    // idRangeOffset
+    for (unsigned i = 0; i < segCount; i++)
+        utls::WriteUInt16BE(output, 0);
+}
+
 void FontTrueTypeSubset::copyData(OutputStream& output, unsigned offset, unsigned size)
 {
     m_device->Seek(offset);
@@ -30,6 +30,17 @@ public:
     /// @param infos a list of glyphs to subset
     static void BuildFont(const PdfFontMetrics& metrics, const cspan<PdfCharGIDInfo>& infos, charbuff& output);
 
+    /// Generate a subsetted font to be used by a simple, non CID-keyed,
+    /// font dictionary. A 'cmap' table is written mapping the char codes
+    /// to the glyphs, as they will appear in the subset
+    ///
+    /// @param metrics the metrics of the font to subset
+    /// @param infos a list of glyphs to subset. PdfCharGIDInfo::OrigCid is the char code
+    /// @param codePoints the unicode code points mapped by each char code, or U'\0'
+    /// @param output write the font to this buffer
+    static void BuildFontSimple(const PdfFontMetrics& metrics, const cspan<PdfCharGIDInfo>& infos,
+        const cspan<char32_t>& codePoints, charbuff& output);
+
 private:
     FontTrueTypeSubset(const FontTrueTypeSubset& rhs) = delete;
     FontTrueTypeSubset& operator=(const FontTrueTypeSubset& rhs) = delete;
@@ -37,6 +48,7 @@ private:
     void buildFont(const cspan<PdfCharGIDInfo>& infos, charbuff& output);
 
     void init();
+    void initCMapTable();
     unsigned getTableOffset(unsigned tag);
     void getNumberOfGlyphs();
     void determineLongLocaTable();
@@ -92,6 +104,7 @@ private:
     void writeGlyphTable(OutputStream& output);
     void writeHmtxTable(OutputStream& output);
     void writeLocaTable(OutputStream& output);
+    void writeCMapTable(OutputStream& output);
     void writeTables(charbuff& output);
     void readGlyphCompoundData(GlyphCompoundData& data, unsigned offset);
 
@@ -110,6 +123,14 @@ private:
         LongHorMetrics Metrics;
     };
 
+    /// A char code of a simple font, mapped to a glyph of the subset
+    struct CharCodeMapping
+    {
+        unsigned Code = 0;
+        char32_t CodePoint = U'\0';
+        unsigned GlyphIndex = 0;
+    };
+
 private:
     InputStreamDevice* m_device;
     const PdfFontMetrics* m_metrics;
@@ -125,6 +146,9 @@ private:
     GlyphDatas m_glyphDatas;
     // Ordered list GIDs as they will appear in the subset with their metrics
     std::vector<GIDInfo> m_subsetGIDs;
+    // Char codes to be written in the 'cmap' table, for simple fonts only
+    std::vector<CharCodeMapping> m_charCodeMappings;
+    bool m_writeCMap;
     charbuff m_tmpBuffer;
 };
 
@@ -3,6 +3,7 @@
 
 #include "PdfDeclarationsPrivate.h"
 #include "FreetypePrivate.h"
+#include "OpenSSLInternal.h"
 
 #include <atomic>
 
@@ -15,6 +16,8 @@ using namespace std;
 using namespace PoDoFo;
 
 constexpr unsigned TableDirectoryFixedSize = 12;
+// The size of the face pool that triggers the first purge of the released faces
+constexpr size_t MinFacePoolPurgeSize = 64;
 
 namespace
 {
@@ -46,6 +49,9 @@ namespace
     struct FT_LibraryPtr
     {
         FT_Library Ptr = nullptr;
+        // Serializes the creation and destruction of faces,
+        // since the library is shared between threads
+        mutex Mutex;
 
         void Ref();
         void Unref();
@@ -53,38 +59,64 @@ namespace
     private:
         std::atomic<size_t> m_count = 1;
     };
+
+    // A face in the face pool, with the data it's loaded from
+    struct PooledFace
+    {
+        PooledFace() : Face(nullptr, FT::FreeFace) { }
+
+        shared_ptr<const charbuff> Data;
+        FT::FT_FacePtr Face;
+    };
+
+    // Data attached to the faces created with a mutex,
+    // deleted by FreeType when the face is destroyed
+    struct FaceData
+    {
+        recursive_mutex Mutex;
+        unique_ptr<FT::FaceShapingData> ShapingData;
+    };
+
+    struct FacePool
+    {
+        mutex Mutex;
+        unordered_map<string, weak_ptr<PooledFace>> Faces;
+        // Pooled faces by the address of their data
+        unordered_map<const char*, weak_ptr<PooledFace>> FacesByData;
+        // The entries of the released faces are purged when the pool
+        // reaches this size, so the purge cost is amortized on insertions
+        size_t PurgeSize = MinFacePoolPurgeSize;
+    };
 }
 
 static PdfFontFileType determineFormatCFF(FT_Face face);
 static unsigned determineFaceSize(FT_Face face, vector<TableInfo>& tables, unsigned& tableDirSize);
 static FT::FT_FacePtr createFaceFromBuffer(const bufferview& view, unsigned faceIndex, bool bare = false);
+static shared_ptr<FT_FaceRec_> getOrCreatePooledFace(const bufferview& view, charbuff* data,
+    shared_ptr<const charbuff>& pooledData);
+static void purgeFacePool(FacePool& pool);
 static bool isTTCFont(FT_Face face);
 static bool isTTCFont(const bufferview& face);
 static bool tryExtractDataFromTTC(FT_Face face, charbuff& buffer);
 static void getDataFromFace(FT_Face face, charbuff& buffer);
 static FT_LibraryPtr& getLibrary();
+static FacePool& getFacePool();
 static void freeFaceBare(FT_Face face);
 static void noOpFace(FT_Face face);
+static void deleteFaceData(void* object);
 
-FT::FT_FacePtr FT::CreateFaceFromBuffer(const bufferview& view, unsigned faceIndex,
-    charbuff& buffer)
+void FT::ReadFaceDataFromBuffer(const bufferview& view, unsigned faceIndex, charbuff& buffer)
 {
     if (isTTCFont(view))
     {
-        auto face = createFaceFromBuffer(view, faceIndex, true);
         // Try to extract data from the TTC font, or just copy
         // existing view to buffer if it fails
-        if (!tryExtractDataFromTTC(face.get(), buffer))
-            buffer = view;
-
-        // Unconditionally re-create the face from the copied buffer
-        return createFaceFromBuffer(buffer, 0);
-    }
-    else
-    {
-        buffer = view;
-        return createFaceFromBuffer(buffer, 0);
+        auto face = createFaceFromBuffer(view, faceIndex, true);
+        if (face != nullptr && tryExtractDataFromTTC(face.get(), buffer))
+            return;
     }
+
+    buffer = view;
 }
 
 FT::FT_FacePtr FT::ExtractCFFFont(FT_Face face, charbuff& buffer)
@@ -111,21 +143,42 @@ void FT::FreeFace(FT_Face face)
     // NOTE: Store the hidden library pointer before freeing the face
     auto lib = static_cast<FT_LibraryPtr*>(face->extensions);
 
-    FT_Done_Face(face);
+    {
+        unique_lock<mutex> lock(lib->Mutex);
+        FT_Done_Face(face);
+    }
 
     // Dereference the hidden library pointer
     lib->Unref();
 }
 
-void FT::ReferenceFace(FT_Face face)
+recursive_mutex& FT::GetFaceMutex(FT_Face face)
 {
-    // Reference the hidden library pointer
-    static_cast<FT_LibraryPtr*>(face->extensions)->Ref();
-    FT_Reference_Face(face);
+    if (face->generic.data == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The face was not created with a mutex");
+
+    return static_cast<FaceData*>(face->generic.data)->Mutex;
 }
 
-FT::FT_FacePtr FT::CreateFaceFromFile(const string_view& filepath, unsigned faceIndex,
-    charbuff& buffer)
+unique_ptr<FT::FaceShapingData>& FT::GetFaceShapingData(FT_Face face)
+{
+    if (face->generic.data == nullptr)
+        PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidHandle, "The face was not created with a mutex");
+
+    return static_cast<FaceData*>(face->generic.data)->ShapingData;
+}
+
+shared_ptr<FT_FaceRec_> FT::GetOrCreatePooledFace(const bufferview& data, shared_ptr<const charbuff>& pooledData)
+{
+    return getOrCreatePooledFace(data, nullptr, pooledData);
+}
+
+shared_ptr<FT_FaceRec_> FT::GetOrCreatePooledFace(charbuff&& data, shared_ptr<const charbuff>& pooledData)
+{
+    return getOrCreatePooledFace(data, &data, pooledData);
+}
+
+bool FT::TryReadFaceDataFromFile(const string_view& filepath, unsigned faceIndex, charbuff& buffer)
 {
     utls::ReadTo(buffer, filepath, sizeof(TTAG_ttcf));
     if (isTTCFont(buffer))
@@ -133,21 +186,23 @@ FT::FT_FacePtr FT::CreateFaceFromFile(const string_view& filepath, unsigned face
         auto& lib = getLibrary();
         FT_Error rc;
         FT_Face face;
-        rc = FT_New_Face(lib.Ptr, filepath.data(), faceIndex, &face);
+        {
+            unique_lock<mutex> lock(lib.Mutex);
+            rc = FT_New_Face(lib.Ptr, filepath.data(), faceIndex, &face);
+        }
         if (rc != 0)
-            return FT_FacePtr(nullptr, FT::FreeFace);
+            return false;
 
-        unique_ptr<struct FT_FaceRec_, decltype(&FT_Done_Face)> face_(face, FT_Done_Face);
+        FT_FacePtr face_(face, freeFaceBare);
 
-        // Try to extract data from the TTC font and re-create the face
+        // Try to extract data from the TTC font
         if (tryExtractDataFromTTC(face, buffer))
-            return createFaceFromBuffer(buffer, 0);
+            return true;
     }
 
-    // Unconditionally copy the font file and create
-    // the face from the copied buffer
+    // Unconditionally copy the font file
     utls::ReadTo(buffer, filepath);
-    return createFaceFromBuffer(buffer, 0);
+    return true;
 }
 
 charbuff FT::GetDataFromFace(FT_Face face)
@@ -211,6 +266,7 @@ unordered_map<string_view, unsigned> FT::GetPostMap(FT_Face face)
     if (!FT_HAS_GLYPH_NAMES(face))
         return ret;
 
+    unique_lock<recursive_mutex> lock(GetFaceMutex(face));
     FT_Error rc;
     char buffer[64];
     for (FT_Long i = 0; i < face->num_glyphs; i++)
@@ -225,6 +281,101 @@ unordered_map<string_view, unsigned> FT::GetPostMap(FT_Face face)
     return ret;
 }
 
+/// @param data the data to be moved to the pool, or nullptr to copy the view
+shared_ptr<FT_FaceRec_> getOrCreatePooledFace(const bufferview& view, charbuff* data,
+    shared_ptr<const charbuff>& pooledData)
+{
+    auto& pool = getFacePool();
+    {
+        // NOTE: The data of a face still pooled is alive,
+        // so its address can't be reused by other data
+        unique_lock<mutex> lock(pool.Mutex);
+        auto found = pool.FacesByData.find(view.data());
+        if (found != pool.FacesByData.end())
+        {
+            auto pooled = found->second.lock();
+            if (pooled != nullptr && pooled->Data->size() == view.size())
+            {
+                pooledData = pooled->Data;
+                return shared_ptr<FT_FaceRec_>(pooled, pooled->Face.get());
+            }
+        }
+    }
+
+    auto digest = ssl::ComputeHash(view, PdfHashingAlgorithm::SHA256);
+    string key(digest.data(), digest.size());
+    {
+        unique_lock<mutex> lock(pool.Mutex);
+        auto found = pool.Faces.find(key);
+        if (found != pool.Faces.end())
+        {
+            auto pooled = found->second.lock();
+            if (pooled != nullptr)
+            {
+                pooledData = pooled->Data;
+                return shared_ptr<FT_FaceRec_>(pooled, pooled->Face.get());
+            }
+        }
+    }
+
+    // NOTE: Create the face outside the pool lock
+    auto pooled = std::make_shared<PooledFace>();
+    if (data == nullptr)
+        pooled->Data = std::make_shared<charbuff>(view);
+    else
+        pooled->Data = std::make_shared<charbuff>(std::move(*data));
+
+    pooled->Face = createFaceFromBuffer(*pooled->Data, 0);
+    if (pooled->Face == nullptr)
+    {
+        pooledData = nullptr;
+        return nullptr;
+    }
+
+    unique_lock<mutex> lock(pool.Mutex);
+    auto& entry = pool.Faces[key];
+    auto existing = entry.lock();
+    if (existing == nullptr)
+    {
+        entry = pooled;
+        pool.FacesByData[pooled->Data->data()] = pooled;
+        if (pool.Faces.size() >= pool.PurgeSize)
+            purgeFacePool(pool);
+    }
+    else
+    {
+        // Another thread pooled the same face
+        // in the meantime: keep the first one
+        pooled = std::move(existing);
+    }
+
+    pooledData = pooled->Data;
+    return shared_ptr<FT_FaceRec_>(pooled, pooled->Face.get());
+}
+
+// Purge the entries of the released faces
+void purgeFacePool(FacePool& pool)
+{
+    for (auto it = pool.Faces.begin(); it != pool.Faces.end(); )
+    {
+        if (it->second.expired())
+            it = pool.Faces.erase(it);
+        else
+            it++;
+    }
+
+    for (auto it = pool.FacesByData.begin(); it != pool.FacesByData.end(); )
+    {
+        if (it->second.expired())
+            it = pool.FacesByData.erase(it);
+        else
+            it++;
+    }
+
+    // Purge again when the pool doubles the faces still alive
+    pool.PurgeSize = std::max(MinFacePoolPurgeSize, pool.Faces.size() * 2);
+}
+
 /// @param bare True if the smart pointerF
 FT::FT_FacePtr createFaceFromBuffer(const bufferview& view, unsigned faceIndex, bool bare)
 {
@@ -238,7 +389,10 @@ FT::FT_FacePtr createFaceFromBuffer(const bufferview& view, unsigned faceIndex,
 
     auto& lib = getLibrary();
     FT_Face face;
-    rc = FT_Open_Face(lib.Ptr, &openArgs, faceIndex, &face);
+    {
+        unique_lock<mutex> lock(lib.Mutex);
+        rc = FT_Open_Face(lib.Ptr, &openArgs, faceIndex, &face);
+    }
     if (rc != 0)
         return FT::FT_FacePtr(nullptr, noOpFace);
 
@@ -254,6 +408,10 @@ FT::FT_FacePtr createFaceFromBuffer(const bufferview& view, unsigned faceIndex,
         // dereferenced with FT::FreeFace
         lib.Ref();
         face->extensions = &lib;
+        // Install the mutex serializing the access to the face,
+        // deleted by FreeType when the face is destroyed
+        face->generic.data = new FaceData();
+        face->generic.finalizer = deleteFaceData;
         return FT::FT_FacePtr(face, FT::FreeFace);
     }
 }
@@ -407,29 +565,41 @@ FT_LibraryPtr& getLibrary()
 {
     struct Init
     {
-        Init()
+        Init() : Library(new FT_LibraryPtr())
         {
             // Initialize all the fonts stuff
-            if (FT_Init_FreeType(&Library.Ptr))
+            if (FT_Init_FreeType(&Library->Ptr))
                 PODOFO_RAISE_ERROR(PdfErrorCode::FreeTypeError);
         }
 
         ~Init()
         {
-            // Dereference the library on thread exit
-            Library.Unref();
+            // Dereference the library on exit. NOTE: The handle
+            // is never deleted, since faces still referencing
+            // the library may be freed later
+            Library->Unref();
         }
 
-        FT_LibraryPtr Library;     // Handle to the freetype library
+        FT_LibraryPtr* Library;     // Handle to the freetype library
     };
 
-    thread_local Init init;
-    return init.Library;
+    // NOTE: A single library is shared between all threads,
+    // so faces can be shared between threads as well
+    static Init init;
+    return *init.Library;
+}
+
+FacePool& getFacePool()
+{
+    static FacePool s_pool;
+    return s_pool;
 }
 
 void freeFaceBare(FT_Face face)
 {
     // Just call the bare FT free face function
+    auto& lib = getLibrary();
+    unique_lock<mutex> lock(lib.Mutex);
     (void)FT_Done_Face(face);
 }
 
@@ -439,6 +609,12 @@ void noOpFace(FT_Face face)
     // Do nothing
 }
 
+void deleteFaceData(void* object)
+{
+    auto face = static_cast<FT_Face>(object);
+    delete static_cast<FaceData*>(face->generic.data);
+}
+
 void FT_LibraryPtr::Ref()
 {
     // It's a normal counter that just get incremented and
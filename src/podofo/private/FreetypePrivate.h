@@ -10,6 +10,8 @@
 
 #include <podofo/main/PdfDeclarations.h>
 
+#include <mutex>
+
 #define CHECK_FT_RC(rc, func) if (rc != 0)\
     PODOFO_RAISE_ERROR_INFO(PdfErrorCode::FreeTypeError, "Function " #func " failed")
 
@@ -18,26 +20,57 @@ namespace FT
     /// Use this function instead to free a face handled by a FT_FacePtr
     void FreeFace(FT_Face face);
 
-    /// Use this function instead to reference a face handled by a FT_FacePtr
-    void ReferenceFace(FT_Face face);
+    /// Get the mutex that serializes the access to a face created by the
+    /// helpers in this header. Faces can be shared between threads, but
+    /// glyph loading, charmap selection and table loading must be
+    /// performed by one thread at a time. It's recursive, so helpers
+    /// lock it also when called by code that's already holding it
+    std::recursive_mutex& GetFaceMutex(FT_Face face);
+
+    /// Data attached by text shaping to a face, such as
+    /// the shaper objects, destroyed with the face
+    struct FaceShapingData
+    {
+        virtual ~FaceShapingData() { }
+    };
+
+    /// Get the shaping data attached to a face created with a mutex,
+    /// see GetFaceMutex(). The face mutex must be held to access it
+    std::unique_ptr<FaceShapingData>& GetFaceShapingData(FT_Face face);
 
     /// An unique smart pointer to be returned by helpers in this header
     /// It implies faces will be freed with the specialized function FT::FreeFace
     using FT_FacePtr = std::unique_ptr<FT_FaceRec_, decltype(&FreeFace)>;
 
-    /// @param buffer a copy of the buffer from which the face will be loaded.
-    /// It must be retained
-    FT_FacePtr CreateFaceFromFile(const std::string_view& filepath, unsigned faceIndex,
+    /// Read the data of a single face from a font file,
+    /// extracting it if the file is a font collection
+    /// @returns false if the font collection can't be opened
+    bool TryReadFaceDataFromFile(const std::string_view& filepath, unsigned faceIndex,
         PoDoFo::charbuff& buffer);
-    /// @param buffer a copy of the buffer from which the face will be loaded.
-    /// It must be retained
-    FT_FacePtr CreateFaceFromBuffer(const PoDoFo::bufferview& view, unsigned faceIndex,
+    /// Get the data of a single face from font data,
+    /// extracting it if the data is a font collection
+    void ReadFaceDataFromBuffer(const PoDoFo::bufferview& view, unsigned faceIndex,
         PoDoFo::charbuff& buffer);
     // Extract a CFF table from a OpenType CFF font
     FT_FacePtr ExtractCFFFont(FT_Face face, PoDoFo::charbuff& buffer);
     // No check for TTC fonts
     FT_FacePtr CreateFaceFromBuffer(const PoDoFo::bufferview& view);
     PoDoFo::charbuff GetDataFromFace(FT_Face face);
+
+    /// Get a face from the process-wide pool of faces, keyed by the
+    /// SHA-256 digest of the font data, or create it. The data of
+    /// pooled faces is recognized by its address without hashing it
+    /// again, as when creating metrics from other metrics. Faces are shared
+    /// by all the metrics loading the same font data, and they are
+    /// released when no more referenced
+    /// @param data a single face font data. It's copied if the face is not pooled
+    /// @param pooledData the data the face is loaded from, owned by the pool
+    /// @returns the face, or nullptr if it can't be created
+    std::shared_ptr<FT_FaceRec_> GetOrCreatePooledFace(const PoDoFo::bufferview& data,
+        std::shared_ptr<const PoDoFo::charbuff>& pooledData);
+    /// @param data a single face font data. It's moved to the pool if the face is not pooled
+    std::shared_ptr<FT_FaceRec_> GetOrCreatePooledFace(PoDoFo::charbuff&& data,
+        std::shared_ptr<const PoDoFo::charbuff>& pooledData);
     bool TryGetFontFileFormat(FT_Face face, PoDoFo::PdfFontFileType& format);
     bool IsPdfSupported(FT_Face face);
     std::unordered_map<std::string_view, unsigned> GetPostMap(FT_Face face);
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include "PdfDeclarationsPrivate.h"
+
+#ifdef PODOFO_HAVE_HARFBUZZ
+
+#include "HarfBuzzShaping.h"
+
+#include <hb.h>
+#include <hb-ft.h>
+
+#include <podofo/main/PdfFont.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+namespace
+{
+    /// The HarfBuzz objects of a face, created on first shaping
+    struct HarfBuzzFaceData final : FT::FaceShapingData
+    {
+        HarfBuzzFaceData(FT_Face face);
+        ~HarfBuzzFaceData();
+
+        hb_face_t* Face;
+        hb_font_t* Font;
+    };
+}
+
+static void parseFeatures(const string_view& features, vector<hb_feature_t>& parsed);
+static hb_font_t* getOrCreateFont(FT_Face face);
+
+void PoDoFo::ShapeTextHarfBuzz(FT_Face face, const string_view& str,
+    const PdfTextShapingParams& params, vector<HarfBuzzGlyph>& glyphs)
+{
+    glyphs.clear();
+    if (str.empty())
+        return;
+
+    vector<hb_feature_t> features;
+    parseFeatures(params.Features, features);
+
+    auto hbFont = getOrCreateFont(face);
+    unique_ptr<hb_buffer_t, decltype(&hb_buffer_destroy)> buffer(hb_buffer_create(), hb_buffer_destroy);
+    hb_buffer_add_utf8(buffer.get(), str.data(), (int)str.size(), 0, (int)str.size());
+    if (!params.Script.empty())
+        hb_buffer_set_script(buffer.get(), hb_script_from_string(params.Script.data(), (int)params.Script.size()));
+    if (!params.Language.empty())
+        hb_buffer_set_language(buffer.get(), hb_language_from_string(params.Language.data(), (int)params.Language.size()));
+
+    hb_buffer_guess_segment_properties(buffer.get());
+    if (HB_DIRECTION_IS_VERTICAL(hb_buffer_get_direction(buffer.get())))
+        hb_buffer_set_direction(buffer.get(), HB_DIRECTION_LTR);
+
+    hb_shape(hbFont, buffer.get(), features.data(), (unsigned)features.size());
+
+    unsigned count;
+    auto infos = hb_buffer_get_glyph_infos(buffer.get(), &count);
+    auto positions = hb_buffer_get_glyph_positions(buffer.get(), &count);
+    glyphs.resize(count);
+    for (unsigned i = 0; i < count; i++)
+    {
+        auto& glyph = glyphs[i];
+        glyph.GID = infos[i].codepoint;
+        glyph.Cluster = infos[i].cluster;
+        glyph.XAdvance = positions[i].x_advance;
+        glyph.XOffset = positions[i].x_offset;
+        glyph.YOffset = positions[i].y_offset;
+    }
+}
+
+hb_font_t* getOrCreateFont(FT_Face face)
+{
+    // NOTE: The face mutex is held by the caller
+    auto& data = FT::GetFaceShapingData(face);
+    if (data == nullptr)
+        data.reset(new HarfBuzzFaceData(face));
+
+    return static_cast<HarfBuzzFaceData&>(*data).Font;
+}
+
+HarfBuzzFaceData::HarfBuzzFaceData(FT_Face face)
+{
+    // NOTE: The FreeType face is not referenced, since
+    // this data is destroyed together with it
+    Face = hb_ft_face_create(face, nullptr);
+    Font = hb_font_create(Face);
+    // Use unscaled positions, so they are returned in font units
+    int unitsPerEm = (int)hb_face_get_upem(Face);
+    hb_font_set_scale(Font, unitsPerEm, unitsPerEm);
+}
+
+HarfBuzzFaceData::~HarfBuzzFaceData()
+{
+    hb_font_destroy(Font);
+    hb_face_destroy(Face);
+}
+
+void parseFeatures(const string_view& features, vector<hb_feature_t>& parsed)
+{
+    size_t start = 0;
+    while (start < features.size())
+    {
+        size_t end = features.find(',', start);
+        if (end == string_view::npos)
+            end = features.size();
+
+        auto feature = features.substr(start, end - start);
+        start = end + 1;
+        if (feature.empty())
+            continue;
+
+        hb_feature_t hbFeature;
+        if (!hb_feature_from_string(feature.data(), (int)feature.size(), &hbFeature))
+            PODOFO_RAISE_ERROR_INFO(PdfErrorCode::InvalidDataType, "Invalid OpenType feature {}", feature);
+
+        parsed.push_back(hbFeature);
+    }
+}
+
+#endif // PODOFO_HAVE_HARFBUZZ
@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PODOFO_HARFBUZZ_SHAPING_H
+#define PODOFO_HARFBUZZ_SHAPING_H
+
+#include "FreetypePrivate.h"
+
+namespace PoDoFo
+{
+    struct PdfTextShapingParams;
+
+    /// A glyph output by HarfBuzz, with positions in font units
+    struct HarfBuzzGlyph final
+    {
+        unsigned GID;
+        unsigned Cluster;
+        int XAdvance;
+        int XOffset;
+        int YOffset;
+    };
+
+    /// Shape a utf8 string with the given face. The HarfBuzz objects
+    /// are created on first use and attached to the face, see
+    /// FT::GetFaceShapingData(). The face mutex must be held
+    /// @param glyphs the output glyphs, in visual order
+    void ShapeTextHarfBuzz(FT_Face face, const std::string_view& str,
+        const PdfTextShapingParams& params, std::vector<HarfBuzzGlyph>& glyphs);
+}
+
+#endif // PODOFO_HARFBUZZ_SHAPING_H
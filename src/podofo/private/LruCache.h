@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PODOFO_LRU_CACHE_H
+#define PODOFO_LRU_CACHE_H
+
+#include <podofo/main/PdfDeclarations.h>
+
+#include <list>
+#include <unordered_map>
+
+namespace PoDoFo
+{
+    /// A map with a maximum size, evicting the least recently used
+    /// entries first. Nothing is cached when the maximum size is 0
+    /// @remarks It's not synchronized: caches shared between
+    /// threads must be accessed holding a lock
+    template <typename TValue>
+    class LruCache final
+    {
+        using EntryList = std::list<std::pair<const std::string, TValue>>;
+
+    public:
+        LruCache(unsigned maxSize)
+            : m_MaxSize(maxSize) { }
+
+    public:
+        /// Find a value, marking it as the most recently used
+        TValue* Find(const std::string_view& key)
+        {
+            auto found = m_index.find(key);
+            if (found == m_index.end())
+                return nullptr;
+
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return &found->second->second;
+        }
+
+        /// Add a value, unless the key is present already. Values are
+        /// usually computed while not holding the lock of the cache,
+        /// so another thread may have added the same value in the
+        /// meantime: in that case the first value is kept
+        /// @returns the cached value, or nullptr if nothing is cached
+        TValue* Add(const std::string_view& key, TValue&& value)
+        {
+            auto found = Find(key);
+            if (found != nullptr)
+                return found;
+
+            return insert(key, std::move(value));
+        }
+
+        /// Add a value, replacing the value of the key if present
+        /// @returns the cached value, or nullptr if nothing is cached
+        TValue* Set(const std::string_view& key, TValue&& value)
+        {
+            auto found = Find(key);
+            if (found == nullptr)
+                return insert(key, std::move(value));
+
+            *found = std::move(value);
+            return found;
+        }
+
+        bool Erase(const std::string_view& key)
+        {
+            auto found = m_index.find(key);
+            if (found == m_index.end())
+                return false;
+
+            auto entry = found->second;
+            m_index.erase(found);
+            m_entries.erase(entry);
+            return true;
+        }
+
+        /// Erase the entries whose keys match the predicate
+        template <typename TPredicate>
+        void EraseIf(const TPredicate& predicate)
+        {
+            for (auto it = m_entries.begin(); it != m_entries.end(); )
+            {
+                if (predicate(it->first))
+                {
+                    m_index.erase(it->first);
+                    it = m_entries.erase(it);
+                }
+                else
+                {
+                    it++;
+                }
+            }
+        }
+
+        void Clear()
+        {
+            m_index.clear();
+            m_entries.clear();
+        }
+
+        /// Set the maximum size, evicting the exceeding entries
+        void SetMaxSize(unsigned maxSize)
+        {
+            m_MaxSize = maxSize;
+            while (m_entries.size() > maxSize)
+                evict();
+        }
+
+        unsigned GetMaxSize() const { return m_MaxSize; }
+
+        unsigned GetSize() const { return (unsigned)m_entries.size(); }
+
+    private:
+        TValue* insert(const std::string_view& key, TValue&& value)
+        {
+            if (m_MaxSize == 0)
+                return nullptr;
+
+            if (m_entries.size() == m_MaxSize)
+                evict();
+
+            m_entries.emplace_front(std::string(key), std::move(value));
+            // NOTE: The index keys view the keys of the entries
+            // list, which are stable until the entries are erased
+            m_index[m_entries.front().first] = m_entries.begin();
+            return &m_entries.front().second;
+        }
+
+        void evict()
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+
+    private:
+        unsigned m_MaxSize;
+        // The entries, most recently used first
+        EntryList m_entries;
+        std::unordered_map<std::string_view, typename EntryList::iterator> m_index;
+    };
+}
+
+#endif // PODOFO_LRU_CACHE_H
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_CHAR_CODE_MAP_TABLE_H
+#define PDF_CHAR_CODE_MAP_TABLE_H
+
+#include <podofo/main/PdfEncodingCommon.h>
+
+namespace PoDoFo
+{
+    /// A direct code unit mapping in a PdfCharCodeMapTable
+    struct PdfCharCodeTableMapping
+    {
+        uint32_t Code;
+        /// The mapped code point or, if CodePointCount > 1,
+        /// the offset of the code points in the table pool
+        uint32_t CodePoint;
+        uint8_t CodeSpaceSize;
+        uint8_t CodePointCount;
+    };
+
+    /// A range mapping in a PdfCharCodeMapTable, with a single code point destination
+    struct PdfCharCodeTableRange
+    {
+        uint32_t SrcCodeLo;
+        uint32_t DstCodeLo;
+        uint16_t Size;
+        uint8_t CodeSpaceSize;
+    };
+
+    /// Read-only tables backing a PdfCharCodeMap, that can be
+    /// queried in place. They are generated for predefined CMaps by
+    /// the "staging/BuildPredefinedCMaps.cpp" script
+    ///
+    /// Direct mappings are stored in the slots of a minimal perfect
+    /// hash: the displacement of the bucket of a code unit gives its
+    /// slot (see GetCharCodeTableSlot()). Ranges are sorted by their
+    /// lower code and, like CodeUnitRanges, are looked up regardless
+    /// of the code space size
+    struct PdfCharCodeMapTable
+    {
+        const PdfCharCodeTableMapping* Mappings;
+        unsigned MappingCount;
+        const uint32_t* Displacements;
+        unsigned DisplacementCount;
+        const PdfCharCodeTableRange* Ranges;
+        unsigned RangeCount;
+        const codepoint* CodePoints;
+    };
+
+    /// Hash a code unit with the given seed
+    constexpr uint32_t GetCharCodeTableHash(uint32_t code, uint8_t codeSpaceSize, uint32_t seed)
+    {
+        // MurmurHash3 64 bit finalizer
+        uint64_t hash = ((uint64_t)code | ((uint64_t)codeSpaceSize << 32))
+            ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ULL);
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+        return (uint32_t)hash;
+    }
+
+    /// Get the bucket of a code unit in a table with the given number of displacements
+    constexpr unsigned GetCharCodeTableBucket(uint32_t code, uint8_t codeSpaceSize, unsigned displacementCount)
+    {
+        return GetCharCodeTableHash(code, codeSpaceSize, 0) % displacementCount;
+    }
+
+    /// Get the slot of a code unit in a table, given the displacement of its bucket
+    constexpr unsigned GetCharCodeTableSlot(uint32_t code, uint8_t codeSpaceSize, uint32_t displacement, unsigned mappingCount)
+    {
+        return GetCharCodeTableHash(code, codeSpaceSize, displacement) % mappingCount;
+    }
+}
+
+#endif // PDF_CHAR_CODE_MAP_TABLE_H
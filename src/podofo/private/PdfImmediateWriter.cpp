@@ -78,7 +78,15 @@ void PdfImmediateWriter::finish()
 
 unique_ptr<PdfObjectStreamProvider> PdfImmediateWriter::CreateStream()
 {
-    return unique_ptr<PdfObjectStreamProvider>(new PdfStreamedObjectStream(*m_Device));
+    unique_ptr<PdfStreamedObjectStream> stream(new PdfStreamedObjectStream(*m_Device));
+
+    // NOTE: The encryption must be set before the output
+    // stream is requested, which happens before BeginAppendStream()
+    auto encrypt = GetEncrypt();
+    if (encrypt != nullptr)
+        stream->SetEncrypt(encrypt->GetEncrypt(), encrypt->GetContext());
+
+    return stream;
 }
 
 void PdfImmediateWriter::BeginAppendStream(PdfObjectStream& stream)
@@ -91,12 +99,6 @@ void PdfImmediateWriter::BeginAppendStream(PdfObjectStream& stream)
 
     m_OpenStream = true;
     auto encrypt = GetEncrypt();
-    if (encrypt != nullptr)
-    {
-        auto& streamedObjectStream = dynamic_cast<PdfStreamedObjectStream&>(stream.GetProvider());
-        streamedObjectStream.SetEncrypt(encrypt->GetEncrypt(), encrypt->GetContext());
-    }
-
     auto& obj = stream.GetParent();
 
     // Manually mark the object as in-use, as it won't be
@@ -123,8 +125,11 @@ void PdfImmediateWriter::BeginAppendStream(PdfObjectStream& stream)
 
 void PdfImmediateWriter::EndAppendStream(PdfObjectStream& stream)
 {
-    (void)stream;
     PODOFO_ASSERT(m_OpenStream);
+    auto streamedStream = dynamic_cast<PdfStreamedObjectStream*>(&stream.GetProvider());
+    if (streamedStream != nullptr)
+        streamedStream->FinishOutput();
+
     m_Device->Write("\nendstream\nendobj\n");
     m_Device->Flush();
     m_OpenStream = false;
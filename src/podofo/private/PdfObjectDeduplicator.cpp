@@ -0,0 +1,394 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include "PdfDeclarationsPrivate.h"
+#include "PdfObjectDeduplicator.h"
+#include "OpenSSLInternal.h"
+
+using namespace std;
+using namespace PoDoFo;
+
+constexpr unsigned NoNode = numeric_limits<unsigned>::max();
+
+static bool isMergeable(const PdfObject& obj);
+static bool isNotFollowedKey(const PdfName& key);
+
+namespace
+{
+    struct VisitItem
+    {
+        const PdfObject* Object;
+        const PdfName* Key;
+        char Close;
+    };
+}
+
+PdfObjectDeduplicator::PdfObjectDeduplicator(PdfDocument& doc)
+    : m_doc(&doc)
+{
+}
+
+void PdfObjectDeduplicator::AddPinnedObject(const PdfReference& ref)
+{
+    m_pinned.insert(ref);
+}
+
+unsigned PdfObjectDeduplicator::Execute()
+{
+    collectCandidates();
+    pinNodes();
+    unsigned classCount = refineClasses((unsigned)m_signatures.size());
+
+    // Choose a representative for every class, preferring pinned
+    // objects and then the lowest reference, for deterministic output
+    vector<unsigned> representatives(classCount, NoNode);
+    for (unsigned i = 0; i < m_nodes.size(); i++)
+    {
+        auto& node = m_nodes[i];
+        auto& representative = representatives[node.Class];
+        if (representative == NoNode)
+        {
+            representative = i;
+            continue;
+        }
+
+        auto& curr = m_nodes[representative];
+        if (node.Pinned != curr.Pinned)
+        {
+            if (node.Pinned)
+                representative = i;
+        }
+        else if (node.Object->GetIndirectReference() < curr.Object->GetIndirectReference())
+        {
+            representative = i;
+        }
+    }
+
+    unordered_map<PdfReference, PdfReference> replacements;
+    for (unsigned i = 0; i < m_nodes.size(); i++)
+    {
+        auto& node = m_nodes[i];
+        unsigned representative = representatives[node.Class];
+        if (representative == i || node.Pinned)
+            continue;
+
+        replacements[node.Object->GetIndirectReference()] =
+            m_nodes[representative].Object->GetIndirectReference();
+    }
+
+    if (replacements.size() == 0)
+        return 0;
+
+    for (auto obj : m_doc->GetObjects())
+        rewriteReferences(*obj, replacements);
+
+    rewriteReferences(m_doc->GetTrailer().GetObject(), replacements);
+    return (unsigned)replacements.size();
+}
+
+void PdfObjectDeduplicator::collectCandidates()
+{
+    // NOTE: Iterate by index, so the pages of loaded documents are loaded
+    auto& pages = m_doc->GetPages();
+    for (unsigned i = 0; i < pages.GetCount(); i++)
+    {
+        auto& dict = pages.GetPageAt(i).GetDictionary();
+        auto resources = dict.FindKeyParent("Resources");
+        if (resources != nullptr)
+        {
+            // Pages cache their resources, don't merge them away
+            if (resources->IsIndirect())
+                m_pinned.insert(resources->GetIndirectReference());
+
+            visitRoot(*resources);
+        }
+
+        auto annotsObj = dict.FindKey("Annots");
+        const PdfArray* annots;
+        if (annotsObj == nullptr || !annotsObj->TryGetArray(annots))
+            continue;
+
+        for (unsigned j = 0; j < annots->GetSize(); j++)
+        {
+            auto annot = annots->FindAt(j);
+            const PdfDictionary* annotDict;
+            if (annot == nullptr || !annot->TryGetDictionary(annotDict))
+                continue;
+
+            auto appearance = annotDict->FindKey("AP");
+            if (appearance != nullptr)
+                visitRoot(*appearance);
+        }
+    }
+
+    string signature;
+    vector<unsigned> children;
+    while (m_pending.size() != 0)
+    {
+        unsigned index = m_pending.back();
+        m_pending.pop_back();
+
+        // NOTE: Visiting may add nodes, don't hold node references
+        auto& obj = *m_nodes[index].Object;
+        signature.clear();
+        children.clear();
+        visitObject(obj, signature, children, true);
+        if (obj.HasStream())
+        {
+            auto data = obj.MustGetStream().GetCopy(true);
+            auto digest = ssl::ComputeHash(data, PdfHashingAlgorithm::SHA256);
+            signature.append("stream ");
+            signature.append(digest.data(), digest.size());
+        }
+
+        auto& node = m_nodes[index];
+        node.Children = children;
+        node.Class = getClassId(signature);
+    }
+}
+
+void PdfObjectDeduplicator::visitRoot(const PdfObject& obj)
+{
+    string signature;
+    vector<unsigned> children;
+    visitObject(obj, signature, children, false);
+}
+
+void PdfObjectDeduplicator::visitObject(const PdfObject& obj, string& signature,
+    vector<unsigned>& children, bool skipLength)
+{
+    // Serialize the object in a canonical form with an explicit
+    // stack, recording the candidates references in order
+    string temp;
+    vector<VisitItem> pending{ { &obj, nullptr, '\0' } };
+    while (pending.size() != 0)
+    {
+        auto item = pending.back();
+        pending.pop_back();
+        if (item.Close != '\0')
+        {
+            signature.push_back(item.Close);
+            continue;
+        }
+
+        if (item.Key != nullptr)
+        {
+            item.Key->ToString(temp);
+            signature.append(temp);
+            signature.push_back(' ');
+        }
+
+        auto& curr = *item.Object;
+        switch (curr.GetDataType())
+        {
+            case PdfDataType::Dictionary:
+            {
+                auto& dict = curr.GetDictionary();
+                signature.push_back('<');
+                pending.push_back({ nullptr, nullptr, '>' });
+                // Push in reverse order so keys are visited sorted
+                for (auto it = dict.end(); it != dict.begin(); )
+                {
+                    it--;
+                    // The /Length of a stream is implied by its data
+                    if (skipLength && &curr == &obj && it->first == "Length")
+                        continue;
+
+                    pending.push_back({ &it->second, &it->first, '\0' });
+                }
+                break;
+            }
+            case PdfDataType::Array:
+            {
+                auto& arr = curr.GetArray();
+                signature.push_back('[');
+                pending.push_back({ nullptr, nullptr, ']' });
+                for (unsigned i = arr.GetSize(); i > 0; i--)
+                    pending.push_back({ &arr[i - 1], nullptr, '\0' });
+                break;
+            }
+            case PdfDataType::Reference:
+            {
+                auto ref = curr.GetReference();
+                unsigned index;
+                if ((item.Key == nullptr || !isNotFollowedKey(*item.Key))
+                    && tryAddCandidate(ref, index))
+                {
+                    signature.append("@ ");
+                    children.push_back(index);
+                }
+                else
+                {
+                    // Compare other references by identity
+                    ref.ToString(temp);
+                    signature.append(temp);
+                    signature.push_back(' ');
+                }
+                break;
+            }
+            default:
+            {
+                curr.ToString(temp);
+                signature.append(temp);
+                signature.push_back(' ');
+                break;
+            }
+        }
+    }
+}
+
+bool PdfObjectDeduplicator::tryAddCandidate(const PdfReference& ref, unsigned& index)
+{
+    auto found = m_indices.find(ref);
+    if (found != m_indices.end())
+    {
+        index = found->second;
+        return true;
+    }
+
+    if (m_excluded.find(ref) != m_excluded.end())
+    {
+        index = NoNode;
+        return false;
+    }
+
+    auto obj = m_doc->GetObjects().GetObject(ref);
+    if (obj == nullptr || !isMergeable(*obj))
+    {
+        m_excluded.insert(ref);
+        index = NoNode;
+        return false;
+    }
+
+    index = (unsigned)m_nodes.size();
+    m_nodes.push_back({ obj, { }, 0, false });
+    m_indices[ref] = index;
+    m_pending.push_back(index);
+    return true;
+}
+
+unsigned PdfObjectDeduplicator::getClassId(const string& signature)
+{
+    return m_signatures.emplace(signature, (unsigned)m_signatures.size()).first->second;
+}
+
+void PdfObjectDeduplicator::pinNodes()
+{
+    vector<unsigned> pending;
+    for (auto& ref : m_pinned)
+    {
+        auto found = m_indices.find(ref);
+        if (found != m_indices.end())
+            pending.push_back(found->second);
+    }
+
+    while (pending.size() != 0)
+    {
+        auto& node = m_nodes[pending.back()];
+        pending.pop_back();
+        if (node.Pinned)
+            continue;
+
+        node.Pinned = true;
+        for (unsigned child : node.Children)
+            pending.push_back(child);
+    }
+}
+
+unsigned PdfObjectDeduplicator::refineClasses(unsigned classCount)
+{
+    // Split the classes by the classes of the referenced
+    // candidates, until no more splits happen
+    vector<unsigned> refined(m_nodes.size());
+    vector<unsigned> key;
+    while (true)
+    {
+        map<vector<unsigned>, unsigned> classes;
+        for (unsigned i = 0; i < m_nodes.size(); i++)
+        {
+            auto& node = m_nodes[i];
+            key.clear();
+            key.push_back(node.Class);
+            for (unsigned child : node.Children)
+                key.push_back(m_nodes[child].Class);
+
+            refined[i] = classes.emplace(key, (unsigned)classes.size()).first->second;
+        }
+
+        if (classes.size() == classCount)
+            return classCount;
+
+        classCount = (unsigned)classes.size();
+        for (unsigned i = 0; i < m_nodes.size(); i++)
+            m_nodes[i].Class = refined[i];
+    }
+}
+
+void PdfObjectDeduplicator::rewriteReferences(PdfObject& obj,
+    const unordered_map<PdfReference, PdfReference>& replacements)
+{
+    vector<PdfObject*> pending{ &obj };
+    while (pending.size() != 0)
+    {
+        auto curr = pending.back();
+        pending.pop_back();
+        switch (curr->GetDataType())
+        {
+            case PdfDataType::Reference:
+            {
+                auto found = replacements.find(curr->GetReference());
+                if (found != replacements.end())
+                    curr->SetReference(found->second);
+                break;
+            }
+            case PdfDataType::Array:
+            {
+                for (auto& child : curr->GetArray())
+                    pending.push_back(&child);
+                break;
+            }
+            case PdfDataType::Dictionary:
+            {
+                for (auto& pair : curr->GetDictionary())
+                    pending.push_back(&pair.second);
+                break;
+            }
+            default:
+            {
+                // Nothing to do
+                break;
+            }
+        }
+    }
+}
+
+bool isMergeable(const PdfObject& obj)
+{
+    const PdfDictionary* dict;
+    if (!obj.TryGetDictionary(dict))
+        return true;
+
+    // Fields and annotations, which may miss /Type
+    if (dict->HasKey("FT") || dict->FindKeyAsSafe<PdfName>("Subtype") == "Widget"
+        || (dict->HasKey("Subtype") && dict->HasKey("Rect")))
+    {
+        return false;
+    }
+
+    auto typeObj = dict->FindKey("Type");
+    const PdfName* type;
+    if (typeObj == nullptr || !typeObj->TryGetName(type))
+        return true;
+
+    // Objects with an identity in the document structure
+    return !(*type == "Page" || *type == "Pages" || *type == "Annot"
+        || *type == "Catalog" || *type == "OCG" || *type == "OCMD"
+        || *type == "StructElem" || *type == "StructTreeRoot"
+        || *type == "ObjStm" || *type == "XRef" || *type == "Sig");
+}
+
+bool isNotFollowedKey(const PdfName& key)
+{
+    // Back references to the structure owning the object
+    return key == "Parent" || key == "P";
+}
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PDF_OBJECT_DEDUPLICATOR_H
+#define PDF_OBJECT_DEDUPLICATOR_H
+
+#include <podofo/main/PdfDocument.h>
+
+namespace PoDoFo
+{
+    /// Merges identical indirect objects reachable from page resources
+    /// and annotation appearances, such as images, fonts and forms
+    ///
+    /// Objects are first grouped by a signature of their direct contents,
+    /// with references to other candidates replaced by placeholders, and
+    /// of their stream raw data digest. Groups are then refined by the
+    /// groups of the referenced candidates until stable, so identical
+    /// subgraphs are detected also in presence of reference cycles
+    class PdfObjectDeduplicator final
+    {
+    public:
+        PdfObjectDeduplicator(PdfDocument& doc);
+
+        /// Prevent the object, and all the objects reachable from it,
+        /// from being merged into other objects. They can still
+        /// replace identical objects that are not pinned
+        void AddPinnedObject(const PdfReference& ref);
+
+        /// Rewrite all references to duplicated objects
+        /// @returns the number of objects that have been merged,
+        /// which are now unreferenced
+        unsigned Execute();
+
+    private:
+        struct Node
+        {
+            PdfObject* Object;
+            std::vector<unsigned> Children;
+            unsigned Class;
+            bool Pinned;
+        };
+
+    private:
+        void collectCandidates();
+        void visitRoot(const PdfObject& obj);
+        void visitObject(const PdfObject& obj, std::string& signature,
+            std::vector<unsigned>& children, bool skipLength);
+        bool tryAddCandidate(const PdfReference& ref, unsigned& index);
+        unsigned getClassId(const std::string& signature);
+        void pinNodes();
+        unsigned refineClasses(unsigned classCount);
+        void rewriteReferences(PdfObject& obj,
+            const std::unordered_map<PdfReference, PdfReference>& replacements);
+
+    private:
+        PdfObjectDeduplicator(const PdfObjectDeduplicator&) = delete;
+        PdfObjectDeduplicator& operator=(const PdfObjectDeduplicator&) = delete;
+
+    private:
+        PdfDocument* m_doc;
+        std::vector<Node> m_nodes;
+        std::unordered_map<PdfReference, unsigned> m_indices;
+        std::unordered_set<PdfReference> m_excluded;
+        std::unordered_set<PdfReference> m_pinned;
+        std::unordered_map<std::string, unsigned> m_signatures;
+        std::vector<unsigned> m_pending;
+    };
+}
+
+#endif // PDF_OBJECT_DEDUPLICATOR_H
@@ -6,6 +6,7 @@
 #include "PdfParser.h"
 
 #include <algorithm>
+#include <thread>
 #include <numerics/checked_math.h>
 
 #include <podofo/auxiliary/OutputDevice.h>
@@ -17,12 +18,15 @@
 #include <podofo/main/PdfMemoryObjectStream.h>
 #include "PdfXRefStreamParserObject.h"
 #include "PdfObjectStreamParser.h"
+#include "WorkerPool.h"
 
 constexpr unsigned PDF_VERSION_LENGHT = 3;
 constexpr unsigned PDF_MAGIC_LENGHT = 8;
 constexpr unsigned PDF_XREF_ENTRY_SIZE = 20;
 constexpr unsigned MAX_XREF_SESSION_COUNT = 512;
 constexpr unsigned MaxXRefGenerationNum = 65535;
+// Bound the memory of the encrypted streams read before decrypting them
+constexpr size_t MaxDecryptBatchSize = 16 * 1024 * 1024;
 
 using namespace std;
 using namespace PoDoFo;
@@ -39,13 +43,21 @@ PdfParser::PdfParser(PdfIndirectObjectList& objects) :
     m_buffer(std::make_shared<charbuff>(PdfTokenizer::BufferSize)),
     m_tokenizer(m_buffer),
     m_LoadStreamsEagerly(false),
+    m_LoadObjectsOnDemand(false),
     m_Objects(&objects),
+    m_authenticator(nullptr),
     m_StrictParsing(false),
     m_SkipXRefRecovery(false)
 {
     this->init();
 }
 
+PdfParser::~PdfParser()
+{
+    if (m_device != nullptr)
+        m_Objects->SetObjectLoader(nullptr);
+}
+
 void PdfParser::init()
 {
     m_PdfVersion = PdfVersion::Unknown;
@@ -60,6 +72,7 @@ void PdfParser::init()
     m_Catalog = nullptr;
     m_Encrypt = nullptr;
     m_IncrementalUpdateCount = 0;
+    m_device = nullptr;
 }
 
 void PdfParser::Parse(InputStreamDevice& device)
@@ -84,7 +97,8 @@ void PdfParser::Parse(InputStreamDevice& device)
         // destructor will not be called
         if (e.GetCode() == PdfErrorCode::MaxRecursionReached
             || e.GetCode() == PdfErrorCode::InvalidPassword
-            || m_SkipXRefRecovery || !tryRebuildCrossReference(device))
+            || m_SkipXRefRecovery || m_LoadObjectsOnDemand
+            || !tryRebuildCrossReference(device))
         {
             throw;
         }
@@ -766,7 +780,9 @@ void PdfParser::ReadObjectEntries(InputStreamDevice& device)
 
         // Generate encryption keys
         m_Encrypt->GetEncrypt().Authenticate(m_Password, this->getDocumentId(), m_Encrypt->GetContext());
-        if (m_Encrypt->GetContext().GetAuthResult() == PdfAuthResult::Failed)
+        if (m_Encrypt->GetContext().GetAuthResult() == PdfAuthResult::Failed
+            && (m_authenticator == nullptr
+                || !(*m_authenticator)(m_Encrypt->GetEncrypt(), this->getDocumentId(), m_Encrypt->GetContext())))
         {
             // authentication failed so we need a password from the user.
             // The user can set the password using PdfParser::SetPassword
@@ -774,7 +790,30 @@ void PdfParser::ReadObjectEntries(InputStreamDevice& device)
         }
     }
 
-    ReadObjectsInternal(device);
+    if (m_LoadObjectsOnDemand)
+    {
+        // Just reserve the object numbers of the entries
+        // and defer the loading of the objects to lookups
+        m_device = &device;
+        if (m_entries.GetSize() != 0)
+            m_Objects->tryIncrementLastObjectNumber(m_entries.GetSize() - 1);
+
+        for (unsigned i = 1; i < m_entries.GetSize(); i++)
+        {
+            auto& entry = m_entries[i];
+            if (entry.Parsed && entry.Type == PdfXRefEntryType::Compressed
+                    && entry.ObjectNumber > 0 && entry.ObjectNumber < PdfParser::MaxObjectCount
+                    && (uint32_t)entry.ObjectNumber != i)
+                m_compressedObjects[(uint32_t)entry.ObjectNumber].insert(i);
+        }
+
+        m_Objects->SetObjectLoader(this);
+    }
+    else
+    {
+        ReadObjectsInternal(device);
+    }
+
     updateDocumentVersion();
 }
 
@@ -783,10 +822,6 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
     // Read objects
     vector<unsigned> compressedIndices;
     map<uint32_t, vector<uint32_t>> compressedObjects;
-    unique_ptr<PdfParserObject> obj;
-    PdfDictionary* dict;
-    PdfObject* typeObj;
-    const PdfName* name;
     if (m_entries.GetSize() != 0)
     {
         // Check first entry in advance, as it won't be added
@@ -876,43 +911,7 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
 
                     if (entry.Offset > 0)
                     {
-                        PdfReference reference(i, (uint16_t)entry.Generation);
-                        obj.reset(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
-                        try
-                        {
-                            if (m_Encrypt != nullptr)
-                            {
-                                obj->SetEncrypt(m_Encrypt);
-                                if (obj->TryGetDictionary(dict))
-                                {
-                                    typeObj = dict->GetKey("Type");
-                                    if (typeObj != nullptr && typeObj->TryGetName(name) && *name == "XRef")
-                                    {
-                                        // NOTE: XRef is never encrypted
-                                        obj.reset(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
-                                    }
-                                }
-                            }
-
-                            m_Objects->PushObject(std::move(obj));
-                        }
-                        catch (PdfError& e)
-                        {
-                            if (m_StrictParsing)
-                            {
-                                PODOFO_PUSH_FRAME_INFO(e, "Error while loading object {} {} R, Offset={}, Index={}",
-                                    obj->GetIndirectReference().ObjectNumber(),
-                                    obj->GetIndirectReference().GenerationNumber(),
-                                    entry.Offset, i);
-                                throw;
-                            }
-
-                            PoDoFo::LogMessage(PdfLogSeverity::Warning, "Error while loading object {} {} R, Offset={}, Index={}",
-                                obj->GetIndirectReference().ObjectNumber(),
-                                obj->GetIndirectReference().GenerationNumber(),
-                                entry.Offset, i);
-                            m_Objects->AddUnavailableObject(i);
-                        }
+                        (void)tryPushObject(device, i, entry);
                     }
                     else if (entry.Generation == 0)
                     {
@@ -1013,18 +1012,125 @@ void PdfParser::ReadObjectsInternal(InputStreamDevice& device)
     }
 }
 
+bool PdfParser::tryPushObject(InputStreamDevice& device, unsigned objNum, const PdfXRefEntry& entry)
+{
+    PdfReference reference(objNum, (uint16_t)entry.Generation);
+    unique_ptr<PdfParserObject> obj(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
+    PdfDictionary* dict;
+    PdfObject* typeObj;
+    const PdfName* name;
+    try
+    {
+        if (m_Encrypt != nullptr)
+        {
+            obj->SetEncrypt(m_Encrypt);
+            if (obj->TryGetDictionary(dict))
+            {
+                typeObj = dict->GetKey("Type");
+                if (typeObj != nullptr && typeObj->TryGetName(name) && *name == "XRef")
+                {
+                    // NOTE: XRef is never encrypted
+                    obj.reset(new PdfParserObject(m_Objects->GetDocument(), reference, device, (ssize_t)entry.Offset));
+                }
+            }
+        }
+
+        m_Objects->PushObject(std::move(obj));
+        return true;
+    }
+    catch (PdfError& e)
+    {
+        if (m_StrictParsing)
+        {
+            PODOFO_PUSH_FRAME_INFO(e, "Error while loading object {} {} R, Offset={}, Index={}",
+                reference.ObjectNumber(), reference.GenerationNumber(), entry.Offset, objNum);
+            throw;
+        }
+
+        PoDoFo::LogMessage(PdfLogSeverity::Warning, "Error while loading object {} {} R, Offset={}, Index={}",
+            reference.ObjectNumber(), reference.GenerationNumber(), entry.Offset, objNum);
+        m_Objects->AddUnavailableObject(objNum);
+        return false;
+    }
+}
+
+bool PdfParser::TryLoadObject(const PdfReference& ref)
+{
+    uint32_t objNum = ref.ObjectNumber();
+    if (objNum == 0 || objNum >= m_entries.GetSize())
+        return false;
+
+    auto& entry = m_entries[objNum];
+    if (!entry.Parsed)
+        return false;
+
+    switch (entry.Type)
+    {
+        case PdfXRefEntryType::InUse:
+        {
+            if (entry.Offset == 0 || entry.Generation != ref.GenerationNumber())
+                return false;
+
+            return tryPushObject(*m_device, objNum, entry);
+        }
+        case PdfXRefEntryType::Compressed:
+        {
+            // Objects in object streams always have generation number 0
+            if (ref.GenerationNumber() != 0)
+                return false;
+
+            // Read all the objects of the object stream, which is loaded on
+            // demand as well, so it's decoded just once. If the stream was
+            // already read, the object has been removed from the list since
+            auto found = m_compressedObjects.find((uint32_t)entry.ObjectNumber);
+            if (found == m_compressedObjects.end())
+                return false;
+
+            auto objectList = std::move(found->second);
+            m_compressedObjects.erase(found);
+            readCompressedObjectFromStream((uint32_t)entry.ObjectNumber, objectList);
+            m_Objects->AddCompressedObjectStream((uint32_t)entry.ObjectNumber);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 void PdfParser::eagerlyLoadStreams()
 {
     // Force loading of streams. We can't do this during the initial
     // run that populates m_Objects because a stream might have a /Length
     // key that references an object we haven't yet read. So we must do it here
     // in a second pass, or (if demand loading is enabled) defer it for later.
+    // Encrypted streams are just read here and decrypted in parallel
+    // in batches, when enough data is read and after the last stream
+    vector<PdfParserObject*> encryptedObjs;
+    vector<charbuff> encryptedBuffers;
+    size_t batchSize = 0;
     for (auto objToLoad : *m_Objects)
     {
         auto parserObj = dynamic_cast<PdfParserObject*>(objToLoad);
         try
         {
-            parserObj->ParseStream();
+            charbuff buffer;
+            if (m_Encrypt != nullptr && parserObj->TryReadEncryptedStream(buffer))
+            {
+                batchSize += buffer.size();
+                encryptedObjs.push_back(parserObj);
+                encryptedBuffers.push_back(std::move(buffer));
+                if (batchSize >= MaxDecryptBatchSize)
+                {
+                    decryptStreams(encryptedObjs, encryptedBuffers);
+                    encryptedObjs.clear();
+                    encryptedBuffers.clear();
+                    batchSize = 0;
+                }
+            }
+            else
+            {
+                parserObj->ParseStream();
+            }
         }
         catch (PdfError& e)
         {
@@ -1034,6 +1140,58 @@ void PdfParser::eagerlyLoadStreams()
             throw;
         }
     }
+
+    if (encryptedObjs.size() != 0)
+        decryptStreams(encryptedObjs, encryptedBuffers);
+}
+
+void PdfParser::decryptStreams(const vector<PdfParserObject*>& objs, vector<charbuff>& buffers)
+{
+    // Distribute the streams among a job per hardware thread, each one
+    // with its own copy of the encryption context, so the object keys
+    // and the cipher contexts are not shared between the threads
+    unsigned jobCount = std::min((unsigned)objs.size(), std::max(1u, std::thread::hardware_concurrency()));
+    auto& encrypt = m_Encrypt->GetEncrypt();
+    auto& context = m_Encrypt->GetContext();
+    vector<charbuff> decrypted(objs.size());
+    vector<unsigned char> failed(objs.size());
+    RunParallelJobs(jobCount, [&](unsigned jobIndex)
+    {
+        PdfEncryptContext jobContext(context);
+        for (size_t i = jobIndex; i < objs.size(); i += jobCount)
+        {
+            try
+            {
+                encrypt.DecryptTo(decrypted[i], buffers[i], jobContext, objs[i]->GetIndirectReference());
+            }
+            catch (PdfError&)
+            {
+                failed[i] = 1;
+            }
+            buffers[i] = charbuff();
+        }
+    });
+
+    for (size_t i = 0; i < objs.size(); i++)
+    {
+        auto& parserObj = *objs[i];
+        try
+        {
+            // Let the regular stream parsing handle the
+            // streams that failed to decrypt, if possible
+            if (failed[i] == 0)
+                parserObj.InitDecryptedStream(std::move(decrypted[i]));
+            else
+                parserObj.ParseStream();
+        }
+        catch (PdfError& e)
+        {
+            PODOFO_PUSH_FRAME_INFO(e, "Unable to parse the stream for object {} {} R",
+                parserObj.GetIndirectReference().ObjectNumber(),
+                parserObj.GetIndirectReference().GenerationNumber());
+            throw;
+        }
+    }
 }
 
 void PdfParser::readCompressedObjectFromStream(uint32_t objNo, const unordered_set<uint32_t>& objectList)
@@ -1209,7 +1367,11 @@ void PdfParser::checkEOFMarker(InputStreamDevice& device)
 
 void PdfParser::clear()
 {
+    if (m_device != nullptr)
+        m_Objects->SetObjectLoader(nullptr);
+
     m_entries.Clear();
+    m_compressedObjects.clear();
     m_Objects->Clear();
     m_tokenizer.Reset();
     init();
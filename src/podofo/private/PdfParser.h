@@ -27,7 +27,7 @@ struct PdfEntryPoints final
 /// The file can be modified in memory and written back using
 /// the PdfWriter class.
 /// Most PDF features are supported
-class PdfParser
+class PdfParser : private PdfIndirectObjectList::ObjectLoader
 {
     friend class PdfParserTest;
     friend class PdfDocument;
@@ -44,6 +44,8 @@ public:
     /// @see ParseFile
     PdfParser(PdfIndirectObjectList& objects);
 
+    ~PdfParser();
+
     /// Open a PDF file and parse it.
     ///
     /// @param device the input device to read from
@@ -88,6 +90,13 @@ public:
     inline void SetPassword(const std::string_view& password) { m_Password = password; }
     inline const std::string& GetPassword() { return m_Password; }
 
+    /// Set a function authenticating the document when the password fails,
+    /// eg. trying other passwords. It's called while parsing, before the
+    /// objects are read
+    /// @param authenticator returns true and fills the context if it authenticated
+    ///     the document. It must outlive Parse()
+    inline void SetAuthenticator(const PdfAuthenticator* authenticator) { m_authenticator = authenticator; }
+
     /// Retrieve the number of incremental updates that
     /// have been applied to the last parsed PDF file.
     ///
@@ -140,6 +149,15 @@ public:
 
     inline void SetLoadStreamsEagerly(bool value) { m_LoadStreamsEagerly = value; }
 
+    /// Read only the xref sections and the trailers when parsing,
+    /// loading the objects on demand when they are first looked up
+    /// in the object list. The parser and the input device must
+    /// outlive the object list
+    /// @remarks Broken cross reference sections are not recovered
+    inline void SetLoadObjectsOnDemand(bool value) { m_LoadObjectsOnDemand = value; }
+
+    inline bool GetLoadObjectsOnDemand() const { return m_LoadObjectsOnDemand; }
+
     inline const PdfEncryptSession* GetEncrypt() const { return m_Encrypt.get(); }
 
     inline size_t GetMagicOffset() const { return m_MagicOffset; }
@@ -193,6 +211,9 @@ private:
     /// @see SetPassword
     void ReadObjectsInternal(InputStreamDevice& device);
 
+    /// Load the object at the given entry on demand
+    bool TryLoadObject(const PdfReference& ref) override;
+
     /// Checks the magic number at the start of the pdf file
     /// and sets the m_PdfVersion member to the correct version
     /// of the pdf file.
@@ -203,6 +224,12 @@ private:
 
     bool tryRebuildCrossReference(InputStreamDevice& device);
 
+    /// Create the object described by the given in use entry
+    /// and push it on the objects vector
+    /// @returns false if the object couldn't be loaded and
+    /// it was marked as unavailable
+    bool tryPushObject(InputStreamDevice& device, unsigned objNum, const PdfXRefEntry& entry);
+
     /// Searches backwards from the specified position of the file
     /// and tries to find a token.
     /// If found, the current stream is positioned right after the token.
@@ -219,6 +246,10 @@ private:
 
     void eagerlyLoadStreams();
 
+    /// Decrypt in parallel the raw encrypted streams of the
+    /// given objects and complete the loading of their streams
+    void decryptStreams(const std::vector<PdfParserObject*>& objs, std::vector<charbuff>& buffers);
+
     /// Read the object with index from the object stream nObjNo
     /// and push it on the objects vector
     ///
@@ -266,6 +297,7 @@ private:
 
     PdfVersion m_PdfVersion;
     bool m_LoadStreamsEagerly;
+    bool m_LoadObjectsOnDemand;
     bool m_HasXRefStream;
     bool m_HasCorruptedXRefSections;
 
@@ -282,12 +314,17 @@ private:
 
     PdfXRefEntries m_entries;
     PdfIndirectObjectList* m_Objects;
+    InputStreamDevice* m_device;
+    // Object stream number -> compressed objects, for
+    // the object streams not yet read on demand
+    std::unordered_map<uint32_t, std::unordered_set<uint32_t>> m_compressedObjects;
 
     std::unique_ptr<PdfParserObject> m_Trailer;
     PdfObject* m_Catalog;
     std::shared_ptr<PdfEncryptSession> m_Encrypt;
 
     std::string m_Password;
+    const PdfAuthenticator* m_authenticator;
 
     bool m_StrictParsing;
     bool m_SkipXRefRecovery;
@@ -7,6 +7,7 @@
 
 #include <podofo/main/PdfArray.h>
 #include <podofo/main/PdfDictionary.h>
+#include <podofo/auxiliary/StreamDevice.h>
 
 #include "PdfFilterFactory.h"
 #include <podofo/main/PdfDocument.h>
@@ -52,6 +53,8 @@ PdfParserObject::PdfParserObject(PdfDocument* doc, const PdfReference& indirectR
     m_device(&device),
     m_Offset(offset < 0 ? device.GetPosition() : offset),
     m_StreamOffset(0),
+    m_DataOffset(0),
+    m_DataEndOffset(0),
     m_isLegacyTrailer(isLegacyTrailer),
     m_HasStream(false),
     m_IsRevised(false)
@@ -163,13 +166,14 @@ void PdfParserObject::ParseData(PdfTokenizer& tokenizer)
 {
     unique_ptr<PdfStatefulEncrypt> encrypt;
     if (m_Encrypt != nullptr)
-        encrypt.reset(new PdfStatefulEncrypt(m_Encrypt->GetEncrypt(), m_Encrypt->GetContext(), GetIndirectReference()));
+        encrypt.reset(new PdfStatefulEncrypt(m_Encrypt, GetIndirectReference()));
 
     // Do not call ReadNextVariant directly,
     // but TryReadNextToken, to handle empty objects like:
     // 13 0 obj
     // endobj
 
+    m_DataOffset = m_device->GetPosition();
     PdfTokenType tokenType;
     string_view token;
     bool gotToken = tokenizer.TryReadNextToken(*m_device, token, tokenType);
@@ -180,6 +184,7 @@ void PdfParserObject::ParseData(PdfTokenizer& tokenizer)
     if (token != "endobj")
     {
         tokenizer.ReadNextVariant(*m_device, token, tokenType, m_Variant, encrypt.get());
+        m_DataEndOffset = m_device->GetPosition();
 
         if (!m_isLegacyTrailer)
         {
@@ -217,6 +222,147 @@ void PdfParserObject::parseStream(bool shallow, bool dryRun)
 {
     PODOFO_ASSERT(IsDelayedLoadDone());
 
+    size_t streamOffset;
+    size_t size;
+    PdfFilterList filters;
+    locateStream(shallow, streamOffset, size, filters);
+
+    if (dryRun)
+    {
+        m_device->Seek(streamOffset + size);
+    }
+    else
+    {
+        m_device->Seek(streamOffset);
+
+        // Set stream raw data without marking the object dirty
+        if (isStreamEncrypted())
+        {
+            auto input = m_Encrypt->GetEncrypt().CreateEncryptionInputStream(*m_device, size, m_Encrypt->GetContext(), GetIndirectReference());
+            getOrCreateStream().InitData(*input, size, std::move(filters));
+        }
+        else
+        {
+            getOrCreateStream().InitData(*m_device, size, std::move(filters));
+        }
+    }
+}
+
+bool PdfParserObject::TryReadEncryptedStream(charbuff& buffer)
+{
+    PODOFO_ASSERT(IsDelayedLoadDone());
+    if (IsDelayedLoadStreamDone() || !m_HasStream || !isStreamEncrypted())
+        return false;
+
+    size_t streamOffset;
+    size_t size;
+    PdfFilterList filters;
+    locateStream(false, streamOffset, size, filters);
+    if (size < m_Encrypt->GetEncrypt().CalculateStreamOffset())
+        return false;
+
+    buffer.resize(size);
+    m_device->Seek(streamOffset);
+    m_device->Read(buffer.data(), size);
+    return true;
+}
+
+InputStreamDevice* PdfParserObject::TryLocateReusableStream(const PdfStatefulEncrypt& encrypt,
+    PdfWriteFlags writeMode, size_t& streamLength)
+{
+    DelayedLoad();
+    if (m_device == nullptr || IsDirty() || IsDelayedLoadStreamDone() || !m_HasStream || !isStreamEncrypted()
+        || !encrypt.CanReuseCiphertext(*m_Encrypt, GetIndirectReference()))
+    {
+        return nullptr;
+    }
+
+    size_t streamOffset;
+    PdfFilterList filters;
+    locateStream(false, streamOffset, streamLength, filters);
+
+    // Unfiltered streams would be compressed by the writer
+    if (filters.size() == 0 && (writeMode & PdfWriteFlags::NoFlateCompress) == PdfWriteFlags::None)
+        return nullptr;
+
+    m_device->Seek(streamOffset);
+    return m_device;
+}
+
+InputStreamDevice* PdfParserObject::TryLocateSourceData(const PdfStatefulEncrypt* encrypt, size_t& length, bool& hasStream)
+{
+    if (m_isLegacyTrailer)
+        return nullptr;
+
+    DelayedLoad();
+    if (m_device == nullptr || IsDirty() || m_DataEndOffset == 0)
+        return nullptr;
+
+    // The encrypted data in the source must be decrypted
+    // by the output encrypt, if any
+    if (encrypt == nullptr)
+    {
+        if (m_Encrypt != nullptr)
+            return nullptr;
+    }
+    else
+    {
+        if (m_Encrypt == nullptr || !encrypt->CanReuseCiphertext(*m_Encrypt, GetIndirectReference()))
+            return nullptr;
+    }
+
+    if (m_HasStream)
+    {
+        // The /Length in the source must be correct, as it's copied as well
+        int64_t sourceLength = this->m_Variant.GetDictionaryUnsafe().FindKeyAsSafe<int64_t>("Length", -1);
+        if (sourceLength < 0)
+            return nullptr;
+
+        size_t streamOffset;
+        size_t streamLength;
+        PdfFilterList filters;
+        locateStream(false, streamOffset, streamLength, filters);
+        if ((size_t)sourceLength != streamLength)
+            return nullptr;
+
+        length = streamOffset + streamLength - m_DataOffset;
+    }
+    else
+    {
+        length = m_DataEndOffset - m_DataOffset;
+    }
+
+    hasStream = m_HasStream;
+    m_device->Seek(m_DataOffset);
+    return m_device;
+}
+
+void PdfParserObject::DetachSource()
+{
+    DelayedLoad();
+    DelayedLoadStream();
+    m_device = nullptr;
+}
+
+void PdfParserObject::InitDecryptedStream(charbuff&& data)
+{
+    PODOFO_ASSERT(!IsDelayedLoadStreamDone());
+    getOrCreateStream().InitData(std::move(data), PdfFilterFactory::CreateFilterList(*this));
+    MakeDelayedLoadingStreamDone();
+}
+
+bool PdfParserObject::isStreamEncrypted() const
+{
+    // NOTE: /Metadata objects may be unencrypted even if the
+    // whole document is encrypted
+    const PdfName* type;
+    return m_Encrypt != nullptr && (m_Encrypt->GetEncrypt().IsMetadataEncrypted()
+        || !this->m_Variant.GetDictionaryUnsafe().TryFindKeyAs("Type", type)
+        || *type != "Metadata");
+}
+
+void PdfParserObject::locateStream(bool shallow, size_t& streamOffset, size_t& streamSize, PdfFilterList& filters)
+{
     char ch;
     ssize_t size;
     if (shallow)
@@ -226,7 +372,6 @@ void PdfParserObject::parseStream(bool shallow, bool dryRun)
 
     m_device->Seek(m_StreamOffset);
 
-    size_t streamOffset;
     while (true)
     {
         if (!m_device->Peek(ch))
@@ -280,7 +425,7 @@ void PdfParserObject::parseStream(bool shallow, bool dryRun)
 ReadStream:
     // NOTE: Retrieve the first list before seeking, otherwise
     // the following operation may also adjust the position
-    auto filters = PdfFilterFactory::CreateFilterList(*this);
+    filters = PdfFilterFactory::CreateFilterList(*this);
 
     if (size < 0)
     {
@@ -301,33 +446,7 @@ ReadStream:
         size = (ssize_t)determineStreamSize(*m_device, streamOffset);
     }
 
-    if (dryRun)
-    {
-        m_device->Seek(streamOffset + size);
-    }
-    else
-    {
-        m_device->Seek(streamOffset);
-
-        // Set stream raw data without marking the object dirty
-        // NOTE: /Metadata objects may be unencrypted even if the
-        // whole document is encrypted
-        const PdfName* type;
-        if (m_Encrypt != nullptr && (m_Encrypt->GetEncrypt().IsMetadataEncrypted()
-            || !this->m_Variant.GetDictionaryUnsafe().TryFindKeyAs("Type", type)
-            || *type != "Metadata"))
-        {
-            auto input = m_Encrypt->GetEncrypt().CreateEncryptionInputStream(*m_device, static_cast<size_t>(size), m_Encrypt->GetContext(), GetIndirectReference());
-            getOrCreateStream().InitData(*input, static_cast<ssize_t>(size), std::move(filters));
-            // Release the encrypt object after loading the stream.
-            // It's not needed for serialization here
-            m_Encrypt = nullptr;
-        }
-        else
-        {
-            getOrCreateStream().InitData(*m_device, static_cast<ssize_t>(size), std::move(filters));
-        }
-    }
+    streamSize = (size_t)size;
 }
 
 void PdfParserObject::checkReference(PdfTokenizer& tokenizer)
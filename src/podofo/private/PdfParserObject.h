@@ -57,6 +57,37 @@ public:
     /// Pretend to parse the stream (if any), just setting the stream position past it
     void ParseStreamDryRun();
 
+    /// Read the raw stream data, if the stream must be decrypted
+    /// and it's not loaded yet. The data can be decrypted out of
+    /// the parser thread and then set with InitDecryptedStream()
+    /// @returns false if the stream must be parsed with ParseStream() instead
+    bool TryReadEncryptedStream(charbuff& buffer);
+
+    /// Locate the encrypted stream data in the source device, if the
+    /// object and its stream were not modified and the data can be
+    /// decrypted with the given encrypt
+    /// @returns the device positioned at the stream data, or nullptr
+    ///     if the object must be written regularly
+    InputStreamDevice* TryLocateReusableStream(const PdfStatefulEncrypt& encrypt,
+        PdfWriteFlags writeMode, size_t& streamLength);
+
+    /// Locate the source data of the object, if it was not modified and
+    /// it can be copied verbatim to an output encrypted with the given encrypt
+    /// @param length the length of the data, starting after the "obj" keyword
+    ///     and ending after the stream data, if any
+    /// @param hasStream true if the data ends with stream data
+    /// @returns the device positioned at the data, or nullptr
+    ///     if the object must be written regularly
+    InputStreamDevice* TryLocateSourceData(const PdfStatefulEncrypt* encrypt, size_t& length, bool& hasStream);
+
+    /// Load the object and its stream, if any, and stop reading
+    /// from the source device, as when it's going to be overwritten
+    void DetachSource();
+
+    /// Set the stream data decrypted from the buffer read with
+    /// TryReadEncryptedStream(), completing the loading of the stream
+    void InitDecryptedStream(charbuff&& data);
+
     /// Gets an offset in which the object beginning is stored in the file.
     /// Note the offset points just after the object identifier ("0 0 obj").
     ///
@@ -92,6 +123,12 @@ private:
     /// Called from DelayedLoadStream(). Do not call directly.
     void parseStream(bool shallow, bool dryRun);
 
+    /// Find the stream data offset and size, leaving the device
+    /// in an unspecified position
+    void locateStream(bool shallow, size_t& streamOffset, size_t& streamSize, PdfFilterList& filters);
+
+    bool isStreamEncrypted() const;
+
     PdfReference readReference(PdfTokenizer& tokenizer);
 
     void checkReference(PdfTokenizer& tokenizer);
@@ -101,6 +138,8 @@ private:
     InputStreamDevice* m_device;
     size_t m_Offset;
     size_t m_StreamOffset;
+    size_t m_DataOffset;      ///< The offset of the object data, after the "obj" keyword
+    size_t m_DataEndOffset;   ///< The offset after the object data, 0 if the object is empty
     bool m_isLegacyTrailer;
     bool m_HasStream;
     bool m_IsRevised;         ///< True if the object was irreversibly modified since first read
@@ -17,21 +17,26 @@ class PdfStreamedObjectStream::ObjectOutputStream : public OutputStream
 public:
     ObjectOutputStream(PdfStreamedObjectStream& stream, OutputStreamDevice& outputStream) :
         m_objectStream(&stream),
-        m_outputStream(&outputStream)
+        m_outputStream(&outputStream),
+        m_uncaughtExceptions(std::uncaught_exceptions())
     {
     }
 
     ObjectOutputStream(PdfStreamedObjectStream& stream, unique_ptr<OutputStream> outputStream) :
         m_objectStream(&stream),
         m_outputStream(outputStream.get()),
-        m_outputStreamStore(std::move(outputStream))
+        m_outputStreamStore(std::move(outputStream)),
+        m_uncaughtExceptions(std::uncaught_exceptions())
     {
     }
 
     ~ObjectOutputStream()
     {
-        Flush(*m_outputStream);
-        m_objectStream->FinishOutput();
+        // NOTE: Don't write anything else if the stream is disposed
+        // because of an exception. Otherwise the encryption stream is
+        // finished in FinishOutput(), where errors can be raised
+        if (std::uncaught_exceptions() == m_uncaughtExceptions)
+            m_objectStream->m_EncryptStream = std::move(m_outputStreamStore);
     }
 
 protected:
@@ -50,6 +55,7 @@ private:
     PdfStreamedObjectStream* m_objectStream;
     OutputStream* m_outputStream;
     std::unique_ptr<OutputStream> m_outputStreamStore;
+    int m_uncaughtExceptions;
 };
 
 PdfStreamedObjectStream::PdfStreamedObjectStream(OutputStreamDevice& device) :
@@ -119,6 +125,14 @@ size_t PdfStreamedObjectStream::GetLength() const
 
 void PdfStreamedObjectStream::FinishOutput()
 {
+    if (m_EncryptStream != nullptr)
+    {
+        // Let the encryption stream write its last block
+        // before the length of the stream is computed
+        auto encryptStream = std::move(m_EncryptStream);
+        PdfEncrypt::FinishEncryptionOutputStream(*encryptStream);
+    }
+
     if (m_Encrypt != nullptr)
         m_Length = m_Encrypt->CalculateStreamLength(m_Length);
 
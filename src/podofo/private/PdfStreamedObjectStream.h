@@ -62,12 +62,15 @@ private:
     /// @param encrypt an encryption object or nullptr if no encryption should be done
     void SetEncrypt(PdfEncrypt& encrypt, PdfEncryptContext& context);
 
+    /// Finish the encryption of the written data and set the
+    /// final length of the stream. Called when appending ends
     void FinishOutput();
 
 private:
     OutputStreamDevice* m_Device;
     PdfEncrypt* m_Encrypt;
     PdfEncryptContext* m_EncryptContext;
+    std::unique_ptr<OutputStream> m_EncryptStream;
     size_t m_Length;
     PdfObject* m_LengthObj;
 };
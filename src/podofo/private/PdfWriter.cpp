@@ -132,11 +132,47 @@ void PdfWriter::WritePdfHeader(OutputStreamDevice& device)
     device.Write(m_buffer);
 }
 
+void PdfWriter::writeObject(OutputStreamDevice& device, PdfObject& obj, const PdfStatefulEncrypt* encrypt)
+{
+    auto parserObject = dynamic_cast<PdfParserObject*>(&obj);
+    if (parserObject != nullptr)
+    {
+        InputStreamDevice* source;
+        size_t length;
+        bool hasStream;
+        if ((m_SaveOptions & PdfSaveOptions::CopyUnmodifiedObjects) != PdfSaveOptions::None
+            && (source = parserObject->TryLocateSourceData(encrypt, length, hasStream)) != nullptr)
+        {
+            // Copy the object data verbatim from the source device
+            obj.WriteHeader(device, m_WriteFlags, m_buffer);
+            source->CopyTo(device, length);
+            if (hasStream)
+                device.Write("\nendstream");
+
+            device.Write("\nendobj\n");
+            return;
+        }
+
+        // Copy the cipher text of streams that were not modified
+        // straight from the source device, if the encryption
+        // key is unchanged
+        if (encrypt != nullptr
+            && (source = parserObject->TryLocateReusableStream(*encrypt, m_WriteFlags, length)) != nullptr)
+        {
+            obj.WriteFinal(device, m_WriteFlags, encrypt, *source, length, m_buffer);
+            return;
+        }
+    }
+
+    obj.WriteFinal(device, m_WriteFlags, encrypt, m_buffer);
+}
+
 void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObjectList& objects, PdfXRef& xref)
 {
     unique_ptr<PdfStatefulEncrypt> encrypt;
     for (PdfObject* obj : objects)
     {
+        // Make sure that we do not encrypt the encryption dictionary!
         if (m_Encrypt != nullptr && obj != m_EncryptObj)
             encrypt.reset(new PdfStatefulEncrypt(m_Encrypt->GetEncrypt(), m_Encrypt->GetContext(), obj->GetIndirectReference()));
         else
@@ -175,8 +211,7 @@ void PdfWriter::WritePdfObjects(OutputStreamDevice& device, const PdfIndirectObj
         else
         {
             xref.AddInUseObject(obj->GetIndirectReference(), device.GetPosition() - m_MagicOffset);
-            // Also make sure that we do not encrypt the encryption dictionary!
-            obj->WriteFinal(device, m_WriteFlags, encrypt.get(), m_buffer);
+            writeObject(device, *obj, encrypt.get());
         }
     }
 
@@ -144,6 +144,8 @@ protected:
 private:
     void initWriteFlags();
 
+    void writeObject(OutputStreamDevice& device, PdfObject& obj, const PdfStatefulEncrypt* encrypt);
+
 protected:
     charbuff m_buffer;
 
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#include "PdfDeclarationsPrivate.h"
+#include "WorkerPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+using namespace std;
+using namespace PoDoFo;
+
+// Further concurrent callers run their jobs in the calling thread
+static constexpr unsigned MaxQueuedBatches = 64;
+
+namespace
+{
+    /// The jobs submitted by a single RunParallelJobs() call
+    struct JobBatch
+    {
+        JobBatch(unsigned jobCount, const function<void(unsigned index)>& job) :
+            Job(&job),
+            JobCount(jobCount),
+            NextJob(0),
+            CompletedCount(0),
+            Exceptions(jobCount) { }
+
+        const function<void(unsigned index)>* Job;
+        unsigned JobCount;
+        atomic<unsigned> NextJob;
+        unsigned CompletedCount;        ///< Guarded by the pool mutex
+        vector<exception_ptr> Exceptions;
+    };
+
+    /// The process-wide pool of worker threads. The submitting thread
+    /// runs the jobs of its batch as well, so batches complete even when
+    /// all the workers are busy, and nested submissions can't deadlock
+    class WorkerPool final
+    {
+    public:
+        WorkerPool();
+        ~WorkerPool();
+
+    public:
+        void Run(unsigned jobCount, const function<void(unsigned index)>& job);
+
+    private:
+        void work();
+        void runJob(JobBatch& batch, unsigned index);
+
+    private:
+        mutex m_mutex;
+        condition_variable m_workAvailable;
+        condition_variable m_batchCompleted;
+        deque<JobBatch*> m_queue;
+        vector<thread> m_threads;
+        bool m_stopping;
+    };
+}
+
+static WorkerPool& getWorkerPool();
+
+void PoDoFo::RunParallelJobs(unsigned jobCount, const function<void(unsigned index)>& job)
+{
+    if (jobCount <= 1 || std::thread::hardware_concurrency() <= 1)
+    {
+        for (unsigned i = 0; i < jobCount; i++)
+            job(i);
+
+        return;
+    }
+
+    getWorkerPool().Run(jobCount, job);
+}
+
+WorkerPool::WorkerPool()
+    : m_stopping(false)
+{
+    // NOTE: The submitting thread acts as a worker as well
+    unsigned threadCount = std::thread::hardware_concurrency() - 1;
+    m_threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        try
+        {
+            m_threads.emplace_back(&WorkerPool::work, this);
+        }
+        catch (system_error&)
+        {
+            // Run with the threads that could be started
+            break;
+        }
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_workAvailable.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void WorkerPool::Run(unsigned jobCount, const function<void(unsigned index)>& job)
+{
+    JobBatch batch(jobCount, job);
+    bool queued = false;
+    {
+        unique_lock<mutex> lock(m_mutex);
+        if (!m_threads.empty() && m_queue.size() < MaxQueuedBatches)
+        {
+            m_queue.push_back(&batch);
+            queued = true;
+        }
+    }
+
+    if (queued)
+        m_workAvailable.notify_all();
+
+    unsigned index;
+    while ((index = batch.NextJob++) < jobCount)
+        runJob(batch, index);
+
+    {
+        // Wait for the jobs taken by the workers. The batch must
+        // be unqueued before returning, as it's on the stack
+        unique_lock<mutex> lock(m_mutex);
+        m_batchCompleted.wait(lock, [&batch]() { return batch.CompletedCount == batch.JobCount; });
+        if (queued)
+        {
+            auto found = std::find(m_queue.begin(), m_queue.end(), &batch);
+            if (found != m_queue.end())
+                m_queue.erase(found);
+        }
+    }
+
+    for (auto& exception : batch.Exceptions)
+    {
+        if (exception != nullptr)
+            std::rethrow_exception(exception);
+    }
+}
+
+void WorkerPool::work()
+{
+    unique_lock<mutex> lock(m_mutex);
+    while (true)
+    {
+        m_workAvailable.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_stopping)
+            return;
+
+        auto& batch = *m_queue.front();
+        unsigned index = batch.NextJob++;
+        if (index >= batch.JobCount)
+        {
+            // All the jobs of the batch were taken
+            m_queue.pop_front();
+            continue;
+        }
+
+        lock.unlock();
+        runJob(batch, index);
+        lock.lock();
+    }
+}
+
+void WorkerPool::runJob(JobBatch& batch, unsigned index)
+{
+    try
+    {
+        (*batch.Job)(index);
+    }
+    catch (...)
+    {
+        batch.Exceptions[index] = std::current_exception();
+    }
+
+    unique_lock<mutex> lock(m_mutex);
+    if (++batch.CompletedCount == batch.JobCount)
+        m_batchCompleted.notify_all();
+}
+
+WorkerPool& getWorkerPool()
+{
+    static WorkerPool s_pool;
+    return s_pool;
+}
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
+
+#ifndef PODOFO_WORKER_POOL_H
+#define PODOFO_WORKER_POOL_H
+
+#include <podofo/main/PdfDeclarations.h>
+
+#include <functional>
+
+namespace PoDoFo
+{
+    /// Run jobs on the process-wide pool of worker threads, started on
+    /// first use, returning when all of them are completed. The calling
+    /// thread runs jobs as well. Jobs are run in the calling thread
+    /// if there's a single job or a single hardware thread
+    /// @param jobCount the number of jobs, identified by their index
+    /// @param job the functor invoked with the index of each job
+    /// @remarks If jobs throw, the exception of the first failed
+    /// job in index order is rethrown after all jobs completed
+    void RunParallelJobs(unsigned jobCount, const std::function<void(unsigned index)>& job);
+}
+
+#endif // PODOFO_WORKER_POOL_H
@@ -3,7 +3,7 @@
 
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include <podofo/podofo.h>
-#include <podofo/private/PdfFilterFactory.h>
+#include <podofo/private/PdfCharCodeMapTable.h>
 
 namespace fs = std::filesystem;
 using namespace std;
@@ -26,6 +26,8 @@ struct Context
 };
 
 static void handleCMapFolder(const fs::path& path, const unordered_set<string>& knowCmaps, Context& context, bool skipAddToContext);
+static void writeHeader();
+static void writeFooter(const Context& context);
 
 static unique_ptr<FileStreamDevice> s_Stream;
 
@@ -112,15 +114,34 @@ int main()
         throw runtime_error("ADOBE_TYPE_TOOLS_REPOSITORY environment variable is missing");
 
     s_Stream.reset(new FileStreamDevice((mainPodofoSrcPath / "PdfEncodingMapFactory_PredefinedCMaps.cpp").u8string(), FileMode::Create));
+    writeHeader();
+    handleCMapFolder(fs::u8path(adobeTypeToolsRepoPath) / "cmap-resources", knowCmaps, context, true);
+    handleCMapFolder(fs::u8path(adobeTypeToolsRepoPath) / "mapping-resources-pdf", knowCmaps, context, false);
+    writeFooter(context);
+
+    cout << "Registries: [" << endl;
+    for (auto& registry : context.Catalog.Registries)
+        cout << "   " << registry << "," << endl;
+    cout << "]" << endl;
+    cout << "Orderings:" << endl;
+    for (auto& ordering : context.Catalog.Orderings)
+        cout << "   " << ordering << "," << endl;
+    cout << "]" << endl;
+    cout << "Supplements:" << endl;
+    for (auto& supplement : context.Catalog.Supplements)
+        cout << "   " << supplement << "," << endl;
+    cout << "]" << endl;
+    return 0;
+}
+
+void writeHeader()
+{
     s_Stream->Write(R"(// This file was generated. DO NOT EDIT!
-/**
- * SPDX-FileCopyrightText: (C) 2024 Francesco Pretto <ceztko@gmail.com>
- * SPDX-License-Identifier: LGPL-2.0-or-later
- * SPDX-License-Identifier: MPL-2.0
- */
+// SPDX-FileCopyrightText: 2024 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: LGPL-2.0-or-later OR MPL-2.0
 #include <podofo/private/PdfDeclarationsPrivate.h>
 #include "PdfEncodingMapFactory.h"
-#include <podofo/private/PdfFilterFactory.h>
+#include <podofo/private/PdfCharCodeMapTable.h>
 
 using namespace std;
 using namespace PoDoFo;
@@ -128,8 +149,6 @@ using namespace PoDoFo;
 // NOTE: The mappings in this file were generated using the
 // "staging/BuildPredefinedCMaps.cpp" script
 
-static void buildMappings(const string_view& serialized, CodeUnitMap& mappings, CodeUnitRanges& ranges);
-
 namespace
 {
     using MapGetter = std::add_pointer<const PdfCMapEncodingConstPtr&()>::type;
@@ -141,8 +160,10 @@ namespace
     s_Stream->Write("    class PdfCMapEncodingFactory\n");
     s_Stream->Write("    {\n");
     s_Stream->Write("    public:\n");
-    handleCMapFolder(fs::u8path(adobeTypeToolsRepoPath) / "cmap-resources", knowCmaps, context, true);
-    handleCMapFolder(fs::u8path(adobeTypeToolsRepoPath) / "mapping-resources-pdf", knowCmaps, context, false);
+}
+
+void writeFooter(const Context& context)
+{
     s_Stream->Write("    };\n");
     s_Stream->Write("}\n");
     s_Stream->Write("\nstatic unordered_map<string_view, MapGetter> s_PredefinedCMaps = {\n");
@@ -156,7 +177,7 @@ namespace
     }
     s_Stream->Write("};\n");
     s_Stream->Write(R"(
-PdfCMapEncodingConstPtr PdfEncodingMapFactory::GetPredefinedCMap(const string_view& cmapName)
+PdfCMapEncodingConstPtr PdfEncodingMapFactory::GetPredefinedCMapInstancePtr(const string_view& cmapName)
 {
     auto found = s_PredefinedCMaps.find(cmapName);
     if (found == s_PredefinedCMaps.end())
@@ -173,189 +194,165 @@ const PdfCMapEncoding& PdfEncodingMapFactory::GetPredefinedCMapInstance(const st
 
     return *found->second();
 }
+)");
+}
 
-unsigned readCode(InputStream& stream, unsigned char codeSize)
+// Write the entries of a static array, a few per line
+void writeArray(const string_view& type, const string_view& name, const vector<string>& entries)
 {
-    switch (codeSize)
+    const unsigned entriesPerLine = 8;
+    s_Stream->Write(utls::Format("            static constexpr {} {}[] = {{\n", type, name));
+    for (size_t i = 0; i < entries.size(); i++)
     {
-        case 1:
-        {
-            return (unsigned char)stream.ReadChar();
-        }
-        case 2:
-        {
-            uint16_t code;
-            utls::ReadUInt16BE(stream, code);
-            return code;
-        }
-        case 3:
-        {
-            uint24_t code;
-            utls::ReadUInt24BE(stream, code);
-            return code;
-        }
-        case 4:
-        {
-            uint32_t code;
-            utls::ReadUInt32BE(stream, code);
-            return code;
-        }
-        default:
-            PODOFO_RAISE_ERROR(PdfErrorCode::InternalLogic);
+        if (i % entriesPerLine == 0)
+            s_Stream->Write("                ");
+
+        s_Stream->Write(entries[i]);
+        s_Stream->Write(",");
+        if ((i + 1) % entriesPerLine == 0 || i == entries.size() - 1)
+            s_Stream->Write("\n");
     }
+    s_Stream->Write("            };\n");
 }
 
-void readMapping(InputStream& stream, CodeUnitMap& mappings, vector<codepoint>& temp)
+// Compute a minimal perfect hash of the code units with the "hash
+// and displace" method: the codes are hashed to buckets, then the
+// buckets, from the biggest to the smallest, are assigned the first
+// displacement that hashes all their codes to free slots
+void buildPerfectHash(const vector<PdfCharCode>& codes, vector<uint32_t>& displacements, vector<unsigned>& slots)
 {
-    unsigned char codeSize = (unsigned char)stream.ReadChar();
-    unsigned code = readCode(stream, codeSize);
-    unsigned char copdePointsSize = (unsigned char)stream.ReadChar();
-    temp.resize(copdePointsSize);
-    uint32_t cp;
-    for (unsigned char i = 0; i < copdePointsSize; i++)
+    unsigned count = (unsigned)codes.size();
+    unsigned bucketCount = std::max(1u, count / 4);
+    vector<vector<unsigned>> buckets(bucketCount);
+    for (unsigned i = 0; i < count; i++)
+        buckets[GetCharCodeTableBucket(codes[i].Code, codes[i].CodeSpaceSize, bucketCount)].push_back(i);
+
+    vector<unsigned> order(bucketCount);
+    for (unsigned i = 0; i < bucketCount; i++)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&buckets](unsigned lhs, unsigned rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    displacements.assign(bucketCount, 0);
+    slots.resize(count);
+    vector<bool> usedSlots(count);
+    vector<unsigned> bucketSlots;
+    for (unsigned bucketIndex : order)
     {
-        utls::ReadUInt32BE(stream, cp);
-        temp[i] = cp;
-    }
-
-    mappings[PdfCharCode(code, codeSize)] = CodePointSpan(temp);
-}
+        auto& bucket = buckets[bucketIndex];
+        if (bucket.size() == 0)
+            break;
 
-void readRange(InputStream& stream, CodeUnitRanges& ranges, vector<codepoint>& temp)
-{
-    unsigned char codeSize = (unsigned char)stream.ReadChar();
-    unsigned code = readCode(stream, codeSize);
+        for (uint32_t displacement = 1; ; displacement++)
+        {
+            if (displacement == 0)
+                throw runtime_error("Could not compute a perfect hash");
 
-    uint16_t rangeSize;
-    utls::ReadUInt16BE(stream, rangeSize);
+            bucketSlots.clear();
+            for (unsigned index : bucket)
+            {
+                unsigned slot = GetCharCodeTableSlot(codes[index].Code, codes[index].CodeSpaceSize, displacement, count);
+                if (usedSlots[slot] || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                    goto NextDisplacement;
 
-    unsigned char copdePointsSize = (unsigned char)stream.ReadChar();
-    temp.resize(copdePointsSize);
-    uint32_t cp;
-    for (unsigned char i = 0; i < copdePointsSize; i++)
-    {
-        utls::ReadUInt32BE(stream, cp);
-        temp[i] = cp;
-    }
+                bucketSlots.push_back(slot);
+            }
 
-    ranges.insert(CodeUnitRange{ PdfCharCode(code, codeSize), rangeSize, CodePointSpan(temp) });
-}
+            for (unsigned i = 0; i < bucket.size(); i++)
+            {
+                usedSlots[bucketSlots[i]] = true;
+                slots[bucket[i]] = bucketSlots[i];
+            }
 
-void buildMappings(const string_view& compressed, CodeUnitMap& mappings, CodeUnitRanges& ranges)
-{
-    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
-    charbuff serialized;
-    filter->DecodeTo(serialized, compressed);
-
-    SpanStreamDevice stream(serialized);
-    uint16_t size;
-    utls::ReadUInt16BE(stream, size);
-    mappings.reserve(size);
-    vector<codepoint> temp;
-    for (unsigned i = 0; i < size; i++)
-        readMapping(stream, mappings, temp);
-
-    utls::ReadUInt16BE(stream, size);
-    for (unsigned i = 0; i < size; i++)
-        readRange(stream, ranges, temp);
-}
-)");
+            displacements[bucketIndex] = displacement;
+            break;
 
-    cout << "Registries: [" << endl;
-    for (auto& registry : context.Catalog.Registries)
-        cout << "   " << registry << "," << endl;
-    cout << "]" << endl;
-    cout << "Orderings:" << endl;
-    for (auto& ordering : context.Catalog.Orderings)
-        cout << "   " << ordering << "," << endl;
-    cout << "]" << endl;
-    cout << "Supplements:" << endl;
-    for (auto& supplement : context.Catalog.Supplements)
-        cout << "   " << supplement << "," << endl;
-    cout << "]" << endl;
-    return 0;
+        NextDisplacement:
+            continue;
+        }
+    }
 }
 
-void serializeCode(OutputStream& stream, unsigned code, unsigned char codeSize)
+// Write the map as read-only tables, see PdfCharCodeMapTable
+void write(const PdfCharCodeMap& map)
 {
-    switch (codeSize)
+    vector<PdfCharCode> codes;
+    vector<CodePointSpan> codePoints;
+    for (auto& pair : map.GetMappings())
     {
-        case 1:
-            stream.Write((char)(uint8_t)code);
-            break;
-        case 2:
-            utls::WriteUInt16BE(stream, (uint16_t)code);
-            break;
-        case 3:
-            utls::WriteUInt24BE(stream, (uint24_t)code);
-            break;
-        case 4:
-            utls::WriteUInt32BE(stream, code);
-            break;
-        default:
-            throw runtime_error("Invalid code size");
+        codes.push_back(pair.first);
+        codePoints.push_back(pair.second);
     }
-}
 
-void writeString(const string_view& view)
-{
-    const int max_line_length = 16;
-    std::string line;
-    line.push_back('"');
-
-    for (size_t i = 0; i < view.size(); i++)
+    vector<uint32_t> displacements;
+    vector<unsigned> slots;
+    vector<string> mappingEntries(codes.size());
+    vector<string> displacementEntries;
+    vector<string> rangeEntries;
+    vector<string> codePointEntries;
+    if (codes.size() != 0)
     {
-        // Convert character to octal and append to the line
-        line += fmt::format("\\{:03o}", static_cast<unsigned char>(view[i]));
+        buildPerfectHash(codes, displacements, slots);
+
+        // Order the code points pool by slot, for deterministic output
+        vector<unsigned> indices(codes.size());
+        for (unsigned i = 0; i < codes.size(); i++)
+            indices[slots[i]] = i;
 
-        // If the line reaches the maximum length or it's the last character, write to the output
-        if ((i + 1) % max_line_length == 0 || i == view.size() - 1)
+        for (unsigned index : indices)
         {
-            line.append("\"\n");
-            s_Stream->Write(line);
-            line.clear();
-            line.push_back('"');
+            auto& code = codes[index];
+            auto& span = codePoints[index];
+            if (span.size() == 0 || span.size() > 255)
+                throw runtime_error("Unsupported mapping destination");
+
+            uint32_t codePoint;
+            if (span.size() == 1)
+            {
+                codePoint = (uint32_t)*span;
+            }
+            else
+            {
+                codePoint = (uint32_t)codePointEntries.size();
+                for (unsigned i = 0; i < span.size(); i++)
+                    codePointEntries.push_back(utls::Format("{}", (uint32_t)span.data()[i]));
+            }
+
+            mappingEntries[slots[index]] = utls::Format("{{{},{},{},{}}}", code.Code, codePoint,
+                code.CodeSpaceSize, span.size());
         }
-    }
-}
 
-void write(const PdfCharCodeMap& map)
-{
-    string serialized;
-    ContainerStreamDevice stream(serialized);
+        for (auto displacement : displacements)
+            displacementEntries.push_back(utls::Format("{}", displacement));
+    }
 
-    auto& mappings = map.GetMappings();
-    assert(mappings.size() <= 65535);
-    utls::WriteUInt16BE(stream, (uint16_t)mappings.size());
-    for (auto& pair : mappings)
+    for (auto& range : map.GetRanges())
     {
-        stream.Write((char)pair.first.CodeSpaceSize);
-        serializeCode(stream, pair.first.Code, pair.first.CodeSpaceSize);
-        assert(pair.second.size() <= 255);
-        stream.Write((char)(uint8_t)pair.second.size());
-        for (unsigned i = 0; i < pair.second.size(); i++)
-            utls::WriteUInt32BE(stream, pair.second[i]);
+        // NOTE: Ranges in predefined CMaps have single code point destinations
+        if (range.Size > 65535 || range.DstCodeLo.size() != 1)
+            throw runtime_error("Unsupported range");
+
+        rangeEntries.push_back(utls::Format("{{{},{},{},{}}}", range.SrcCodeLo.Code, (uint32_t)*range.DstCodeLo,
+            range.Size, range.SrcCodeLo.CodeSpaceSize));
     }
 
-    auto& ranges = map.GetRanges();
-    assert(ranges.size() <= 65535);
-    utls::WriteUInt16BE(stream, (uint16_t)ranges.size());
-    for (auto& range : ranges)
+    if (mappingEntries.size() != 0)
     {
-        stream.Write((char)range.SrcCodeLo.CodeSpaceSize);
-        serializeCode(stream, range.SrcCodeLo.Code, range.SrcCodeLo.CodeSpaceSize);
-        assert(range.Size <= 65535);
-        utls::WriteUInt16BE(stream, (uint16_t)range.Size);
-        assert(range.DstCodeLo.size() <= 255);
-        stream.Write((char)(uint8_t)range.DstCodeLo.size());
-        for (unsigned i = 0; i < range.DstCodeLo.size(); i++)
-            utls::WriteUInt32BE(stream, range.DstCodeLo[i]);
+        writeArray("PdfCharCodeTableMapping", "mappings", mappingEntries);
+        writeArray("uint32_t", "displacements", displacementEntries);
     }
-
-    auto filter = PdfFilterFactory::Create(PdfFilterType::FlateDecode);
-    charbuff compressed;
-    filter->EncodeTo(compressed, serialized);
-    writeString(compressed);
+    if (rangeEntries.size() != 0)
+        writeArray("PdfCharCodeTableRange", "ranges", rangeEntries);
+    if (codePointEntries.size() != 0)
+        writeArray("codepoint", "codePoints", codePointEntries);
+
+    s_Stream->Write(utls::Format("            static constexpr PdfCharCodeMapTable table = {{ {}, {}, {}, {}, {}, {}, {} }};\n",
+        mappingEntries.size() == 0 ? "nullptr" : "mappings", mappingEntries.size(),
+        mappingEntries.size() == 0 ? "nullptr" : "displacements", displacementEntries.size(),
+        rangeEntries.size() == 0 ? "nullptr" : "ranges", rangeEntries.size(),
+        codePointEntries.size() == 0 ? "nullptr" : "codePoints"));
 }
 
 void write(const PdfCMapEncoding& encoding, Context& context)
@@ -372,26 +369,14 @@ void write(const PdfCMapEncoding& encoding, Context& context)
     s_Stream->Write(methodName);
     s_Stream->Write("()\n");
     s_Stream->Write("        {\n");
-    s_Stream->Write("            static constexpr const char serialized[] =\n");
     write(map);
-    s_Stream->Write(";\n");
-    s_Stream->Write("            static struct Init\n");
-    s_Stream->Write("            {\n");
-    s_Stream->Write("                Init()\n");
-    s_Stream->Write("                {\n");
-    s_Stream->Write("                    CodeUnitMap mappings;\n");
-    s_Stream->Write("                    CodeUnitRanges ranges;\n");
-    s_Stream->Write("                    buildMappings(string_view(serialized, std::size(serialized) - 1), mappings, ranges);\n");
-    s_Stream->Write("                    map.reset(new PdfCMapEncoding(PdfCharCodeMap(\n");
-    s_Stream->Write(fmt::format("                        std::move(mappings), std::move(ranges), PdfEncodingLimits({}, {}, PdfCharCode({}, {}), PdfCharCode({}, {}))),\n",
+    s_Stream->Write("            static PdfCMapEncodingConstPtr map(new PdfCMapEncoding(PdfCharCodeMap(table,\n");
+    s_Stream->Write(utls::Format("                PdfEncodingLimits({}, {}, PdfCharCode({}, {}), PdfCharCode({}, {}))),\n",
         mapLimits.MinCodeSize, mapLimits.MaxCodeSize, mapLimits.FirstChar.Code, mapLimits.FirstChar.CodeSpaceSize, mapLimits.LastChar.Code, mapLimits.LastChar.CodeSpaceSize));
-    s_Stream->Write(fmt::format(R"(                        true, "{}"_n, PdfCIDSystemInfo{{ "{}", "{}", {} }}, {}, PdfEncodingLimits({}, {}, PdfCharCode({}, {}), PdfCharCode({}, {}))));)",
+    s_Stream->Write(utls::Format(R"(                true, "{}"_n, PdfCIDSystemInfo{{ "{}", "{}", {} }}, {}, PdfEncodingLimits({}, {}, PdfCharCode({}, {}), PdfCharCode({}, {}))));)",
         name, info.Registry.GetString(), info.Ordering.GetString(), info.Supplement, (encoding.GetWMode() == PdfWModeKind::Vertical ? 1 : 0),
         limits.MinCodeSize, limits.MaxCodeSize, limits.FirstChar.Code, limits.FirstChar.CodeSpaceSize, limits.LastChar.Code, limits.LastChar.CodeSpaceSize));
-    s_Stream->Write("\n                }\n");
-    s_Stream->Write("                PdfCMapEncodingConstPtr map;\n");
-    s_Stream->Write("            } init;\n");
-    s_Stream->Write("            return init.map;\n");
+    s_Stream->Write("\n            return map;\n");
     s_Stream->Write("        }\n\n");
     context.Maps.push_back({ (string)name, methodName });
 }
@@ -1,110 +1,246 @@
-// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
-// SPDX-License-Identifier: MIT-0
-
-#include <PdfTest.h>
-
-using namespace std;
-using namespace PoDoFo;
-
-TEST_CASE("TestAppendDocument")
-{
-    PdfMemDocument srcDoc;
-    srcDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_SignatureCreationQuickKeyAll.pdf"));
-
-    PdfMemDocument dstDoc;
-    dstDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_DigitalSignatures_in_PDF.pdf"));
-
-    unsigned dstPageCount = dstDoc.GetPages().GetCount();
-    unsigned srcPageCount = srcDoc.GetPages().GetCount();
-
-    dstDoc.GetPages().AppendDocumentPages(srcDoc);
-
-    REQUIRE(dstDoc.GetPages().GetCount() == dstPageCount + srcPageCount);
-
-    string outputPath = TestUtils::GetTestOutputFilePath("TestAppendDocument.pdf");
-    dstDoc.Save(outputPath);
-
-    // Reload and verify
-    PdfMemDocument reloaded;
-    reloaded.Load(outputPath);
-    REQUIRE(reloaded.GetPages().GetCount() == dstPageCount + srcPageCount);
-}
-
-TEST_CASE("TestFillXObjectMiniature")
-{
-    PdfMemDocument srcDoc;
-    srcDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_SignatureCreationQuickKeyAll.pdf"));
-
-    auto& srcPage = srcDoc.GetPages().GetPageAt(0);
-    Rect srcBox = srcPage.GetMediaBox();
-
-    PdfMemDocument dstDoc;
-
-    // Create an XObject filled from the source page
-    auto xobj = dstDoc.CreateXObjectForm(Rect());
-    xobj->FillFromPage(srcPage);
-
-    // Create a page sized to fit 4 miniatures (2x2 grid)
-    double pageWidth = srcBox.Width;
-    double pageHeight = srcBox.Height;
-    auto& dstPage = dstDoc.GetPages().CreatePage(Rect(0, 0, pageWidth, pageHeight));
-
-    // Scale to roughly a quarter of the page (half width, half height)
-    double scale = 0.5;
-    double miniHeight = srcBox.Height * scale;
-
-    PdfPainter painter;
-    painter.SetCanvas(dstPage);
-    // Draw at top-left quadrant
-    painter.DrawXObject(*xobj, 0, pageHeight - miniHeight, scale, scale);
-    painter.FinishDrawing();
-
-    string outputPath = TestUtils::GetTestOutputFilePath("TestFillXObjectMiniature.pdf");
-    dstDoc.Save(outputPath);
-
-    // Reload and verify basic structure
-    PdfMemDocument reloaded;
-    reloaded.Load(outputPath);
-    REQUIRE(reloaded.GetPages().GetCount() == 1);
-    Rect reloadedBox = reloaded.GetPages().GetPageAt(0).GetMediaBox();
-    ASSERT_EQUAL(reloadedBox.Width, pageWidth);
-    ASSERT_EQUAL(reloadedBox.Height, pageHeight);
-}
-
-TEST_CASE("TestAppendInheritedAttributes")
-{
-    // Start from a blank document and make its page inherit /Resources
-    // from the /Pages tree root, with an indirect reference inside it
-    PdfMemDocument srcDoc;
-    srcDoc.Load(TestUtils::GetTestInputFilePath("blank.pdf"));
-
-    auto& marker = srcDoc.GetObjects().CreateDictionaryObject();
-    marker.GetDictionary().AddKey("MarkerTag"_n, PdfString("INHERITED_MARKER"));
-
-    auto& xobjects = srcDoc.GetObjects().CreateDictionaryObject();
-    xobjects.GetDictionary().AddKeyIndirect("XMarker"_n, marker);
-
-    auto& resources = srcDoc.GetObjects().CreateDictionaryObject();
-    resources.GetDictionary().AddKeyIndirect("XObject"_n, xobjects);
-
-    srcDoc.GetPages().GetPageAt(0).GetObject().GetDictionary().RemoveKey("Resources");
-    srcDoc.GetPages().GetObject().GetDictionary().AddKeyIndirect("Resources"_n, resources);
-
-    // Append into a fresh destination so new object numbers overlap the
-    // source ones, which would corrupt references if remapping happened twice
-    PdfMemDocument dstDoc;
-    dstDoc.GetPages().AppendDocumentPages(srcDoc);
-
-    REQUIRE(dstDoc.GetPages().GetCount() == 1);
-
-    auto& newPage = dstDoc.GetPages().GetPageAt(0);
-    auto* res = newPage.GetDictionary().FindKeyParent("Resources");
-    REQUIRE(res != nullptr);
-    auto* xobjDict = res->GetDictionary().FindKey("XObject");
-    REQUIRE(xobjDict != nullptr);
-    auto* markerResolved = xobjDict->GetDictionary().FindKey("XMarker");
-    REQUIRE(markerResolved != nullptr);
-    auto* tag = markerResolved->GetDictionary().FindKey("MarkerTag");
-    REQUIRE(tag != nullptr);
-    REQUIRE(tag->GetString().GetString() == "INHERITED_MARKER");
-}
+// SPDX-FileCopyrightText: 2026 Francesco Pretto <ceztko@gmail.com>
+// SPDX-License-Identifier: MIT-0
+
+#include <PdfTest.h>
+
+using namespace std;
+using namespace PoDoFo;
+
+TEST_CASE("TestAppendDocument")
+{
+    PdfMemDocument srcDoc;
+    srcDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_SignatureCreationQuickKeyAll.pdf"));
+
+    PdfMemDocument dstDoc;
+    dstDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_DigitalSignatures_in_PDF.pdf"));
+
+    unsigned dstPageCount = dstDoc.GetPages().GetCount();
+    unsigned srcPageCount = srcDoc.GetPages().GetCount();
+
+    dstDoc.GetPages().AppendDocumentPages(srcDoc);
+
+    REQUIRE(dstDoc.GetPages().GetCount() == dstPageCount + srcPageCount);
+
+    string outputPath = TestUtils::GetTestOutputFilePath("TestAppendDocument.pdf");
+    dstDoc.Save(outputPath);
+
+    // Reload and verify
+    PdfMemDocument reloaded;
+    reloaded.Load(outputPath);
+    REQUIRE(reloaded.GetPages().GetCount() == dstPageCount + srcPageCount);
+}
+
+TEST_CASE("TestFillXObjectMiniature")
+{
+    PdfMemDocument srcDoc;
+    srcDoc.Load(TestUtils::GetTestInputFilePath("TechDocs", "Acrobat_SignatureCreationQuickKeyAll.pdf"));
+
+    auto& srcPage = srcDoc.GetPages().GetPageAt(0);
+    Rect srcBox = srcPage.GetMediaBox();
+
+    PdfMemDocument dstDoc;
+
+    // Create an XObject filled from the source page
+    auto xobj = dstDoc.CreateXObjectForm(Rect());
+    xobj->FillFromPage(srcPage);
+
+    // Create a page sized to fit 4 miniatures (2x2 grid)
+    double pageWidth = srcBox.Width;
+    double pageHeight = srcBox.Height;
+    auto& dstPage = dstDoc.GetPages().CreatePage(Rect(0, 0, pageWidth, pageHeight));
+
+    // Scale to roughly a quarter of the page (half width, half height)
+    double scale = 0.5;
+    double miniHeight = srcBox.Height * scale;
+
+    PdfPainter painter;
+    painter.SetCanvas(dstPage);
+    // Draw at top-left quadrant
+    painter.DrawXObject(*xobj, 0, pageHeight - miniHeight, scale, scale);
+    painter.FinishDrawing();
+
+    string outputPath = TestUtils::GetTestOutputFilePath("TestFillXObjectMiniature.pdf");
+    dstDoc.Save(outputPath);
+
+    // Reload and verify basic structure
+    PdfMemDocument reloaded;
+    reloaded.Load(outputPath);
+    REQUIRE(reloaded.GetPages().GetCount() == 1);
+    Rect reloadedBox = reloaded.GetPages().GetPageAt(0).GetMediaBox();
+    ASSERT_EQUAL(reloadedBox.Width, pageWidth);
+    ASSERT_EQUAL(reloadedBox.Height, pageHeight);
+}
+
+TEST_CASE("TestAppendInheritedAttributes")
+{
+    // Start from a blank document and make its page inherit /Resources
+    // from the /Pages tree root, with an indirect reference inside it
+    PdfMemDocument srcDoc;
+    srcDoc.Load(TestUtils::GetTestInputFilePath("blank.pdf"));
+
+    auto& marker = srcDoc.GetObjects().CreateDictionaryObject();
+    marker.GetDictionary().AddKey("MarkerTag"_n, PdfString("INHERITED_MARKER"));
+
+    auto& xobjects = srcDoc.GetObjects().CreateDictionaryObject();
+    xobjects.GetDictionary().AddKeyIndirect("XMarker"_n, marker);
+
+    auto& resources = srcDoc.GetObjects().CreateDictionaryObject();
+    resources.GetDictionary().AddKeyIndirect("XObject"_n, xobjects);
+
+    srcDoc.GetPages().GetPageAt(0).GetObject().GetDictionary().RemoveKey("Resources");
+    srcDoc.GetPages().GetObject().GetDictionary().AddKeyIndirect("Resources"_n, resources);
+
+    // Append into a fresh destination so new object numbers overlap the
+    // source ones, which would corrupt references if remapping happened twice
+    PdfMemDocument dstDoc;
+    dstDoc.GetPages().AppendDocumentPages(srcDoc);
+
+    REQUIRE(dstDoc.GetPages().GetCount() == 1);
+
+    auto& newPage = dstDoc.GetPages().GetPageAt(0);
+    auto* res = newPage.GetDictionary().FindKeyParent("Resources");
+    REQUIRE(res != nullptr);
+    auto* xobjDict = res->GetDictionary().FindKey("XObject");
+    REQUIRE(xobjDict != nullptr);
+    auto* markerResolved = xobjDict->GetDictionary().FindKey("XMarker");
+    REQUIRE(markerResolved != nullptr);
+    auto* tag = markerResolved->GetDictionary().FindKey("MarkerTag");
+    REQUIRE(tag != nullptr);
+    REQUIRE(tag->GetString().GetString() == "INHERITED_MARKER");
+}
+
+TEST_CASE("TestDeduplicateAppendedObjects")
+{
+    constexpr unsigned CopyCount = 5;
+    string srcPath = TestUtils::GetTestOutputFilePath("TestDeduplicateAppendedObjectsSource.pdf");
+    {
+        PdfMemDocument srcDoc;
+        auto& page = srcDoc.GetPages().CreatePage(PdfPageSize::A4);
+        auto logo = srcDoc.CreateXObjectForm(Rect(0, 0, 100, 100));
+        {
+            PdfPainter painter;
+            painter.SetCanvas(*logo);
+            painter.DrawRectangle(10, 10, 80, 80, PdfPathDrawMode::Fill);
+            painter.FinishDrawing();
+        }
+
+        // Add a reference cycle, which shall be merged as well
+        auto& first = srcDoc.GetObjects().CreateDictionaryObject();
+        auto& second = srcDoc.GetObjects().CreateDictionaryObject();
+        first.GetDictionary().AddKey("Name"_n, PdfString("First"));
+        first.GetDictionary().AddKeyIndirect("Next"_n, second);
+        second.GetDictionary().AddKey("Name"_n, PdfString("Second"));
+        second.GetDictionary().AddKeyIndirect("Next"_n, first);
+        logo->GetDictionary().AddKeyIndirect("Cycle"_n, first);
+
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        painter.TextState.SetFont(srcDoc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica), 12);
+        painter.DrawText("Statement", 100, 700);
+        painter.DrawXObject(*logo, 100, 500);
+        painter.FinishDrawing();
+        srcDoc.Save(srcPath);
+    }
+
+    PdfMemDocument srcDoc;
+    srcDoc.Load(srcPath);
+
+    PdfMemDocument doc;
+    for (unsigned i = 0; i < CopyCount; i++)
+        doc.GetPages().AppendDocumentPages(srcDoc);
+
+    // The form, the two cycle objects and the font objects are merged at least
+    REQUIRE(doc.DeduplicateObjects() >= (CopyCount - 1) * 4);
+    REQUIRE(doc.DeduplicateObjects() == 0);
+
+    string outputPath = TestUtils::GetTestOutputFilePath("TestDeduplicateAppendedObjects.pdf");
+    doc.Save(outputPath, PdfSaveOptions::DeduplicateObjects);
+
+    PdfMemDocument reloaded;
+    reloaded.Load(outputPath);
+    REQUIRE(reloaded.GetPages().GetCount() == CopyCount);
+
+    unsigned formCount = 0;
+    unsigned fontCount = 0;
+    unsigned cycleCount = 0;
+    for (auto obj : reloaded.GetObjects())
+    {
+        const PdfDictionary* dict;
+        if (!obj->TryGetDictionary(dict))
+            continue;
+
+        if (dict->FindKeyAsSafe<PdfName>("Subtype") == "Form")
+            formCount++;
+        else if (dict->FindKeyAsSafe<PdfName>("Type") == "Font")
+            fontCount++;
+        else if (dict->GetKey("Next") != nullptr)
+            cycleCount++;
+    }
+
+    // The embedded font is a Type0 font with a descendant CID font
+    REQUIRE(formCount == 1);
+    REQUIRE(fontCount == 2);
+    REQUIRE(cycleCount == 2);
+
+    vector<PdfTextEntry> entries;
+    reloaded.GetPages().GetPageAt(CopyCount - 1).ExtractTextTo(entries);
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].Text == "Statement");
+}
+
+TEST_CASE("TestDeduplicateAnnotationsWithoutType")
+{
+    charbuff pdfBuffer;
+    {
+        PdfMemDocument doc;
+        auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& properties = page.GetResources().GetDictionary().AddKey("Properties"_n, PdfDictionary()).GetDictionary();
+        auto addTwice = [&](const string_view& name, const function<void(PdfDictionary&)>& init)
+        {
+            for (unsigned i = 0; i < 2; i++)
+            {
+                auto& obj = doc.GetObjects().CreateDictionaryObject();
+                init(obj.GetDictionary());
+                properties.AddKey(PdfName(utls::Format("{}{}", name, i)), obj.GetIndirectReference());
+            }
+        };
+
+        // Annotations and fields with no /Type, which must be kept distinct
+        addTwice("Link", [](PdfDictionary& dict)
+        {
+            dict.AddKey("Subtype"_n, "Link"_n);
+            PdfArray rect;
+            Rect(0, 0, 10, 10).ToArray(rect);
+            dict.AddKey("Rect"_n, rect);
+        });
+        addTwice("Widget", [](PdfDictionary& dict)
+        {
+            dict.AddKey("Subtype"_n, "Widget"_n);
+        });
+        addTwice("Field", [](PdfDictionary& dict)
+        {
+            dict.AddKey("FT"_n, "Tx"_n);
+            dict.AddKey("T"_n, PdfString("Field"));
+        });
+        // Plain dictionaries, which are merged instead
+        addTwice("Plain", [](PdfDictionary& dict)
+        {
+            dict.AddKey("Value"_n, PdfString("Plain"));
+        });
+
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer);
+    REQUIRE(doc.DeduplicateObjects() == 1);
+
+    auto& properties = doc.GetPages().GetPageAt(0).GetResources().GetDictionary().MustFindKey("Properties").GetDictionary();
+    for (auto name : { "Link"sv, "Widget"sv, "Field"sv })
+    {
+        REQUIRE(properties.MustGetKey(utls::Format("{}0", name)).GetReference()
+            != properties.MustGetKey(utls::Format("{}1", name)).GetReference());
+    }
+    REQUIRE(properties.MustGetKey("Plain0").GetReference() == properties.MustGetKey("Plain1").GetReference());
+}
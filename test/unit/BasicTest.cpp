@@ -4,6 +4,7 @@
 
 #include <PdfTest.h>
 #include <podofo/optional/PdfNames.h>
+#include <podofo/private/LruCache.h>
 
 using namespace std;
 using namespace PoDoFo;
@@ -298,3 +299,32 @@ startxref
     doc.Reset();
     REQUIRE(doc.GetMagicOffset() == 0);
 }
+
+TEST_CASE("TestLruCache")
+{
+    LruCache<int> cache(2);
+    REQUIRE(*cache.Add("a", 1) == 1);
+    REQUIRE(*cache.Add("b", 2) == 2);
+
+    // The first value is kept
+    REQUIRE(*cache.Add("a", 3) == 1);
+
+    // "b" is the least recently used entry
+    (void)cache.Add("c", 3);
+    REQUIRE(cache.Find("b") == nullptr);
+    REQUIRE(*cache.Find("a") == 1);
+    REQUIRE(*cache.Find("c") == 3);
+
+    REQUIRE(*cache.Set("a", 4) == 4);
+    cache.SetMaxSize(1);
+    REQUIRE(cache.GetSize() == 1);
+    REQUIRE(*cache.Find("a") == 4);
+
+    cache.EraseIf([](const string& key) { return key == "a"; });
+    REQUIRE(cache.GetSize() == 0);
+
+    // Nothing is cached with no size
+    cache.SetMaxSize(0);
+    REQUIRE(cache.Add("d", 5) == nullptr);
+    REQUIRE(cache.Find("d") == nullptr);
+}
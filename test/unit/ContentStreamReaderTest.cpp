@@ -61,3 +61,148 @@ TEST_CASE("TestContentStreamReaderTerminates")
         REQUIRE(iterations < maxIterations);
     }
 }
+
+TEST_CASE("TestContentStreamRewriter")
+{
+    string_view input = "q\n1 0 0 RG\n10 10 m\n20 20 l\nS\nBI /W 2 /H 1 /BPC 8 /CS /G ID \x01\x02 EI\nBI /W 1 /H 1 /BPC 8 /CS /G ID \x03 EI\nQ\n"sv;
+
+    PdfContentStreamRewriter rewriter;
+    rewriter.AddTransform([](PdfContent& content)
+    {
+        // Replace the stroking color
+        if (content.GetType() == PdfContentType::Operator && content->Operator == PdfOperator::RG)
+        {
+            content->Stack[0] = PdfVariant(static_cast<int64_t>(1));
+            content->Stack[2] = PdfVariant(static_cast<int64_t>(0));
+        }
+
+        return true;
+    });
+    rewriter.AddTransform([](PdfContent& content)
+    {
+        // Drop the line segment and the first inline image
+        if (content.GetType() == PdfContentType::Operator && content->Operator == PdfOperator::l)
+            return false;
+
+        if (content.GetType() == PdfContentType::ImageData && content->InlineImageData[0] == '\x01')
+            return false;
+
+        return true;
+    });
+
+    string output;
+    StringStreamDevice outputDevice(output);
+    rewriter.Rewrite(std::make_shared<SpanStreamDevice>(input), outputDevice);
+    REQUIRE(output == "q\n0 0 1 RG\n10 10 m\nS\nBI\n/BPC 8\n/CS /G\n/H 1\n/W 1\nID \x03 EI\nQ\n"sv);
+}
+
+TEST_CASE("TestContentStreamRewriterCanvas")
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+    {
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        painter.GraphicsState.SetNonStrokingColor(PdfColor(1.0, 0.0, 0.0));
+        painter.DrawRectangle(10, 10, 100, 100, PdfPathDrawMode::Fill);
+        painter.FinishDrawing();
+    }
+
+    // Strip all colors from the page
+    PdfContentStreamRewriter rewriter;
+    rewriter.AddTransform([](PdfContent& content)
+    {
+        return content.GetType() != PdfContentType::Operator || content->Operator != PdfOperator::rg;
+    });
+    rewriter.Rewrite(page);
+
+    string contents;
+    {
+        PdfCanvasInputDevice input(page);
+        StringStreamDevice output(contents);
+        input.CopyTo(output);
+    }
+    REQUIRE(contents == "q\n10 10 100 100 re\nf\nQ\n");
+    REQUIRE(page.GetContents()->GetObject().GetDataType() == PdfDataType::Array);
+}
+
+static void readContents(const PdfCanvas& canvas, const shared_ptr<PdfContentStreamCache>& cache, vector<string>& contents)
+{
+    PdfContentReaderArgs args;
+    args.FormXObjectCache = cache;
+    PdfContentStreamReader reader(canvas, args);
+    PdfContent content;
+    charbuff buffer;
+    while (reader.TryReadNext(content))
+    {
+        string str = utls::Format("{} ", (int)content.GetType());
+        for (auto& operand : content->Stack)
+        {
+            operand.ToString(buffer);
+            str.append(buffer.data(), buffer.size());
+            str.push_back(' ');
+        }
+        str.append(content->Keyword);
+        str.append(content->InlineImageData.data(), content->InlineImageData.size());
+        contents.push_back(str);
+    }
+}
+
+TEST_CASE("TestContentStreamReaderFormXObjectCache")
+{
+    PdfMemDocument doc;
+    auto form = doc.CreateXObjectForm(Rect(0, 0, 100, 20));
+    {
+        PdfPainter painter;
+        painter.SetCanvas(*form);
+        painter.TextState.SetFont(doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica), 12);
+        painter.DrawText("Tile", 0, 5);
+        painter.FinishDrawing();
+    }
+
+    // Append an inline image to the form contents
+    auto& formStream = form->GetObject().MustGetStream();
+    auto data = formStream.GetCopy();
+    data.append("BI /W 1 /H 1 /BPC 8 /CS /G ID \x05 EI\n");
+    formStream.SetData(data);
+
+    {
+        PdfPainter painter;
+        painter.SetCanvas(doc.GetPages().CreatePage(PdfPageSize::A4));
+        for (unsigned i = 0; i < 10; i++)
+            painter.DrawXObject(*form, 10, 10 + i * 30);
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestContentStreamReaderFormXObjectCache.pdf");
+    doc.Save(outputPath);
+
+    PdfMemDocument reloaded;
+    reloaded.Load(outputPath);
+    auto& page = reloaded.GetPages().GetPageAt(0);
+
+    vector<string> expected;
+    readContents(page, nullptr, expected);
+
+    auto cache = std::make_shared<PdfContentStreamCache>();
+    vector<string> contents;
+    readContents(page, cache, contents);
+    REQUIRE(cache->GetSize() == 1);
+    REQUIRE(contents == expected);
+
+    // Read again, now entirely replaying the cached form
+    contents.clear();
+    readContents(page, cache, contents);
+    REQUIRE(contents == expected);
+
+    PdfTextExtractParams params;
+    params.FormXObjectCache = cache;
+    vector<PdfTextEntry> entries;
+    page.ExtractTextTo(entries, params);
+    REQUIRE(entries.size() == 10);
+    for (auto& entry : entries)
+        REQUIRE(entry.Text == "Tile");
+
+    cache->Clear();
+    REQUIRE(cache->GetSize() == 0);
+}
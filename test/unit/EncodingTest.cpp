@@ -230,6 +230,98 @@ end
     REQUIRE(map.GetCharMap().IsTrivialIdentity());
 }
 
+TEST_CASE("TestPredefinedCMap")
+{
+    auto& map = PdfEncodingMapFactory::GetPredefinedCMapInstance("B5pc-H").GetCharMap();
+    REQUIRE(!map.IsEmpty());
+
+    // Direct mappings
+    CodePointSpan codePoints;
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x80, 1), codePoints));
+    REQUIRE(*codePoints == (codepoint)61);
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0xA1F7, 2), codePoints));
+    REQUIRE(*codePoints == (codepoint)247);
+    REQUIRE(!map.TryGetCodePoints(PdfCharCode(0x80, 2), codePoints));
+
+    // Range mappings
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x20, 1), codePoints));
+    REQUIRE(*codePoints == (codepoint)1);
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x7E, 1), codePoints));
+    REQUIRE(*codePoints == (codepoint)95);
+    REQUIRE(!map.TryGetCodePoints(PdfCharCode(0x1F, 1), codePoints));
+
+    // Reverse lookup
+    PdfCharCode code;
+    REQUIRE(map.TryGetCharCode((codepoint)247, code));
+    REQUIRE(code == PdfCharCode(0xA1F7, 2));
+    REQUIRE(map.TryGetCharCode((codepoint)95, code));
+    REQUIRE(code == PdfCharCode(0x7E, 1));
+
+    // Mappings are materialized on demand
+    auto& mappings = map.GetMappings();
+    REQUIRE(mappings.size() == 28);
+    REQUIRE(*mappings.at(PdfCharCode(0xA1F7, 2)) == (codepoint)247);
+    REQUIRE(map.GetRanges().size() == 219);
+}
+
+TEST_CASE("TestFrozenCharCodeMap")
+{
+    constexpr string_view toUnicode = R"(
+/CIDInit /ProcSet findresource begin
+12 dict begin
+begincmap
+/CMapName /Test def
+/CMapType 2 def
+1 begincodespacerange
+<0000> <FFFF>
+endcodespacerange
+2 beginbfchar
+<0003> <0020>
+<0110> <00660069>
+endbfchar
+1 beginbfrange
+<0024> <0026> <0041>
+endbfrange
+endcmap
+CMapName currentdict /CMap defineresource pop
+end
+end
+)";
+
+    PdfMemDocument doc;
+    auto& cmapObj = doc.GetObjects().CreateDictionaryObject();
+    cmapObj.GetOrCreateStream().SetData(toUnicode);
+    auto encoding = PdfEncodingMapFactory::ParseCMapEncoding(cmapObj);
+    auto& map = dynamic_cast<const PdfCMapEncoding&>(*encoding).GetCharMap();
+    REQUIRE(map.IsFrozen());
+
+    CodePointSpan codePoints;
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x03, 2), codePoints));
+    REQUIRE(*codePoints == U' ');
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x25, 2), codePoints));
+    REQUIRE(*codePoints == U'B');
+    REQUIRE(map.TryGetCodePoints(PdfCharCode(0x110, 2), codePoints));
+    REQUIRE(codePoints.view().size() == 2);
+    REQUIRE(!map.TryGetCodePoints(PdfCharCode(0x27, 2), codePoints));
+
+    PdfCharCode code;
+    REQUIRE(map.TryGetCharCode(U'C', code));
+    REQUIRE(code == PdfCharCode(0x26, 2));
+    REQUIRE(!map.TryGetCharCode(U'D', code));
+    char32_t ligature[] = { U'f', U'i' };
+    REQUIRE(map.TryGetCharCode(unicodeview(ligature, 2), code));
+    REQUIRE(code == PdfCharCode(0x110, 2));
+
+    // Modifying the map discards the lookup tables
+    PdfCharCodeMap copy;
+    copy.PushMapping(PdfCharCode(0x41, 1), U'A');
+    copy.Freeze();
+    REQUIRE(copy.IsFrozen());
+    copy.PushMapping(PdfCharCode(0x42, 1), U'B');
+    REQUIRE(!copy.IsFrozen());
+    REQUIRE(copy.TryGetCodePoints(PdfCharCode(0x42, 1), codePoints));
+}
+
 void PdfEncodingTest::TestToUnicodeParse()
 {
     string_view toUnicode =
@@ -3,6 +3,10 @@
 // SPDX-License-Identifier: MIT-0
 
 #include <PdfTest.h>
+
+#include <atomic>
+#include <thread>
+
 #include <podofo/private/PdfParser.h>
 #include <podofo/private/OpenSSLInternal.h>
 
@@ -56,6 +60,20 @@ namespace
                 PdfPermissions::HighPrint;
         }
     } s_init;
+
+    struct EncryptionParams
+    {
+        PdfEncryptionAlgorithm Algorithm;
+        PdfKeyLength KeyLength;
+    };
+
+    // The RC4 and AES algorithms with their longest keys, to be
+    // covered by test cases with GENERATE(from_range(s_algorithms))
+    const vector<EncryptionParams> s_algorithms = {
+        { PdfEncryptionAlgorithm::RC4V2, PdfKeyLength::L128 },
+        { PdfEncryptionAlgorithm::AESV2, PdfKeyLength::L128 },
+        { PdfEncryptionAlgorithm::AESV3R6, PdfKeyLength::L256 },
+    };
 }
 
 METHOD_AS_TEST_CASE(PdfEncryptTest::TestLoadEncrypedFilePdfParser, "TestLoadEncrypedFilePdfParser")
@@ -355,6 +373,186 @@ TEST_CASE("TestEncryptBigBuffer")
     }
 }
 
+// Test eager loading of many encrypted streams, that are decrypted in parallel
+TEST_CASE("TestLoadEncryptedStreamsEagerly")
+{
+    auto params = GENERATE(from_range(s_algorithms));
+
+    constexpr unsigned StreamCount = 50;
+
+    charbuff pdfBuffer;
+    vector<PdfReference> refs;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& arr = doc.GetCatalog().GetDictionary().AddKey("TestStreams"_n, PdfArray()).GetArray();
+        for (unsigned j = 0; j < StreamCount; j++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject();
+            // Streams of different lengths, including empty ones
+            obj.GetOrCreateStream().SetData(string(j * 37, (char)('a' + j % 26)), true);
+            arr.Add(obj.GetIndirectReference());
+            refs.push_back(obj.GetIndirectReference());
+        }
+
+        doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default,
+            params.Algorithm, params.KeyLength);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device, PdfSaveOptions::NoFlateCompress);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer, PdfLoadOptions::LoadStreamsEagerly, PDF_USER_PASSWORD);
+    for (unsigned j = 0; j < StreamCount; j++)
+    {
+        auto& obj = doc.GetObjects().MustGetObject(refs[j]);
+        REQUIRE(obj.MustGetStream().GetCopy() == charbuff(string(j * 37, (char)('a' + j % 26))));
+    }
+}
+
+TEST_CASE("TestLazyStringDecryption")
+{
+    auto params = GENERATE(from_range(s_algorithms));
+
+    charbuff pdfBuffer;
+    PdfReference ref;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetDictionary().AddKey("Literal"_n, PdfString("Literal value"));
+        obj.GetDictionary().AddKey("Hex"_n, PdfString::FromRaw("Hex value"sv));
+        obj.GetDictionary().AddKey("Other"_n, PdfString("Other value"));
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("TestStrings"_n, obj);
+        ref = obj.GetIndirectReference();
+
+        doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default,
+            params.Algorithm, params.KeyLength);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer, PDF_USER_PASSWORD);
+    auto& dict = doc.GetObjects().MustGetObject(ref).GetDictionary();
+    auto& literal = dict.MustFindKey("Literal").GetString();
+    auto& hex = dict.MustFindKey("Hex").GetString();
+    REQUIRE(!literal.IsDecrypted());
+    REQUIRE(!hex.IsDecrypted());
+    REQUIRE(literal.GetString() == "Literal value");
+    REQUIRE(literal.IsDecrypted());
+    REQUIRE(hex.GetRawData() == "Hex value");
+    REQUIRE(hex.IsDecrypted());
+
+    // Strings never accessed are decrypted when saving
+    charbuff savedBuffer;
+    BufferStreamDevice device(savedBuffer);
+    doc.Save(device);
+    doc.LoadFromBuffer(savedBuffer, PDF_OWNER_PASSWORD);
+    REQUIRE(doc.GetObjects().MustGetObject(ref).GetDictionary().MustFindKey("Other").GetString() == "Other value");
+}
+
+TEST_CASE("TestConcurrentStringDecryption")
+{
+    auto params = GENERATE(from_range(s_algorithms));
+
+    constexpr unsigned ThreadCount = 8;
+    constexpr unsigned StringCount = 64;
+    charbuff pdfBuffer;
+    vector<PdfReference> refs;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& arr = doc.GetCatalog().GetDictionary().AddKey("TestStrings"_n, PdfArray()).GetArray();
+        for (unsigned j = 0; j < StringCount; j++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject();
+            obj.GetDictionary().AddKey("Value"_n, PdfString(string(j + 1, (char)('a' + j % 26))));
+            arr.Add(obj.GetIndirectReference());
+            refs.push_back(obj.GetIndirectReference());
+        }
+
+        doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default,
+            params.Algorithm, params.KeyLength);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer, PDF_USER_PASSWORD);
+    vector<const PdfString*> strings;
+    for (auto& ref : refs)
+        strings.push_back(&doc.GetObjects().MustGetObject(ref).GetDictionary().MustFindKey("Value").GetString());
+
+    // Every thread reads its own strings, all sharing the document encryption
+    atomic<unsigned> mismatches(0);
+    vector<thread> threads;
+    for (unsigned j = 0; j < ThreadCount; j++)
+    {
+        threads.emplace_back([&strings, &mismatches, j]()
+        {
+            for (unsigned k = j; k < StringCount; k += ThreadCount)
+            {
+                if (strings[k]->GetString() != string(k + 1, (char)('a' + k % 26)))
+                    mismatches++;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(mismatches == 0);
+    for (auto str : strings)
+        REQUIRE(str->IsDecrypted());
+}
+
+TEST_CASE("TestSaveReusingCiphertext")
+{
+    auto params = GENERATE(from_range(s_algorithms));
+
+    charbuff pdfBuffer;
+    PdfReference ref;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& obj = doc.GetObjects().CreateDictionaryObject();
+        obj.GetDictionary().AddKey("Value"_n, PdfString("Test value"));
+        obj.GetOrCreateStream().SetData(s_encBuffer);
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("TestStream"_n, obj);
+        ref = obj.GetIndirectReference();
+
+        doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default,
+            params.Algorithm, params.KeyLength);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+    }
+
+    // Edit the document and save it again, the untouched stream
+    // and string are copied without being decrypted
+    for (auto opts : { PdfSaveOptions::None, PdfSaveOptions::CopyUnmodifiedObjects })
+    {
+        charbuff savedBuffer;
+        {
+            PdfMemDocument doc;
+            doc.LoadFromBuffer(pdfBuffer, PDF_OWNER_PASSWORD);
+            doc.GetMetadata().SetTitle(PdfString("Edited"));
+            BufferStreamDevice device(savedBuffer);
+            doc.Save(device, opts);
+            auto& obj = doc.GetObjects().MustGetObject(ref);
+            REQUIRE(!obj.IsDelayedLoadStreamDone());
+            REQUIRE(!obj.GetDictionary().MustFindKey("Value").GetString().IsDecrypted());
+        }
+
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(savedBuffer, PDF_USER_PASSWORD);
+        auto& obj = doc.GetObjects().MustGetObject(ref);
+        REQUIRE(obj.GetDictionary().MustFindKey("Value").GetString() == "Test value");
+        REQUIRE(obj.MustGetStream().GetCopy() == s_encBuffer);
+        REQUIRE(doc.GetMetadata().GetTitle()->GetString() == "Edited");
+    }
+}
+
 TEST_CASE("TestEncryptMetadataFalse")
 {
     PdfMemDocument doc;
@@ -440,6 +638,134 @@ TEST_CASE("TestPreserveEncrypt")
     testSave(true, true);
 }
 
+// Test streams encrypted while being written by PdfStreamedDocument
+TEST_CASE("TestStreamedDocumentEncryption")
+{
+    auto params = GENERATE(from_range(s_algorithms));
+
+    // A size not multiple of the AES block size, and
+    // bigger than the chunks encrypted at once
+    constexpr unsigned BufferSize = 200003;
+    charbuff data(BufferSize);
+    for (unsigned i = 0; i < BufferSize; i++)
+        data[i] = (char)(i * 7 % 251);
+
+    charbuff pdfBuffer;
+    PdfReference rawRef;
+    PdfReference compressedRef;
+    PdfReference emptyRef;
+    {
+        auto device = std::make_shared<BufferStreamDevice>(pdfBuffer);
+        PdfStreamedDocument doc(device, PdfVersion::V1_7, PdfEncrypt::Create(PDF_USER_PASSWORD,
+            PDF_OWNER_PASSWORD, s_protection, params.Algorithm, params.KeyLength));
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& rawObj = doc.GetObjects().CreateDictionaryObject();
+        rawRef = rawObj.GetIndirectReference();
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("Raw"_n, rawObj);
+        {
+            auto output = rawObj.GetOrCreateStream().GetOutputStream(PdfFilterList());
+            // Write in pieces not aligned to the AES block size
+            output.Write(data.data(), 1000);
+            output.Write(data.data() + 1000, BufferSize - 1000);
+
+            // Close explicitly so errors finishing the stream are raised
+            output.Close();
+            ASSERT_THROW_WITH_ERROR_CODE(output.Write(data.data(), 1), PdfErrorCode::InternalLogic);
+        }
+        auto& compressedObj = doc.GetObjects().CreateDictionaryObject();
+        compressedRef = compressedObj.GetIndirectReference();
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("Compressed"_n, compressedObj);
+        compressedObj.GetOrCreateStream().SetData(data);
+        auto& emptyObj = doc.GetObjects().CreateDictionaryObject();
+        emptyRef = emptyObj.GetIndirectReference();
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("Empty"_n, emptyObj);
+        emptyObj.GetOrCreateStream().SetData(bufferview(), true);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer, PDF_USER_PASSWORD);
+    REQUIRE(doc.GetEncrypt()->GetEncryptAlgorithm() == params.Algorithm);
+    REQUIRE(doc.GetObjects().MustGetObject(rawRef).MustGetStream().GetCopy() == data);
+    REQUIRE(doc.GetObjects().MustGetObject(compressedRef).MustGetStream().GetCopy() == data);
+    REQUIRE(doc.GetObjects().MustGetObject(emptyRef).MustGetStream().GetCopy().size() == 0);
+}
+
+// Test authentication trying a list of candidate passwords
+TEST_CASE("TestPasswordAuthenticator")
+{
+    charbuff pdfBuffer;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        doc.SetEncrypted(PDF_USER_PASSWORD, PDF_OWNER_PASSWORD, PdfPermissions::Default,
+            PdfEncryptionAlgorithm::AESV3R6, PdfKeyLength::L256);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+    }
+
+    auto device = std::make_shared<SpanStreamDevice>(pdfBuffer);
+    PdfPasswordAuthenticator authenticator;
+    int passwordIndex;
+    PdfMemDocument doc;
+
+    string_view wrongPasswords[] = { "wrong1", "wrong2", "wrong3", "wrong4", "wrong5" };
+    REQUIRE(!authenticator.TryLoad(doc, device, wrongPasswords, passwordIndex));
+
+    string_view passwords[] = { "wrong1", "wrong2", "wrong3", PDF_USER_PASSWORD,
+        "wrong4", PDF_OWNER_PASSWORD, "wrong5" };
+    REQUIRE(authenticator.TryLoad(doc, device, passwords, passwordIndex));
+    REQUIRE(passwordIndex == 3);
+    REQUIRE(!doc.HasOwnerPermissions());
+    REQUIRE(doc.GetPages().GetCount() == 1);
+
+    // The cached password doesn't take priority over the candidates preceding it
+    string_view reordered[] = { "wrong1", PDF_OWNER_PASSWORD, PDF_USER_PASSWORD };
+    REQUIRE(authenticator.TryLoad(doc, device, reordered, passwordIndex));
+    REQUIRE(passwordIndex == 1);
+    REQUIRE(doc.HasOwnerPermissions());
+
+    string_view cachedLast[] = { "wrong1", "wrong2", PDF_OWNER_PASSWORD };
+    REQUIRE(authenticator.TryLoad(doc, device, cachedLast, passwordIndex));
+    REQUIRE(passwordIndex == 2);
+    REQUIRE(doc.HasOwnerPermissions());
+
+    authenticator.ClearCache();
+    REQUIRE(authenticator.TryLoad(doc, device, reordered, passwordIndex));
+    REQUIRE(passwordIndex == 1);
+    REQUIRE(doc.HasOwnerPermissions());
+
+    // Same candidates as the last time, only the cached password is tried
+    REQUIRE(authenticator.TryLoad(doc, device, reordered, passwordIndex));
+    REQUIRE(passwordIndex == 1);
+    REQUIRE(doc.HasOwnerPermissions());
+
+    // The cached password is at the same position, but a preceding candidate changed
+    string_view changedPreceding[] = { PDF_USER_PASSWORD, PDF_OWNER_PASSWORD };
+    REQUIRE(authenticator.TryLoad(doc, device, changedPreceding, passwordIndex));
+    REQUIRE(passwordIndex == 0);
+    REQUIRE(!doc.HasOwnerPermissions());
+
+    // Documents not requiring a password are just loaded
+    charbuff plainBuffer;
+    {
+        PdfMemDocument plainDoc;
+        (void)plainDoc.GetPages().CreatePage(PdfPageSize::A4);
+        BufferStreamDevice plainDevice(plainBuffer);
+        plainDoc.Save(plainDevice);
+    }
+    REQUIRE(authenticator.TryLoad(doc, std::make_shared<SpanStreamDevice>(plainBuffer), passwords, passwordIndex));
+    REQUIRE(passwordIndex == -1);
+
+    // Documents with a broken cross reference table are recovered
+    auto startXRef = plainBuffer.rfind("startxref");
+    REQUIRE(startXRef != string::npos);
+    plainBuffer.replace(startXRef, plainBuffer.size() - startXRef, "startxref\n1\n%%EOF\n");
+    REQUIRE(authenticator.TryLoad(doc, std::make_shared<SpanStreamDevice>(plainBuffer), passwords, passwordIndex));
+    REQUIRE(passwordIndex == -1);
+    REQUIRE(doc.HasBrokenXRef());
+    REQUIRE(doc.GetPages().GetCount() == 1);
+}
+
 void testEncrypt(PdfEncrypt& encrypt, PdfEncryptContext& context)
 {
     charbuff encrypted;
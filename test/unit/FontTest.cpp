@@ -4,6 +4,8 @@
 
 #include <PdfTest.h>
 
+#include <thread>
+
 #include <podofo/private/FreetypePrivate.h>
 #ifdef PODOFO_ENABLE_AFDKO
 #include <podofo/private/FontUtilsAFDKO.h>
@@ -12,6 +14,20 @@
 using namespace std;
 using namespace PoDoFo;
 
+namespace
+{
+    // Run an action when leaving the scope, also when a test fails
+    class ScopeGuard final
+    {
+    public:
+        ScopeGuard(function<void()>&& action)
+            : m_action(std::move(action)) { }
+        ~ScopeGuard() { m_action(); }
+    private:
+        function<void()> m_action;
+    };
+}
+
 TEST_CASE("TestEmbedFont")
 {
     PdfMemDocument doc;
@@ -131,6 +147,455 @@ TEST_CASE("TestGetOrCreateFontAfterEmbedAndReset")
     REQUIRE(font2.GetMetrics().GetFontName() == "LiberationSans");
 }
 
+TEST_CASE("TestFontMetricsCacheSharedByDocuments")
+{
+    auto fontPath = TestUtils::GetTestInputFilePath("Fonts", "LiberationSans-Regular.ttf");
+    charbuff fontbuffer;
+    utls::ReadTo(fontbuffer, fontPath);
+
+    PdfFontManager::ClearMetricsCache();
+    PdfMemDocument doc1;
+    auto& font1 = doc1.GetFonts().GetOrCreateFont(fontPath);
+    REQUIRE(font1.GetMetrics().GetFilePath() == fontPath);
+
+    // Metrics are loaded only once per process, by path or by data
+    PdfMemDocument doc2;
+    auto& font2 = doc2.GetFonts().GetOrCreateFont(fontPath);
+    REQUIRE(&font1 != &font2);
+    REQUIRE(&font1.GetMetrics() == &font2.GetMetrics());
+
+    PdfMemDocument doc3;
+    auto& font3 = doc3.GetFonts().GetOrCreateFontFromBuffer(fontbuffer);
+    REQUIRE(&font1.GetMetrics() == &font3.GetMetrics());
+
+    // Fonts still own their metrics after the cache is cleared
+    PdfFontManager::ClearMetricsCache();
+    PdfMemDocument doc4;
+    auto& font4 = doc4.GetFonts().GetOrCreateFont(fontPath);
+    REQUIRE(&font1.GetMetrics() != &font4.GetMetrics());
+    REQUIRE(font1.GetMetrics().GetFontName() == font4.GetMetrics().GetFontName());
+
+    // Nothing is cached when the cache is disabled
+    ScopeGuard restoreSize([prevSize = PdfFontManager::GetMetricsCacheSize()]() {
+        PdfFontManager::SetMetricsCacheSize(prevSize);
+    });
+    PdfFontManager::SetMetricsCacheSize(0);
+    PdfMemDocument doc5;
+    auto& font5 = doc5.GetFonts().GetOrCreateFontFromBuffer(fontbuffer);
+    PdfMemDocument doc6;
+    auto& font6 = doc6.GetFonts().GetOrCreateFontFromBuffer(fontbuffer);
+    REQUIRE(&font5.GetMetrics() != &font6.GetMetrics());
+    REQUIRE(&font4.GetMetrics() != &font6.GetMetrics());
+    REQUIRE(font6.GetMetrics().GetFilePath().empty());
+}
+
+TEST_CASE("TestEmbedFontsConcurrently")
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+    PdfFontCreateParams fullParams;
+    fullParams.Flags = PdfFontCreateFlags::DontSubset;
+    auto& fullFont = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Courier, fullParams);
+    PdfFont* fonts[] = {
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica),
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::TimesRoman),
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::HelveticaBold),
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::CourierBold),
+        &fullFont,
+    };
+
+    {
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        for (unsigned i = 0; i < std::size(fonts); i++)
+        {
+            painter.TextState.SetFont(*fonts[i], 12);
+            painter.DrawText(utls::Format("Font {}", i), 100, 700 - i * 20.0);
+        }
+        painter.FinishDrawing();
+    }
+
+    charbuff fullFontData(fullFont.GetMetrics().GetOrLoadFontFileData());
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestEmbedFontsConcurrently.pdf");
+    doc.Save(outputPath);
+
+    doc.Load(outputPath);
+    vector<PdfTextEntry> entries;
+    doc.GetPages().GetPageAt(0).ExtractTextTo(entries);
+    REQUIRE(entries.size() == std::size(fonts));
+    for (unsigned i = 0; i < entries.size(); i++)
+        REQUIRE(entries[i].Text == utls::Format("Font {}", i));
+
+    vector<charbuff> fontFiles;
+    for (auto obj : doc.GetObjects())
+    {
+        const PdfObject* fontFile;
+        if (obj->IsDictionary()
+            && obj->GetDictionary().FindKeyAsSafe<PdfName>("Type") == "FontDescriptor"
+            && (fontFile = obj->GetDictionary().FindKey("FontFile3")) != nullptr)
+        {
+            fontFiles.push_back(fontFile->MustGetStream().GetCopy());
+        }
+    }
+
+    // The fully embedded font program must be unchanged
+    REQUIRE(fontFiles.size() == std::size(fonts));
+    REQUIRE(std::count(fontFiles.begin(), fontFiles.end(), fullFontData) == 1);
+}
+
+static void createFontFileCacheDocument(const string_view& text, const string_view& filename, vector<charbuff>& fontFiles)
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+    PdfFontCreateParams fullParams;
+    fullParams.Flags = PdfFontCreateFlags::DontSubset;
+    {
+        PdfPainter painter;
+        painter.SetCanvas(page);
+        painter.TextState.SetFont(doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica), 12);
+        painter.DrawText(text, 100, 700);
+        painter.TextState.SetFont(doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Courier, fullParams), 12);
+        painter.DrawText(text, 100, 680);
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath(filename);
+    doc.Save(outputPath);
+
+    doc.Load(outputPath);
+    vector<PdfTextEntry> entries;
+    doc.GetPages().GetPageAt(0).ExtractTextTo(entries);
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].Text == text);
+    REQUIRE(entries[1].Text == text);
+
+    fontFiles.clear();
+    for (auto obj : doc.GetObjects())
+    {
+        const PdfObject* fontFile;
+        if (obj->IsDictionary()
+            && obj->GetDictionary().FindKeyAsSafe<PdfName>("Type") == "FontDescriptor"
+            && (fontFile = obj->GetDictionary().FindKey("FontFile3")) != nullptr)
+        {
+            fontFiles.push_back(fontFile->MustGetStream().GetCopy());
+        }
+    }
+    REQUIRE(fontFiles.size() == 2);
+}
+
+TEST_CASE("TestFontFileCache")
+{
+    vector<charbuff> expected;
+    createFontFileCacheDocument("Cached text", "TestFontFileCache1.pdf", expected);
+
+    ScopeGuard restoreSize([prevSize = PdfFontManager::GetFontFileCacheSize()]() {
+        PdfFontManager::ClearFontFileCache();
+        PdfFontManager::SetFontFileCacheSize(prevSize);
+    });
+    PdfFontManager::SetFontFileCacheSize(16);
+    vector<charbuff> fontFiles;
+    createFontFileCacheDocument("Cached text", "TestFontFileCache2.pdf", fontFiles);
+    REQUIRE(fontFiles == expected);
+
+    // Now the font programs are served by the cache
+    createFontFileCacheDocument("Cached text", "TestFontFileCache3.pdf", fontFiles);
+    REQUIRE(fontFiles == expected);
+
+    // A different glyph set builds a different subset,
+    // while the fully embedded font is unchanged
+    createFontFileCacheDocument("Other text", "TestFontFileCache4.pdf", fontFiles);
+    REQUIRE(fontFiles[0] != expected[0]);
+    REQUIRE(fontFiles[1] == expected[1]);
+
+    PdfFontManager::SetFontFileCacheSize(1);
+    createFontFileCacheDocument("Cached text", "TestFontFileCache5.pdf", fontFiles);
+    REQUIRE(fontFiles == expected);
+}
+
+TEST_CASE("TestPooledFaces")
+{
+    PdfMemDocument doc;
+    auto& font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+    charbuff data(font.GetMetrics().GetOrLoadFontFileData());
+
+    shared_ptr<const charbuff> pooledData1;
+    shared_ptr<const charbuff> pooledData2;
+    auto face1 = FT::GetOrCreatePooledFace(data, pooledData1);
+    auto face2 = FT::GetOrCreatePooledFace(charbuff(data), pooledData2);
+    REQUIRE(face1 != nullptr);
+    REQUIRE(face1 == face2);
+    REQUIRE(pooledData1 == pooledData2);
+    REQUIRE(*pooledData1 == data);
+
+    // The pooled data is recognized by its address
+    shared_ptr<const charbuff> pooledData3;
+    auto face3 = FT::GetOrCreatePooledFace(*pooledData1, pooledData3);
+    REQUIRE(face3 == face1);
+    REQUIRE(pooledData3 == pooledData1);
+
+    // Metrics loaded from the same font data share the pooled face
+    auto metrics1 = PdfFontMetrics::CreateFromBuffer(data);
+    auto metrics2 = PdfFontMetrics::CreateFromBuffer(data);
+    REQUIRE(metrics1->GetFaceHandle() == metrics2->GetFaceHandle());
+    REQUIRE(metrics1->GetOrLoadFontFileData().data() == metrics2->GetOrLoadFontFileData().data());
+
+    // Load the same glyphs concurrently on the pooled face
+    vector<FT_Pos> advances(8, -1);
+    vector<thread> threads;
+    for (unsigned i = 0; i < advances.size(); i++)
+    {
+        threads.emplace_back([&data, &advances, i]()
+        {
+            shared_ptr<const charbuff> pooledData;
+            auto face = FT::GetOrCreatePooledFace(data, pooledData);
+            for (unsigned j = 0; j < 100; j++)
+            {
+                unique_lock<recursive_mutex> lock(FT::GetFaceMutex(face.get()));
+                if (FT_Load_Glyph(face.get(), 36, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP) != 0)
+                    return;
+
+                advances[i] = face->glyph->metrics.horiAdvance;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    REQUIRE(advances[0] > 0);
+    for (auto advance : advances)
+        REQUIRE(advance == advances[0]);
+
+    // Documents loaded concurrently share the faces of the embedded fonts
+    {
+        PdfPainter painter;
+        painter.SetCanvas(doc.GetPages().CreatePage(PdfPageSize::A4));
+        painter.TextState.SetFont(font, 12);
+        painter.DrawText("Shared face", 100, 700);
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestPooledFaces.pdf");
+    doc.Save(outputPath);
+
+    vector<string> texts(4);
+    threads.clear();
+    for (unsigned i = 0; i < texts.size(); i++)
+    {
+        threads.emplace_back([&outputPath, &texts, i]()
+        {
+            PdfMemDocument loaded;
+            loaded.Load(outputPath);
+            vector<PdfTextEntry> entries;
+            loaded.GetPages().GetPageAt(0).ExtractTextTo(entries);
+            if (entries.size() == 1)
+                texts[i] = entries[0].Text;
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& text : texts)
+        REQUIRE(text == "Shared face");
+}
+
+TEST_CASE("TestLoadedFontWidths")
+{
+    PdfMemDocument doc;
+    PdfFontCreateParams simpleParams;
+    simpleParams.Flags = PdfFontCreateFlags::PreferNonCID;
+    PdfFont* fonts[] = {
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica),
+        &doc.GetFonts().GetStandard14Font(PdfStandard14FontType::TimesRoman, simpleParams),
+    };
+
+    string_view text = "Width lookup";
+    PdfTextState state;
+    state.FontSize = 12;
+    vector<double> expected;
+    {
+        PdfPainter painter;
+        painter.SetCanvas(doc.GetPages().CreatePage(PdfPageSize::A4));
+        for (unsigned i = 0; i < std::size(fonts); i++)
+        {
+            state.Font = fonts[i];
+            expected.push_back(fonts[i]->GetStringLength(text, state));
+            painter.TextState.SetFont(*fonts[i], 12);
+            painter.DrawText(text, 100, 700 - i * 20.0);
+        }
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestLoadedFontWidths.pdf");
+    doc.Save(outputPath);
+
+    PdfMemDocument loaded;
+    loaded.Load(outputPath);
+    auto& resources = loaded.GetPages().GetPageAt(0).GetResources();
+    vector<double> lengths;
+    for (auto& pair : resources.GetDictionary().MustFindKey("Font").GetDictionary())
+    {
+        auto font = resources.GetFont(pair.first);
+        REQUIRE(font != nullptr);
+        REQUIRE(font->IsObjectLoaded());
+        state.Font = font;
+        auto encoded = font->GetEncoding().ConvertToEncoded(text);
+        double length;
+        REQUIRE(font->TryGetEncodedStringLength(PdfString::FromRaw(encoded), state, length));
+        lengths.push_back(length);
+
+        // Codes out of the /Widths or /W range get the default width
+        REQUIRE(font->GetCIDWidth(0xFFFF) == font->GetMetrics().GetDefaultWidth());
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(lengths.begin(), lengths.end());
+    REQUIRE(lengths.size() == expected.size());
+    for (unsigned i = 0; i < lengths.size(); i++)
+        REQUIRE(std::abs(lengths[i] - expected[i]) < 0.001);
+}
+
+TEST_CASE("TestMeasureStrings")
+{
+    PdfMemDocument doc;
+    auto& font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+    PdfTextState state;
+    state.Font = &font;
+    state.FontSize = 12;
+    state.CharSpacing = 1;
+
+    vector<string_view> strs = { "Hello", "", "World!", "Hello" };
+    auto lengths = font.MeasureStrings(strs, state);
+    REQUIRE(lengths.size() == 4);
+    for (unsigned i = 0; i < strs.size(); i++)
+        REQUIRE(lengths[i] == font.GetStringLength(strs[i], state));
+
+    REQUIRE(lengths[1] == 0);
+    REQUIRE(lengths[0] == lengths[3]);
+
+    // Helvetica "H" is 722 units wide
+    REQUIRE(font.GetCharLength(U'H', state) == Catch::Detail::Approx(0.722 * 12 + 1));
+    double length = 0;
+    for (char ch : "Hello"sv)
+        length += font.GetCharLength((char32_t)ch, state);
+    REQUIRE(lengths[0] == Catch::Detail::Approx(length));
+
+    // Unmapped code points use the default width
+    double width;
+    REQUIRE(!font.TryGetCharLength(U'\U0010FFFF', state, width));
+    REQUIRE(width == font.GetDefaultCharLength(state));
+    vector<double> failedLengths;
+    REQUIRE(!font.TryMeasureStrings(vector<string_view>{ "Hello", "\xF4\x8F\xBF\xBF" }, state, failedLengths));
+    REQUIRE(failedLengths[0] == lengths[0]);
+}
+
+TEST_CASE("TestSimpleFontSubset")
+{
+    PdfDifferenceMap differences;
+    differences.AddDifference((unsigned char)200, U'a');
+    differences.AddDifference((unsigned char)201, U'b');
+    differences.AddDifference((unsigned char)202, U'c');
+
+    PdfMemDocument doc;
+    PdfFontCreateParams params;
+    params.Flags = PdfFontCreateFlags::PreferNonCID;
+    params.Encoding = PdfEncoding(std::make_shared<PdfDifferenceEncoding>(PdfEncodingMapFactory::GetWinAnsiEncodingInstancePtr(), std::move(differences)));
+    auto& font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica, params);
+    REQUIRE(!font.IsCIDFont());
+    REQUIRE(font.IsSubsettingEnabled());
+
+    // The Type1 font program is embedded fully, so the name is not tagged
+    REQUIRE(font.GetName() == "Helvetica");
+    {
+        PdfPainter painter;
+        painter.SetCanvas(doc.GetPages().CreatePage(PdfPageSize::A4));
+        painter.TextState.SetFont(font, 12);
+        painter.DrawText("Hab", 100, 700);
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestSimpleFontSubset.pdf");
+    doc.Save(outputPath);
+
+    PdfMemDocument loaded;
+    loaded.Load(outputPath);
+    auto& page = loaded.GetPages().GetPageAt(0);
+    auto loadedFont = page.GetResources().GetFont("Ft0");
+    REQUIRE(loadedFont != nullptr);
+
+    // The space is always added to the subset
+    auto& dict = loadedFont->GetDictionary();
+    REQUIRE(dict.MustFindKey("BaseFont").GetName() == "Helvetica");
+    REQUIRE(dict.MustFindKey("FirstChar").GetNumber() == 32);
+    REQUIRE(dict.MustFindKey("LastChar").GetNumber() == 201);
+    REQUIRE(dict.MustFindKey("Widths").GetArray().size() == 201 - 32 + 1);
+
+    // Only the differences of the used char codes are written
+    auto& diffs = dict.MustFindKey("Encoding").GetDictionary().MustFindKey("Differences").GetArray();
+    REQUIRE(diffs.size() == 3);
+    REQUIRE(diffs[0].GetNumber() == 200);
+    REQUIRE(diffs[1].GetName() == "a");
+    REQUIRE(diffs[2].GetName() == "b");
+
+    REQUIRE(loadedFont->GetCIDWidth(32) == Catch::Detail::Approx(0.278));
+    REQUIRE(loadedFont->GetCIDWidth('H') == Catch::Detail::Approx(0.722));
+    REQUIRE(loadedFont->GetCIDWidth(200) == Catch::Detail::Approx(0.556));
+
+    vector<PdfTextEntry> entries;
+    page.ExtractTextTo(entries);
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].Text == "Hab");
+}
+
+TEST_CASE("TestSimpleTrueTypeFontSubset")
+{
+    PdfMemDocument doc;
+    PdfFontCreateParams params;
+    params.Flags = PdfFontCreateFlags::PreferNonCID;
+    params.Encoding = PdfEncodingFactory::CreateWinAnsiEncoding();
+    auto& font = doc.GetFonts().GetOrCreateFont(TestUtils::GetTestInputFilePath("Fonts", "LiberationSans-Regular.ttf"), params);
+    REQUIRE(font.GetType() == PdfFontType::TrueType);
+    REQUIRE(font.GetName().find('+') == 6);
+    {
+        PdfPainter painter;
+        painter.SetCanvas(doc.GetPages().CreatePage(PdfPageSize::A4));
+        painter.TextState.SetFont(font, 12);
+        painter.DrawText("Hello", 100, 700);
+        painter.FinishDrawing();
+    }
+
+    auto outputPath = TestUtils::GetTestOutputFilePath("TestSimpleTrueTypeFontSubset.pdf");
+    doc.Save(outputPath);
+
+    PdfMemDocument loaded;
+    loaded.Load(outputPath);
+    auto& page = loaded.GetPages().GetPageAt(0);
+    auto loadedFont = page.GetResources().GetFont("Ft0");
+    REQUIRE(loadedFont != nullptr);
+
+    // The subset has glyph 0, the space and "Helo"
+    auto face = loadedFont->GetMetrics().GetFaceHandle();
+    REQUIRE(face != nullptr);
+    REQUIRE(face->num_glyphs == 6);
+
+    // The char codes are mapped to the glyphs by the 'cmap' table
+    for (int i = 0; i < face->num_charmaps; i++)
+    {
+        auto charmap = face->charmaps[i];
+        REQUIRE(FT_Set_Charmap(face, charmap) == 0);
+        unsigned offset = charmap->platform_id == 3 && charmap->encoding_id == 0 ? 0xF000 : 0;
+        REQUIRE(FT_Get_Char_Index(face, offset + ' ') == 1);
+        REQUIRE(FT_Get_Char_Index(face, offset + 'H') == 2);
+        REQUIRE(FT_Get_Char_Index(face, offset + 'o') == 5);
+    }
+
+    vector<PdfTextEntry> entries;
+    page.ExtractTextTo(entries);
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].Text == "Hello");
+}
+
 #ifdef PODOFO_HAVE_FONTCONFIG
 
 #include <fontconfig/fontconfig.h>
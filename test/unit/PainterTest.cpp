@@ -4,6 +4,8 @@
 
 #include <PdfTest.h>
 
+#include <thread>
+
 using namespace std;
 using namespace PoDoFo;
 
@@ -842,6 +844,182 @@ static void drawSample(PdfPainter& painter)
     painter.DrawCircle(100, 500, 20, PdfPathDrawMode::Fill);
 }
 
+TEST_CASE("TestDetachedCanvasConcurrentPainting")
+{
+    constexpr unsigned PageCount = 4;
+    auto outputFile = TestUtils::GetTestOutputFilePath("TestDetachedCanvasConcurrentPainting.pdf");
+    {
+        PdfMemDocument doc;
+        auto& font = doc.GetFonts().GetStandard14Font(PdfStandard14FontType::Helvetica);
+
+        // Shared objects used by the non-text painting operations
+        auto form = doc.CreateXObjectForm(Rect(0, 0, 50, 50));
+        {
+            PdfPainter painter;
+            painter.SetCanvas(*form);
+            painter.DrawRectangle(0, 0, 50, 50, PdfPathDrawMode::Fill);
+        }
+        PdfExtGStateDefinition extGStateDef;
+        extGStateDef.NonStrokingAlpha = 0.5;
+        auto extGState = doc.CreateExtGState(std::make_shared<PdfExtGStateDefinition>(extGStateDef));
+
+        vector<unique_ptr<PdfDetachedCanvas>> canvases;
+        for (unsigned i = 0; i < PageCount; i++)
+            canvases.push_back(doc.GetPages().CreateDetachedCanvas(PdfPageSize::A4));
+
+        vector<thread> threads;
+        for (unsigned i = 0; i < PageCount; i++)
+        {
+            threads.emplace_back([&canvas = *canvases[i], &font, &form = *form, &extGState = *extGState, i]()
+            {
+                PdfPainter painter;
+                painter.SetCanvas(canvas);
+                painter.TextState.SetFont(font, 15);
+                for (unsigned j = 0; j < 50; j++)
+                    painter.DrawText(utls::Format("Page {} line {}", i, j), 56.69, 800 - j * 15.0);
+                drawSample(painter);
+                painter.Save();
+                painter.GraphicsState.SetExtGState(extGState);
+                for (unsigned j = 0; j < 10; j++)
+                    painter.DrawXObject(form, 400, 50 + j * 60.0);
+                painter.Restore();
+                painter.FinishDrawing();
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        // Append in reverse order, to check insertion is independent from creation
+        for (unsigned i = PageCount; i > 0; i--)
+        {
+            auto& page = doc.GetPages().InsertDetachedCanvasAt(0, *canvases[i - 1]);
+            REQUIRE(page.GetIndex() == 0);
+            REQUIRE(canvases[i - 1]->IsAppended());
+        }
+
+        ASSERT_THROW_WITH_ERROR_CODE(doc.GetPages().AppendDetachedCanvas(*canvases[0]), PdfErrorCode::InternalLogic);
+        doc.Save(outputFile);
+    }
+
+    PdfMemDocument doc;
+    doc.Load(outputFile);
+    REQUIRE(doc.GetPages().GetCount() == PageCount);
+    for (unsigned i = 0; i < PageCount; i++)
+    {
+        vector<PdfTextEntry> entries;
+        doc.GetPages().GetPageAt(i).ExtractTextTo(entries);
+        REQUIRE(entries.size() == 50);
+        REQUIRE(entries[0].Text == utls::Format("Page {} line 0", i));
+        REQUIRE(entries[49].Text == utls::Format("Page {} line 49", i));
+
+        auto& resources = doc.GetPages().GetPageAt(i).GetResources();
+        REQUIRE(resources.GetResourceIterator(PdfResourceType::XObject).begin()
+            != resources.GetResourceIterator(PdfResourceType::XObject).end());
+        REQUIRE(resources.GetResourceIterator(PdfResourceType::ExtGState).begin()
+            != resources.GetResourceIterator(PdfResourceType::ExtGState).end());
+    }
+}
+
+TEST_CASE("TestStringStreamFormatting")
+{
+    PdfStringStream stream;
+    stream << 1.5 << ' ' << -0.25f << ' ' << 100.0 << ' ' << -0.0000001 << ' '
+        << 12 << ' ' << -34L << ' ' << 56u << ' ' << "q" << ' ' << "Q"sv << ' ' << string("cm");
+    REQUIRE(stream.GetString() == "1.5 -0.25 100 0 12 -34 56 q Q cm");
+
+    stream.Clear();
+    stream.SetPrecision(2);
+    REQUIRE(stream.GetPrecision() == 2);
+    stream << 3.14159 << ' ' << 2.999 << ' ' << 1e20 << std::endl;
+    REQUIRE(stream.GetString() == "3.14 3 100000000000000000000\n");
+
+    stream.Clear();
+    stream.SetPrecision(0);
+    stream << 100.0 << ' ' << 2.5f;
+    REQUIRE(stream.GetString() == "100 2");
+
+    // Types not natively handled use the iostream fallback
+    stream.Clear();
+    stream << true << ' ' << 'a';
+    REQUIRE(stream.TakeString() == "1 a");
+    REQUIRE(stream.GetSize() == 0);
+}
+
+TEST_CASE("TestDrawTextShaped")
+{
+    PdfMemDocument doc;
+    auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+    auto& font = doc.GetFonts().GetOrCreateFont(
+        TestUtils::GetTestInputFilePath("Fonts", "LiberationSans-Regular.ttf"));
+
+    PdfPainter painter;
+    painter.SetCanvas(page);
+    painter.TextState.SetFont(font, 12);
+
+    PdfTextShapingParams params;
+    painter.SetTextShaping(params);
+    REQUIRE(painter.GetTextShaping().has_value());
+#ifdef PODOFO_HAVE_HARFBUZZ
+    painter.DrawText("AVAVA", 100, 500);
+    painter.SetTextShaping(nullptr);
+    REQUIRE(!painter.GetTextShaping().has_value());
+    painter.DrawText("AVAVA", 100, 400);
+    painter.FinishDrawing();
+    auto out = getContents(page);
+    REQUIRE(countOccurrences(out, "TJ") == 1);
+    REQUIRE(countOccurrences(out, "Tj") == 1);
+
+    // Shaping results are cached
+    auto kerned = font.ShapeString("AVAVA", params);
+    REQUIRE(kerned == font.ShapeString("AVAVA", params));
+    REQUIRE(kerned->Glyphs.size() == 5);
+
+    // Kerning reduces the advances of the "AV" and "VA" pairs,
+    // which otherwise match the glyph widths
+    PdfTextShapingParams noKerningParams;
+    noKerningParams.Features = "-kern";
+    auto unkerned = font.ShapeString("AVAVA", noKerningParams);
+    REQUIRE(unkerned->Glyphs.size() == 5);
+    double kernedLength = 0;
+    double unkernedLength = 0;
+    for (unsigned i = 0; i < 5; i++)
+    {
+        REQUIRE(kerned->Glyphs[i].GID == unkerned->Glyphs[i].GID);
+        REQUIRE(std::abs(unkerned->Glyphs[i].Advance
+            - font.GetMetrics().GetGlyphWidth(unkerned->Glyphs[i].GID) * 1000) < 1);
+        kernedLength += kerned->Glyphs[i].Advance;
+        unkernedLength += unkerned->Glyphs[i].Advance;
+    }
+    REQUIRE(kernedLength < unkernedLength);
+
+    // Glyphs are shared in the subset with unshaped text
+    string codes;
+    for (auto& glyph : kerned->Glyphs)
+        glyph.Code.AppendTo(codes);
+    REQUIRE(codes == font.GetEncoding().ConvertToEncoded("AVAVA"));
+
+    // Fonts loading the same font program share the face and
+    // the HarfBuzz objects attached to it, shaping the same way
+    PdfMemDocument doc2;
+    auto& font2 = doc2.GetFonts().GetOrCreateFont(
+        TestUtils::GetTestInputFilePath("Fonts", "LiberationSans-Regular.ttf"));
+    auto kerned2 = font2.ShapeString("AVAVA", params);
+    REQUIRE(kerned2 != kerned);
+    REQUIRE(kerned2->Glyphs.size() == 5);
+    for (unsigned i = 0; i < 5; i++)
+    {
+        REQUIRE(kerned2->Glyphs[i].GID == kerned->Glyphs[i].GID);
+        REQUIRE(kerned2->Glyphs[i].Advance == kerned->Glyphs[i].Advance);
+    }
+#else
+    // PoDoFo is built without HarfBuzz. Nothing must be drawn
+    ASSERT_THROW_WITH_ERROR_CODE(painter.DrawText("AVAVA", 100, 500), PdfErrorCode::NotImplemented);
+    painter.FinishDrawing();
+    REQUIRE(getContents(page) == "q\nQ\n"sv);
+#endif // PODOFO_HAVE_HARFBUZZ
+}
+
 void compareStreamContent(PdfObjectStream& stream, const string_view& expected)
 {
     charbuff buffer;
@@ -27,6 +27,8 @@ static string generateXRefEntries(size_t count);
 static bool canOutOfMemoryKillUnitTests();
 static size_t getStackOverflowDepth();
 static string generateNestedOutlinesPdf(bool includePages);
+static void testIncrementalEditor(bool encrypted);
+static string generateObjectStreamPdf(unsigned objectCount);
 
 // this value is from Table C.1 in Appendix C.2 Architectural Limits in PDF 32000-1:2008
 // on 32-bit systems sizeof(PdfParser::TXRefEntry)=16 => max size of m_offsets=16*8,388,607 = 134 MB
@@ -2866,6 +2868,183 @@ startxref
     REQUIRE_NOTHROW(doc.LoadFromBuffer(pdf));
 }
 
+TEST_CASE("TestSaveCopyUnmodifiedObjects")
+{
+    auto getObjectData = [](const string_view& pdf, const PdfReference& ref)
+    {
+        auto header = utls::Format("\n{} {} obj", ref.ObjectNumber(), ref.GenerationNumber());
+        size_t start = pdf.find(header);
+        REQUIRE(start != string_view::npos);
+        start += header.size();
+        size_t end = pdf.find("endobj", start);
+        REQUIRE(end != string_view::npos);
+        return pdf.substr(start, end - start);
+    };
+
+    charbuff pdfBuffer;
+    PdfReference streamRef;
+    PdfReference dictRef;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& streamObj = doc.GetObjects().CreateDictionaryObject();
+        streamObj.GetOrCreateStream().SetData("Uncompressed stream data"sv, true);
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("TestStream"_n, streamObj);
+        streamRef = streamObj.GetIndirectReference();
+        auto& dictObj = doc.GetObjects().CreateDictionaryObject();
+        dictObj.GetDictionary().AddKey("Real"_n, 1.5);
+        dictObj.GetDictionary().AddKey("String"_n, PdfString("Some text"));
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("TestDict"_n, dictObj);
+        dictRef = dictObj.GetIndirectReference();
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device, PdfSaveOptions::NoFlateCompress);
+    }
+
+    charbuff savedBuffer;
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(pdfBuffer);
+    doc.GetObjects().MustGetObject(dictRef).GetDictionary().AddKey("Edited"_n, true);
+    BufferStreamDevice device(savedBuffer);
+    doc.Save(device, PdfSaveOptions::CopyUnmodifiedObjects);
+
+    // The unmodified stream object is copied verbatim, without being compressed
+    REQUIRE(getObjectData(savedBuffer, streamRef) == getObjectData(pdfBuffer, streamRef));
+    REQUIRE(getObjectData(savedBuffer, dictRef) != getObjectData(pdfBuffer, dictRef));
+
+    doc.LoadFromBuffer(savedBuffer);
+    auto& streamObj = doc.GetObjects().MustGetObject(streamRef);
+    REQUIRE(streamObj.MustGetStream().GetFilters().size() == 0);
+    REQUIRE(streamObj.MustGetStream().GetCopy() == "Uncompressed stream data");
+    auto& dict = doc.GetObjects().MustGetObject(dictRef).GetDictionary();
+    REQUIRE(dict.MustFindKey("Real").GetReal() == 1.5);
+    REQUIRE(dict.MustFindKey("String").GetString() == "Some text");
+    REQUIRE(dict.MustFindKey("Edited").GetBool());
+}
+
+TEST_CASE("TestSaveCopyUnmodifiedObjectsDeduplicate")
+{
+    charbuff pdfBuffer;
+    PdfReference xobjectsRef;
+    {
+        PdfMemDocument doc;
+        auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+        // An indirect dictionary referencing duplicated streams,
+        // not modified but by the deduplication
+        auto& xobjects = doc.GetObjects().CreateDictionaryObject();
+        xobjectsRef = xobjects.GetIndirectReference();
+        for (auto name : { "First"_n, "Second"_n })
+        {
+            auto& xobj = doc.GetObjects().CreateDictionaryObject();
+            xobj.GetOrCreateStream().SetData("Duplicated stream data"sv, true);
+            xobjects.GetDictionary().AddKey(name, xobj.GetIndirectReference());
+        }
+        page.GetResources().GetDictionary().AddKey("XObject"_n, xobjectsRef);
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device, PdfSaveOptions::NoFlateCompress);
+    }
+
+    charbuff savedBuffer;
+    {
+        PdfMemDocument doc;
+        doc.LoadFromBuffer(pdfBuffer);
+        BufferStreamDevice device(savedBuffer);
+        doc.Save(device, PdfSaveOptions::CopyUnmodifiedObjects | PdfSaveOptions::DeduplicateObjects);
+    }
+
+    // The dictionary referencing the merged duplicate
+    // is rewritten, instead of being copied verbatim
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(savedBuffer);
+    auto& xobjects = doc.GetObjects().MustGetObject(xobjectsRef).GetDictionary();
+    auto first = xobjects.MustGetKey("First").GetReference();
+    REQUIRE(xobjects.MustGetKey("Second").GetReference() == first);
+    REQUIRE(doc.GetObjects().MustGetObject(first).MustGetStream().GetCopy() == "Duplicated stream data");
+}
+
+TEST_CASE("TestSaveCopyUnmodifiedObjectsOverSource")
+{
+    auto path = TestUtils::GetTestOutputFilePath("TestSaveCopyUnmodifiedObjectsOverSource.pdf");
+    // Data bigger than the buffers of the source file
+    string data(200000, 'x');
+    PdfReference streamRef;
+    {
+        PdfMemDocument doc;
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& streamObj = doc.GetObjects().CreateDictionaryObject();
+        streamObj.GetOrCreateStream().SetData(data, true);
+        doc.GetCatalog().GetDictionary().AddKeyIndirect("TestStream"_n, streamObj);
+        streamRef = streamObj.GetIndirectReference();
+        doc.Save(path, PdfSaveOptions::NoFlateCompress);
+    }
+
+    for (auto opts : { PdfSaveOptions::None, PdfSaveOptions::CopyUnmodifiedObjects })
+    {
+        {
+            PdfMemDocument doc;
+            doc.Load(path);
+            doc.GetMetadata().SetTitle(PdfString("Edited"));
+            doc.Save(path, opts);
+
+            // The document is still usable after overwriting its source
+            charbuff copyBuffer;
+            BufferStreamDevice device(copyBuffer);
+            doc.Save(device, PdfSaveOptions::CopyUnmodifiedObjects);
+            PdfMemDocument copy;
+            copy.LoadFromBuffer(copyBuffer);
+            REQUIRE(copy.GetObjects().MustGetObject(streamRef).MustGetStream().GetCopy() == data);
+        }
+
+        PdfMemDocument doc;
+        doc.Load(path);
+        REQUIRE(doc.GetObjects().MustGetObject(streamRef).MustGetStream().GetCopy() == data);
+        REQUIRE(doc.GetMetadata().GetTitle()->GetString() == "Edited");
+    }
+}
+
+TEST_CASE("TestIncrementalEditor")
+{
+    for (bool encrypted : { false, true })
+        testIncrementalEditor(encrypted);
+}
+
+TEST_CASE("TestIncrementalEditorObjectStreams")
+{
+    constexpr unsigned ObjectCount = 20;
+    string pdfBuffer = generateObjectStreamPdf(ObjectCount);
+    charbuff updatedBuffer(pdfBuffer);
+    {
+        PdfIncrementalEditor editor(std::make_shared<SpanStreamDevice>(pdfBuffer));
+
+        // Looking up a compressed object reads the whole object
+        // stream once, loading all the objects compressed in it
+        auto& dicts = editor.GetCatalog().GetDictionary().MustFindKey("Dicts").GetArray();
+        auto& dict = editor.GetObjects().MustGetObject(dicts[5].GetReference()).GetDictionary();
+        REQUIRE(dict.MustFindKey("Index").GetNumber() == 5);
+        size_t loadedCount = editor.GetObjects().GetSize();
+        REQUIRE(loadedCount >= ObjectCount + 2);
+        for (unsigned i = 0; i < ObjectCount; i++)
+        {
+            auto& obj = editor.GetObjects().MustGetObject(dicts[i].GetReference());
+            REQUIRE(obj.GetDictionary().MustFindKey("Index").GetNumber() == i);
+        }
+        REQUIRE(editor.GetObjects().GetSize() == loadedCount);
+
+        editor.GetObjects().MustGetObject(dicts[10].GetReference()).GetDictionary().AddKey("Edited"_n, true);
+        BufferStreamDevice device(updatedBuffer);
+        editor.SaveUpdate(device);
+    }
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(updatedBuffer);
+    auto& dicts = doc.GetCatalog().GetDictionary().MustFindKey("Dicts").GetArray();
+    for (unsigned i = 0; i < ObjectCount; i++)
+    {
+        auto& dict = doc.GetObjects().MustGetObject(dicts[i].GetReference()).GetDictionary();
+        REQUIRE(dict.MustFindKey("Index").GetNumber() == i);
+        REQUIRE(dict.HasKey("Edited") == (i == 10));
+    }
+}
+
 string generateXRefEntries(size_t count)
 {
     string strXRefEntries;
@@ -3034,3 +3213,122 @@ string generateNestedOutlinesPdf(bool includePages)
 
     return oss.str();
 }
+
+void testIncrementalEditor(bool encrypted)
+{
+    string_view password = encrypted ? "userpwd"sv : ""sv;
+    charbuff pdfBuffer;
+    PdfReference dictRef;
+    unsigned objectCount;
+    {
+        PdfMemDocument doc;
+        if (encrypted)
+            doc.SetEncrypted(password, "ownerpwd");
+
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        (void)doc.GetPages().CreatePage(PdfPageSize::A4);
+        for (unsigned i = 0; i < 100; i++)
+        {
+            auto& obj = doc.GetObjects().CreateDictionaryObject();
+            obj.GetDictionary().AddKey("Index"_n, (int64_t)i);
+            doc.GetCatalog().GetDictionary().AddKeyIndirect(PdfName(utls::Format("Obj{}", i)), obj);
+            if (i == 50)
+                dictRef = obj.GetIndirectReference();
+        }
+        BufferStreamDevice device(pdfBuffer);
+        doc.Save(device);
+        objectCount = doc.GetObjects().GetObjectCount();
+    }
+
+    charbuff updatedBuffer = pdfBuffer;
+    PdfReference newRef;
+    {
+        PdfIncrementalEditor editor(std::make_shared<SpanStreamDevice>(pdfBuffer), PdfLoadOptions::None, password);
+        REQUIRE(editor.GetPages().GetCount() == 2);
+        editor.GetPages().GetPageAt(1).GetDictionary().AddKey("Edited"_n, true);
+        editor.GetObjects().MustGetObject(dictRef).GetDictionary().AddKey("Edited"_n, true);
+        auto& newObj = editor.GetObjects().CreateDictionaryObject();
+        newObj.GetDictionary().AddKey("Text"_n, PdfString("Appended text"));
+        editor.GetCatalog().GetDictionary().AddKeyIndirect("NewObj"_n, newObj);
+        newRef = newObj.GetIndirectReference();
+
+        // Only the touched objects are loaded and new
+        // objects don't reuse the existing object numbers
+        REQUIRE(editor.GetObjects().GetSize() < 20);
+        REQUIRE(newRef.ObjectNumber() >= objectCount);
+
+        BufferStreamDevice device(updatedBuffer);
+        editor.SaveUpdate(device);
+    }
+
+    // The update is appended to the unchanged original document
+    REQUIRE(updatedBuffer.size() > pdfBuffer.size());
+    REQUIRE(std::memcmp(updatedBuffer.data(), pdfBuffer.data(), pdfBuffer.size()) == 0);
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(updatedBuffer, password);
+    REQUIRE(doc.IsEncrypted() == encrypted);
+    REQUIRE(doc.GetTrailer().GetDictionary().HasKey("Prev"));
+    REQUIRE(doc.GetPages().GetCount() == 2);
+    REQUIRE(doc.GetPages().GetPageAt(1).GetDictionary().MustFindKey("Edited").GetBool());
+    REQUIRE(!doc.GetPages().GetPageAt(0).GetDictionary().HasKey("Edited"));
+    auto& dict = doc.GetObjects().MustGetObject(dictRef).GetDictionary();
+    REQUIRE(dict.MustFindKey("Index").GetNumber() == 50);
+    REQUIRE(dict.MustFindKey("Edited").GetBool());
+    REQUIRE(doc.GetCatalog().GetDictionary().MustFindKey("NewObj").GetIndirectReference() == newRef);
+    REQUIRE(doc.GetObjects().MustGetObject(newRef).GetDictionary().MustFindKey("Text").GetString() == "Appended text");
+}
+
+// Generate a document with the given count of dictionaries
+// compressed in an object stream, indexed by a xref stream
+string generateObjectStreamPdf(unsigned objectCount)
+{
+    constexpr uint32_t ObjectStreamNum = 3;
+    string pdf = "%PDF-1.5\n";
+    vector<size_t> offsets;
+
+    string dictRefs;
+    string streamHeader;
+    string streamObjects;
+    for (unsigned i = 0; i < objectCount; i++)
+    {
+        dictRefs.append(utls::Format(" {} 0 R", ObjectStreamNum + 1 + i));
+        streamHeader.append(utls::Format("{} {} ", ObjectStreamNum + 1 + i, streamObjects.size()));
+        streamObjects.append(utls::Format("<</Index {}>>\n", i));
+    }
+
+    offsets.push_back(pdf.size());
+    pdf.append(utls::Format("1 0 obj\n<</Type/Catalog/Pages 2 0 R/Dicts[{}]>>\nendobj\n", dictRefs));
+    offsets.push_back(pdf.size());
+    pdf.append("2 0 obj\n<</Type/Pages/Kids[]/Count 0>>\nendobj\n");
+    offsets.push_back(pdf.size());
+    pdf.append(utls::Format("{} 0 obj\n<</Type/ObjStm/N {}/First {}/Length {}>>\nstream\n{}{}\nendstream\nendobj\n",
+        ObjectStreamNum, objectCount, streamHeader.size(), streamHeader.size() + streamObjects.size(),
+        streamHeader, streamObjects));
+
+    // Entries with /W [1 4 2]
+    uint32_t xrefStreamNum = ObjectStreamNum + 1 + objectCount;
+    string entries;
+    auto appendEntry = [&entries](uint8_t type, uint32_t field2, uint16_t field3)
+    {
+        entries.push_back((char)type);
+        for (int shift = 24; shift >= 0; shift -= 8)
+            entries.push_back((char)((field2 >> shift) & 0xFF));
+        entries.push_back((char)(field3 >> 8));
+        entries.push_back((char)(field3 & 0xFF));
+    };
+
+    appendEntry(0, 0, 65535);
+    for (auto offset : offsets)
+        appendEntry(1, (uint32_t)offset, 0);
+    for (unsigned i = 0; i < objectCount; i++)
+        appendEntry(2, ObjectStreamNum, (uint16_t)i);
+
+    size_t xrefOffset = pdf.size();
+    appendEntry(1, (uint32_t)xrefOffset, 0);
+    pdf.append(utls::Format("{} 0 obj\n<</Type/XRef/Size {}/W[1 4 2]/Root 1 0 R/Length {}>>\nstream\n",
+        xrefStreamNum, xrefStreamNum + 1, entries.size()));
+    pdf.append(entries);
+    pdf.append(utls::Format("\nendstream\nendobj\nstartxref\n{}\n%%EOF\n", xrefOffset));
+    return pdf;
+}
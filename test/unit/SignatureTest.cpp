@@ -444,6 +444,290 @@ TEST_CASE("TestSignatureOffsetStart")
     REQUIRE(ssl::ComputeMD5Str(currBuffer) == "7063AD6AFCB797D361D2DAF943002298");
 }
 
+namespace
+{
+    // A signer that "signs" the MD5 digest of the appended data
+    class DigestSigner final : public PdfSigner
+    {
+    public:
+        void Reset() override { m_data.clear(); }
+        void AppendData(const bufferview& data) override { m_data.append(data.data(), data.size()); }
+        void ComputeSignature(charbuff& contents, bool dryrun) override
+        {
+            (void)dryrun;
+            contents = ssl::ComputeMD5Str(m_data);
+        }
+        string GetSignatureSubFilter() const override { return "adbe.pkcs7.detached"; }
+        string GetSignatureType() const override { return "Sig"; }
+
+    private:
+        charbuff m_data;
+    };
+}
+
+TEST_CASE("TestSignWriteOnlyDevice")
+{
+    charbuff input;
+    {
+        PdfMemDocument doc;
+        doc.GetPages().CreatePage(PdfPageSize::A4);
+        BufferStreamDevice device(input);
+        doc.Save(device);
+    }
+
+    auto sign = [&](charbuff& output, bool writeOnly, PdfSaveOptions saveOptions)
+    {
+        auto inputOutput = std::make_shared<BufferStreamDevice>(output);
+        PdfMemDocument doc;
+        doc.Load(std::make_shared<SpanStreamDevice>(input));
+        auto& signature = doc.GetPages().GetPageAt(0).CreateField<PdfSignature>("Signature", Rect());
+        DigestSigner signer;
+        PdfSigningContext ctx;
+        ctx.AddSigner(signature, shared_ptr<PdfSigner>(&signer, [](PdfSigner*) { }));
+        if (writeOnly)
+        {
+            ctx.Sign(doc, static_cast<OutputStreamDevice&>(*inputOutput), saveOptions);
+        }
+        else
+        {
+            // Signing in place appends the update to the original document
+            if ((saveOptions & PdfSaveOptions::SaveOnSigning) == PdfSaveOptions::None)
+                inputOutput->Write(input);
+            ctx.Sign(doc, *inputOutput, saveOptions);
+        }
+    };
+
+    charbuff expected;
+    charbuff output;
+    sign(expected, false, PdfSaveOptions::NoMetadataUpdate);
+    sign(output, true, PdfSaveOptions::NoMetadataUpdate);
+    REQUIRE(output == expected);
+
+    expected.clear();
+    output.clear();
+    sign(expected, false, PdfSaveOptions::NoMetadataUpdate | PdfSaveOptions::SaveOnSigning);
+    sign(output, true, PdfSaveOptions::NoMetadataUpdate | PdfSaveOptions::SaveOnSigning);
+    REQUIRE(output == expected);
+
+    // The signature is computed on the data outside the /Contents
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(output);
+    auto& signature = dynamic_cast<PdfSignature&>(dynamic_cast<PdfAnnotationWidget&>(
+        doc.GetPages().GetPageAt(0).GetAnnotations().GetAnnotAt(0)).GetField());
+    auto& value = signature.GetDictionary().MustFindKey("V").GetDictionary();
+    auto& byteRange = value.MustFindKey("ByteRange").GetArray();
+    charbuff signedData;
+    signedData.append(output.data() + byteRange[0].GetNumber(), (size_t)byteRange[1].GetNumber());
+    signedData.append(output.data() + byteRange[2].GetNumber(), (size_t)byteRange[3].GetNumber());
+    REQUIRE(byteRange[2].GetNumber() + byteRange[3].GetNumber() == (int64_t)output.size());
+    REQUIRE(value.MustFindKey("Contents").GetString().GetRawData() == ssl::ComputeMD5Str(signedData));
+
+    // An incremental update can't be written for a document not loaded from a device
+    {
+        PdfMemDocument newDoc;
+        auto& newSignature = newDoc.GetPages().CreatePage(PdfPageSize::A4).CreateField<PdfSignature>("Signature", Rect());
+        DigestSigner signer;
+        PdfSigningContext ctx;
+        ctx.AddSigner(newSignature, shared_ptr<PdfSigner>(&signer, [](PdfSigner*) { }));
+        output.clear();
+        BufferStreamDevice device(output);
+        ASSERT_THROW_WITH_ERROR_CODE(ctx.Sign(newDoc, static_cast<OutputStreamDevice&>(device)),
+            PdfErrorCode::InvalidHandle);
+        REQUIRE(output.size() == 0);
+    }
+}
+
+// Sign two fields in a single operation, each signature
+// being written in its own incremental update
+TEST_CASE("TestSignTwoFields")
+{
+    charbuff input;
+    {
+        PdfMemDocument doc;
+        doc.GetPages().CreatePage(PdfPageSize::A4);
+        BufferStreamDevice device(input);
+        doc.Save(device);
+    }
+
+    auto sign = [&](charbuff& output, bool writeOnly)
+    {
+        auto inputOutput = std::make_shared<BufferStreamDevice>(output);
+        PdfMemDocument doc;
+        doc.Load(std::make_shared<SpanStreamDevice>(input));
+        auto& page = doc.GetPages().GetPageAt(0);
+        auto& signature1 = page.CreateField<PdfSignature>("Signature1", Rect());
+        auto& signature2 = page.CreateField<PdfSignature>("Signature2", Rect());
+        DigestSigner signer1;
+        DigestSigner signer2;
+        PdfSigningContext ctx;
+        ctx.AddSigner(signature1, shared_ptr<PdfSigner>(&signer1, [](PdfSigner*) { }));
+        ctx.AddSigner(signature2, shared_ptr<PdfSigner>(&signer2, [](PdfSigner*) { }));
+        if (writeOnly)
+        {
+            ctx.Sign(doc, static_cast<OutputStreamDevice&>(*inputOutput), PdfSaveOptions::NoMetadataUpdate);
+        }
+        else
+        {
+            inputOutput->Write(input);
+            ctx.Sign(doc, *inputOutput, PdfSaveOptions::NoMetadataUpdate);
+        }
+    };
+
+    charbuff expected;
+    charbuff output;
+    sign(expected, false);
+    sign(output, true);
+    REQUIRE(output == expected);
+
+    PdfMemDocument doc;
+    doc.LoadFromBuffer(output);
+    auto& annots = doc.GetPages().GetPageAt(0).GetAnnotations();
+    REQUIRE(annots.GetCount() == 2);
+    vector<int64_t> signedEnds;
+    for (unsigned i = 0; i < annots.GetCount(); i++)
+    {
+        auto& signature = dynamic_cast<PdfSignature&>(dynamic_cast<PdfAnnotationWidget&>(
+            annots.GetAnnotAt(i)).GetField());
+        auto& value = signature.GetDictionary().MustFindKey("V").GetDictionary();
+        auto& byteRange = value.MustFindKey("ByteRange").GetArray();
+        charbuff signedData;
+        signedData.append(output.data() + byteRange[0].GetNumber(), (size_t)byteRange[1].GetNumber());
+        signedData.append(output.data() + byteRange[2].GetNumber(), (size_t)byteRange[3].GetNumber());
+        REQUIRE(value.MustFindKey("Contents").GetString().GetRawData() == ssl::ComputeMD5Str(signedData));
+        signedEnds.push_back(byteRange[2].GetNumber() + byteRange[3].GetNumber());
+    }
+
+    // The first signature covers its own update, while the
+    // second one covers the whole file, the first /Contents included
+    std::sort(signedEnds.begin(), signedEnds.end());
+    REQUIRE(signedEnds[0] < signedEnds[1]);
+    REQUIRE(signedEnds[1] == (int64_t)output.size());
+    REQUIRE(string_view(output.data(), (size_t)signedEnds[0]).substr((size_t)signedEnds[0] - 6).find("%%EOF") != string_view::npos);
+}
+
+// Create a self-signed RSA certificate, with its PKCS#8 private key
+static void createSelfSignedCertificate(charbuff& cert, charbuff& pkey)
+{
+    unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr), EVP_PKEY_CTX_free);
+    EVP_PKEY* key = nullptr;
+    REQUIRE(EVP_PKEY_keygen_init(ctx.get()) == 1);
+    REQUIRE(EVP_PKEY_CTX_set_rsa_keygen_bits(ctx.get(), 2048) == 1);
+    REQUIRE(EVP_PKEY_keygen(ctx.get(), &key) == 1);
+    unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> keyPtr(key, EVP_PKEY_free);
+
+    unique_ptr<X509, decltype(&X509_free)> x509(X509_new(), X509_free);
+    X509_set_version(x509.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(x509.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(x509.get()), 3600);
+    X509_set_pubkey(x509.get(), key);
+    auto name = X509_get_subject_name(x509.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"PoDoFo Test", -1, -1, 0);
+    X509_set_issuer_name(x509.get(), name);
+    REQUIRE(X509_sign(x509.get(), key, EVP_sha256()) != 0);
+
+    cert = ssl::GetEncoded(x509.get());
+    pkey = ssl::GetEncoded(key);
+}
+
+TEST_CASE("TestSignatureVerifier")
+{
+    charbuff cert;
+    charbuff pkey;
+    createSelfSignedCertificate(cert, pkey);
+
+    charbuff signedDoc;
+    {
+        PdfMemDocument doc;
+        auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& signature = page.CreateField<PdfSignature>("Signature", Rect());
+        BufferStreamDevice device(signedDoc);
+        PdfSignerCms signer(cert, pkey);
+        PoDoFo::SignDocument(doc, device, signer, signature, PdfSaveOptions::SaveOnSigning);
+    }
+
+    PdfSignatureVerifier verifier;
+    auto results = verifier.Verify(std::make_shared<SpanStreamDevice>(signedDoc));
+    REQUIRE(results.size() == 1);
+    REQUIRE(results[0].FieldName == "Signature");
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Untrusted);
+    REQUIRE(results[0].CoversWholeDocument);
+    REQUIRE(results[0].SignerCertificate == cert);
+
+    verifier.AddTrustedCertificates(cert);
+    results = verifier.Verify(std::make_shared<SpanStreamDevice>(signedDoc));
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Valid);
+
+    // Append an incremental update after the signed revision
+    charbuff updatedDoc = signedDoc;
+    {
+        auto device = std::make_shared<BufferStreamDevice>(updatedDoc);
+        PdfMemDocument doc(device);
+        doc.GetPages().CreatePage(PdfPageSize::A4);
+        doc.SaveUpdate(*device);
+    }
+
+    // Alter the signed data
+    charbuff modifiedDoc = signedDoc;
+    auto pos = modifiedDoc.find("/MediaBox[ 0 0 595 842]");
+    REQUIRE(pos != string::npos);
+    modifiedDoc[pos + 15] = '6';
+
+    vector<shared_ptr<InputStreamDevice>> devices = {
+        std::make_shared<SpanStreamDevice>(signedDoc),
+        std::make_shared<SpanStreamDevice>(updatedDoc),
+        std::make_shared<SpanStreamDevice>(modifiedDoc),
+        std::make_shared<SpanStreamDevice>("Not a PDF"),
+    };
+    vector<vector<PdfSignatureVerificationResult>> batchResults;
+    verifier.Verify(devices, batchResults);
+    REQUIRE(batchResults.size() == 4);
+    REQUIRE(batchResults[0][0].Status == PdfSignatureVerificationStatus::Valid);
+    REQUIRE(batchResults[1][0].Status == PdfSignatureVerificationStatus::Valid);
+    REQUIRE(!batchResults[1][0].CoversWholeDocument);
+    REQUIRE(batchResults[1][0].RevisionLength == signedDoc.size());
+    REQUIRE(batchResults[2][0].Status == PdfSignatureVerificationStatus::Modified);
+    REQUIRE(batchResults[3].size() == 1);
+    REQUIRE(batchResults[3][0].Status == PdfSignatureVerificationStatus::Malformed);
+}
+
+TEST_CASE("TestSignatureVerifierCertificateExpiry")
+{
+    charbuff cert;
+    charbuff pkey;
+    createSelfSignedCertificate(cert, pkey);
+
+    charbuff signedDoc;
+    {
+        PdfMemDocument doc;
+        auto& page = doc.GetPages().CreatePage(PdfPageSize::A4);
+        auto& signature = page.CreateField<PdfSignature>("Signature", Rect());
+        BufferStreamDevice device(signedDoc);
+        PdfSignerCms signer(cert, pkey);
+        PoDoFo::SignDocument(doc, device, signer, signature, PdfSaveOptions::SaveOnSigning);
+    }
+
+    // The certificate is valid from one hour ago to one hour from now
+    time_t now = time(nullptr);
+    PdfSignatureVerifier verifier;
+    verifier.AddTrustedCertificates(cert);
+    auto device = std::make_shared<SpanStreamDevice>(signedDoc);
+    auto results = verifier.Verify(device, now);
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Valid);
+
+    // The cached validation must not outlive the certificate
+    results = verifier.Verify(device, now + 7200);
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Untrusted);
+    results = verifier.Verify(device, now - 7200);
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Untrusted);
+
+    // Neither the failed validations must be reused within the validity period
+    results = verifier.Verify(device, now);
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Valid);
+    results = verifier.Verify(device, now + 7200);
+    REQUIRE(results[0].Status == PdfSignatureVerificationStatus::Untrusted);
+}
+
 TEST_CASE("TestSignatureCorrupted")
 {
     auto currentLogSeverity = PdfCommon::GetMaxLoggingSeverity();